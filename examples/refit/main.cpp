@@ -0,0 +1,139 @@
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include <Euclid/IO/OffIO.h>
+#include <Euclid/Render/RayTracer.h>
+#include <Euclid/Util/Timer.h>
+
+#include <config.h>
+
+// Benchmark the per frame cost of BVH builds versus traversal when rendering
+// a deforming mesh, for each build quality of RayScene.
+
+constexpr const int frames = 60;
+constexpr const int width = 512;
+constexpr const int height = 512;
+
+void deform(const std::vector<float>& rest,
+            std::vector<float>& positions,
+            float amplitude,
+            int frame)
+{
+    auto phase = 0.2f * frame;
+    for (size_t i = 0; i + 2 < rest.size(); i += 3) {
+        positions[i + 0] = rest[i + 0];
+        positions[i + 1] =
+            rest[i + 1] + amplitude * std::sin(10.0f * rest[i + 0] + phase);
+        positions[i + 2] = rest[i + 2];
+    }
+}
+
+void benchmark(const std::string& name,
+               Euclid::BuildQuality quality,
+               bool compact,
+               const std::vector<float>& rest,
+               const std::vector<unsigned>& indices,
+               const Euclid::RayCamera& camera,
+               float amplitude)
+{
+    std::vector<float> positions(rest);
+    Euclid::RayTracer raytracer;
+    raytracer.set_build_quality(quality, compact);
+    raytracer.attach_geometry_buffers(positions, indices);
+
+    Euclid::Timer timer;
+    std::vector<uint32_t> pixels;
+    double build = 0.0;
+    double render = 0.0;
+    for (int frame = 0; frame < frames; ++frame) {
+        deform(rest, positions, amplitude, frame);
+        timer.tick();
+        raytracer.update_positions(positions);
+        build += timer.tock<double, std::milli>();
+
+        timer.tick();
+        raytracer.render_index(pixels, camera, width, height);
+        render += timer.tock<double, std::milli>();
+    }
+
+    std::cout << std::setw(16) << std::left << name << std::right
+              << std::setw(12) << build / frames << std::setw(12)
+              << render / frames << std::setw(12)
+              << (build + render) / frames << std::endl;
+}
+
+int main()
+{
+    std::string filename(DATA_DIR);
+    filename.append("bunny.off");
+    std::vector<float> rest;
+    std::vector<unsigned> indices;
+    Euclid::read_off<3>(filename, rest, nullptr, &indices, nullptr);
+    rest.push_back(0.0f); // Embree alignment
+
+    Eigen::Vector3f lower = Eigen::Vector3f::Constant(
+        std::numeric_limits<float>::max());
+    Eigen::Vector3f upper = -lower;
+    for (size_t i = 0; i + 2 < rest.size(); i += 3) {
+        Eigen::Vector3f p(rest[i], rest[i + 1], rest[i + 2]);
+        lower = lower.cwiseMin(p);
+        upper = upper.cwiseMax(p);
+    }
+    Eigen::Vector3f center = 0.5f * (lower + upper);
+    Eigen::Vector3f extent = upper - lower;
+    Eigen::Vector3f view =
+        center + Eigen::Vector3f(0.0f, 0.0f, 2.0f * extent.z());
+    Euclid::PerspRayCamera camera(view,
+                                  center,
+                                  Eigen::Vector3f(0.0f, 1.0f, 0.0f),
+                                  60.0f,
+                                  width,
+                                  height,
+                                  0.001f,
+                                  10.0f);
+    auto amplitude = 0.05f * extent.y();
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(16) << std::left << "quality" << std::right
+              << std::setw(12) << "build(ms)" << std::setw(12) << "render(ms)"
+              << std::setw(12) << "frame(ms)" << std::endl;
+    benchmark("low",
+              Euclid::BuildQuality::low,
+              false,
+              rest,
+              indices,
+              camera,
+              amplitude);
+    benchmark("medium",
+              Euclid::BuildQuality::medium,
+              false,
+              rest,
+              indices,
+              camera,
+              amplitude);
+    benchmark("high",
+              Euclid::BuildQuality::high,
+              false,
+              rest,
+              indices,
+              camera,
+              amplitude);
+    benchmark("medium compact",
+              Euclid::BuildQuality::medium,
+              true,
+              rest,
+              indices,
+              camera,
+              amplitude);
+    benchmark("refit",
+              Euclid::BuildQuality::refit,
+              false,
+              rest,
+              indices,
+              camera,
+              amplitude);
+}
@@ -73,6 +73,33 @@ private:
     FT _lambda_min;
 };
 
+/** Heat kernel signature without eigen decomposition.
+ *
+ *  Evaluate the heat kernel diagonals from Chebyshev filters of the mesh
+ *  Laplacian, so that no eigen decomposition is needed and all frequencies are
+ *  taken into account. This is suitable for very large meshes. The time scales
+ *  are sampled and normalized the same way as HKS::compute.
+ *
+ *  @param mesh The target mesh.
+ *  @param hks Output heat kernel signatures.
+ *  @param tscales Number of time scales to use.
+ *  @param tmin The minimum time value.
+ *  @param tmax The maximum time value.
+ *  @param order The order of the Chebyshev expansion, which should grow with
+ *  the square root of tmax * lambda_max for accurate results.
+ *  @param probes Number of random probes to estimate the diagonals.
+ *
+ *  @sa filter_diagonals
+ */
+template<typename Mesh, typename Derived>
+void matrix_free_hks(const Mesh& mesh,
+                     Eigen::ArrayBase<Derived>& hks,
+                     unsigned tscales,
+                     float tmin,
+                     float tmax,
+                     unsigned order = 100,
+                     unsigned probes = 64);
+
 /** @}*/
 } // namespace Euclid
 
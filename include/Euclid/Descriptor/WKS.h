@@ -75,6 +75,35 @@ private:
     FT _lambda_min;
 };
 
+/** Wave kernel signature without eigen decomposition.
+ *
+ *  Evaluate the wave kernel signature using band-pass Chebyshev filters of the
+ *  mesh Laplacian, so that no eigen decomposition is needed and all
+ *  frequencies are taken into account. This is suitable for very large meshes.
+ *  The energy scales are sampled the same way as WKS::compute.
+ *
+ *  @param mesh The target mesh.
+ *  @param wks Output wave kernel signatures.
+ *  @param escales Number of energy scales to use.
+ *  @param emin The minimum energy scale.
+ *  @param emax The maximum energy scale.
+ *  @param sigma The variance of the log normal distribution.
+ *  @param order The order of the Chebyshev expansion, narrow bands of low
+ *  energy need high orders.
+ *  @param probes Number of random probes to estimate the diagonals.
+ *
+ *  @sa filter_diagonals
+ */
+template<typename Mesh, typename Derived>
+void matrix_free_wks(const Mesh& mesh,
+                     Eigen::ArrayBase<Derived>& wks,
+                     unsigned escales,
+                     float emin,
+                     float emax,
+                     float sigma,
+                     unsigned order = 100,
+                     unsigned probes = 64);
+
 /** @}*/
 } // namespace Euclid
 
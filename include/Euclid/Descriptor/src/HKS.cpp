@@ -1,8 +1,12 @@
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <stdexcept>
+#include <vector>
 
 #include <Euclid/Geometry/Spectral.h>
+#include <Euclid/Geometry/SpectralFilter.h>
+#include <Euclid/Geometry/TriMeshGeometry.h>
 
 namespace Euclid
 {
@@ -68,4 +72,40 @@ void HKS<Mesh>::compute(Eigen::ArrayBase<Derived>& hks,
     hks.colwise() /= hks.rowwise().sum();
 }
 
+template<typename Mesh, typename Derived>
+void matrix_free_hks(const Mesh& mesh,
+                     Eigen::ArrayBase<Derived>& hks,
+                     unsigned tscales,
+                     float tmin,
+                     float tmax,
+                     unsigned order,
+                     unsigned probes)
+{
+    using FT = FT_t<Mesh>;
+    using SpMat = Eigen::SparseMatrix<FT>;
+    if (tmin <= 0 || tmin >= tmax) {
+        throw std::invalid_argument("Invalid time range.");
+    }
+    auto log_tmin = std::log(tmin);
+    auto log_tmax = std::log(tmax);
+    auto log_tstep = (log_tmax - log_tmin) / tscales;
+
+    std::vector<std::function<FT(FT)>> filters;
+    filters.reserve(tscales);
+    for (size_t i = 0; i < tscales; ++i) {
+        auto t = static_cast<FT>(std::exp(log_tmin + log_tstep * i));
+        filters.emplace_back([t](FT lambda) { return std::exp(-t * lambda); });
+    }
+
+    SpMat cot_mat = cotangent_matrix(mesh);
+    SpMat mass_mat = mass_matrix(mesh);
+    Eigen::Matrix<FT, Eigen::Dynamic, Eigen::Dynamic> diagonals;
+    Eigen::Matrix<FT, Eigen::Dynamic, 1> traces;
+    filter_diagonals(
+        cot_mat, mass_mat, filters, diagonals, traces, order, probes);
+
+    hks.derived() = diagonals.transpose().array();
+    hks.colwise() /= hks.rowwise().sum();
+}
+
 } // namespace Euclid
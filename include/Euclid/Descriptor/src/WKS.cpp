@@ -1,9 +1,13 @@
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <stdexcept>
+#include <vector>
 
 #include <Eigen/QR>
 #include <Euclid/Geometry/Spectral.h>
+#include <Euclid/Geometry/SpectralFilter.h>
+#include <Euclid/Geometry/TriMeshGeometry.h>
 
 namespace Euclid
 {
@@ -77,4 +81,46 @@ void WKS<Mesh>::compute(Eigen::ArrayBase<Derived>& wks,
     }
 }
 
+template<typename Mesh, typename Derived>
+void matrix_free_wks(const Mesh& mesh,
+                     Eigen::ArrayBase<Derived>& wks,
+                     unsigned escales,
+                     float emin,
+                     float emax,
+                     float sigma,
+                     unsigned order,
+                     unsigned probes)
+{
+    using FT = FT_t<Mesh>;
+    using SpMat = Eigen::SparseMatrix<FT>;
+    if (emin >= emax || sigma <= 0) {
+        throw std::invalid_argument("Invalid energy range.");
+    }
+    auto estep = (emax - emin) / escales;
+    auto edenom = static_cast<FT>(0.5f / (sigma * sigma));
+
+    // Log-normal band-pass filters, vanishing on the constant eigenfunction
+    std::vector<std::function<FT(FT)>> filters;
+    filters.reserve(escales);
+    for (size_t i = 0; i < escales; ++i) {
+        auto e = static_cast<FT>(emin + estep * i);
+        filters.emplace_back([e, edenom](FT lambda) {
+            if (lambda <= 0) {
+                return static_cast<FT>(0);
+            }
+            return std::exp(-std::pow(e - std::log(lambda), 2) * edenom);
+        });
+    }
+
+    SpMat cot_mat = cotangent_matrix(mesh);
+    SpMat mass_mat = mass_matrix(mesh);
+    Eigen::Matrix<FT, Eigen::Dynamic, Eigen::Dynamic> diagonals;
+    Eigen::Matrix<FT, Eigen::Dynamic, 1> traces;
+    filter_diagonals(
+        cot_mat, mass_mat, filters, diagonals, traces, order, probes);
+
+    wks.derived() = diagonals.transpose().array();
+    wks.colwise() /= traces.array();
+}
+
 } // namespace Euclid
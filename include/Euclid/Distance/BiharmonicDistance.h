@@ -1,6 +1,10 @@
 #pragma once
 
+#include <vector>
 #include <Eigen/Core>
+#include <Eigen/SparseCholesky>
+#include <Euclid/MeshUtil/MeshDefs.h>
+#include <Euclid/Util/Memory.h>
 
 namespace Euclid
 {
@@ -26,6 +30,111 @@ T biharmonic_distance(const Eigen::MatrixBase<DerivedA>& lambdas,
                       int x,
                       int y);
 
+/** Exact biharmonic distance.
+ *
+ *  Instead of truncating the spectrum, the biharmonic Green's function
+ *  @f$G = (L^{+})^T A L^{+}@f$ is applied by two sparse solves with the
+ *  cotangent matrix, which is factorized only once. A distance field from a
+ *  source vertex needs the diagonal of @f$G@f$ as well, which takes one
+ *  batched solve per vertex and is computed lazily on first use. Batches of
+ *  right hand sides are solved in parallel.
+ *
+ *  The mesh should be connected.
+ *
+ *  **Reference**
+ *
+ *  [1] Lipman, Y., Rustamov, R., Funkhouser, T.
+ *  Biharmonic distance.
+ */
+template<typename Mesh>
+class ExactBiharmonicDistance
+{
+public:
+    using FT = FT_t<Mesh>;
+    using SpMat = Eigen::SparseMatrix<FT>;
+    using Mat = Eigen::Matrix<FT, Eigen::Dynamic, Eigen::Dynamic>;
+    using Vec = Eigen::Matrix<FT, Eigen::Dynamic, 1>;
+    using Vertex = typename boost::graph_traits<const Mesh>::vertex_descriptor;
+
+public:
+    /** Build up the necesssary computational components.
+     *
+     *  Compute the Laplacian matrix and pre-factor the linear system.
+     *
+     *  @param mesh Target triangle mesh.
+     *  @param cot_mat The cotangent matrix of the mesh, provide a value if you
+     *  have already computed it, otherwise it'll be computed internally.
+     *  @param mass_mat The mass matrix of the mesh, provide a value if you have
+     *  already computed it, otherwise it'll be computed internally.
+     */
+    void build(const Mesh& mesh,
+               const SpMat* cot_mat = nullptr,
+               const SpMat* mass_mat = nullptr);
+
+    /** Compute the biharmonic distance between two vertices.
+     *
+     *  Only needs two solves.
+     */
+    FT compute(const Vertex& v0, const Vertex& v1);
+
+    /** Compute biharmonic distances from a vertex.
+     *
+     *  @param v The vertex descriptor.
+     *  @param distances The output distances from all the mesh vertices to
+     *  the target vertex v.
+     */
+    template<typename T>
+    void compute(const Vertex& v, std::vector<T>& distances);
+
+    /** Compute biharmonic distances from multiple vertices.
+     *
+     *  @param sources The source vertices.
+     *  @param distances The output nv x sources.size() distances, each column
+     *  is the distance field of a source.
+     */
+    template<typename Derived>
+    void compute(const std::vector<Vertex>& sources,
+                 Eigen::MatrixBase<Derived>& distances);
+
+public:
+    /** The target mesh.
+     *
+     */
+    const Mesh* mesh = nullptr;
+
+    /** Cotangent matrix.
+     *
+     */
+    ProPtr<const SpMat> cot_mat = nullptr;
+
+    /** Mass matrix.
+     *
+     */
+    ProPtr<const SpMat> mass_mat = nullptr;
+
+    /** The solver of the cotangent matrix, with one vertex pinned.
+     *
+     */
+    Eigen::SimplicialLDLT<SpMat> solver;
+
+    /** Diagonal of the biharmonic Green's function.
+     *
+     *  Empty until a distance field is computed.
+     */
+    Vec diagonal;
+
+private:
+    Mat _green(const Mat& rhs) const;
+
+    Mat _solve(const Mat& rhs) const;
+
+    void _compute_diagonal();
+
+private:
+    Vec _mass;
+    FT _area = 0;
+};
+
 /** @}*/
 } // namespace Euclid
 
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <Eigen/Core>
+
+namespace Euclid
+{
+/**@{ @ingroup PkgDistance*/
+
+/** Types of spectral distances.
+ *
+ *  @sa biharmonic_distance, diffusion_distance, commute_time_distance
+ */
+enum class SpectralDistance
+{
+    biharmonic,
+    diffusion,
+    commute_time
+};
+
+/** Spectral embedding of mesh vertices.
+ *
+ *  Biharmonic, diffusion and commute time distances are all Euclidean
+ *  distances between rows of the eigenfunctions, each column scaled by a
+ *  function of its eigenvalue. This class scales the eigenfunctions once and
+ *  stores the embedding of every vertex contiguously, so that a whole
+ *  distance field is a single matrix-vector product and a block of pairwise
+ *  distances is a single matrix-matrix product.
+ *
+ *  Eigenpairs with a (numerically) zero eigenvalue are constant on each
+ *  connected component and don't contribute to any of these distances, they
+ *  are dropped from the embedding.
+ */
+template<typename T>
+class SpectralEmbedding
+{
+public:
+    using Mat = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+    using Vec = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+
+public:
+    /** Build the embedding.
+     *
+     *  @param lambdas Eigenvalues.
+     *  @param phis Eigenfunctions, one column for each eigenvalue.
+     *  @param type Type of the spectral distance.
+     *  @param t Diffusion time, only used by the diffusion distance.
+     */
+    template<typename DerivedA, typename DerivedB>
+    void build(const Eigen::MatrixBase<DerivedA>& lambdas,
+               const Eigen::MatrixBase<DerivedB>& phis,
+               SpectralDistance type,
+               double t = 0.1);
+
+    /** Distance between two vertices.
+     *
+     */
+    T distance(int x, int y) const;
+
+    /** Distances from a vertex to all the vertices.
+     *
+     *  @param x The source vertex.
+     *  @param dists The output distance field of size nv.
+     */
+    template<typename Derived>
+    void distances(int x, Eigen::MatrixBase<Derived>& dists) const;
+
+    /** A block of the pairwise distance matrix.
+     *
+     *  @param row The first vertex of the rows.
+     *  @param rows Number of rows.
+     *  @param col The first vertex of the columns.
+     *  @param cols Number of columns.
+     *  @param dists The output rows x cols distances.
+     */
+    template<typename Derived>
+    void distances(int row,
+                   int rows,
+                   int col,
+                   int cols,
+                   Eigen::MatrixBase<Derived>& dists) const;
+
+    /** The full pairwise distance matrix.
+     *
+     *  @param dists The output nv x nv distances.
+     */
+    template<typename Derived>
+    void distances(Eigen::MatrixBase<Derived>& dists) const;
+
+    /** Visit the pairwise distance matrix tile by tile.
+     *
+     *  For matrices that don't fit in memory. Tiles are computed in row major
+     *  order into a single reused buffer, and passed to
+     *  callback(row, col, tile) before the next one is computed, where row and
+     *  col are the first vertices of the tile.
+     *
+     *  @param tile_size The maximum number of rows and columns of a tile.
+     *  @param callback The tile visitor.
+     */
+    template<typename Callback>
+    void for_each_tile(int tile_size, Callback&& callback) const;
+
+    /** Number of vertices.
+     *
+     */
+    int size() const;
+
+public:
+    /** The embedding.
+     *
+     *  Each column is the embedding of a vertex.
+     */
+    Mat embedding;
+
+    /** Squared norms of the embedding of each vertex.
+     *
+     */
+    Vec sqnorms;
+};
+
+/** @}*/
+} // namespace Euclid
+
+#include "src/SpectralEmbedding.cpp"
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Core>
+#include <Euclid/Distance/SpectralEmbedding.h>
+
+namespace Euclid
+{
+/**@{ @ingroup PkgDistance*/
+
+/** Nearest neighbor search in a spectral embedding.
+ *
+ *  A k-d tree built over the leading dimensions of a SpectralEmbedding,
+ *  which carry most of the energy of biharmonic, diffusion and commute time
+ *  distances. Distances restricted to the leading dimensions are lower bounds
+ *  of the full distances, so the tree is only used for pruning, and every
+ *  candidate is verified with the full embedding. The results are exact.
+ *
+ *  The query vertex itself is included in the results.
+ */
+template<typename T>
+class SpectralKdTree
+{
+public:
+    /** Build the tree.
+     *
+     *  The embedding should outlive the tree, and have at least one
+     *  dimension.
+     *
+     *  @param embedding The spectral embedding.
+     *  @param dims Number of leading dimensions used by the tree.
+     *  @param leaf_size Maximum number of vertices in a leaf.
+     */
+    void build(const SpectralEmbedding<T>& embedding,
+               int dims = 8,
+               int leaf_size = 16);
+
+    /** Find the k nearest vertices of a vertex.
+     *
+     *  @param x The query vertex.
+     *  @param k Number of neighbors.
+     *  @param indices The output neighbors, sorted by distance.
+     *  @param distances The output distances of the neighbors.
+     */
+    void knn(int x,
+             int k,
+             std::vector<int>& indices,
+             std::vector<T>& distances) const;
+
+    /** Find the k nearest vertices of a point in the embedding space.
+     *
+     *  @param point The query point, of the same dimension as the embedding.
+     *  @param k Number of neighbors.
+     *  @param indices The output neighbors, sorted by distance.
+     *  @param distances The output distances of the neighbors.
+     */
+    template<typename Derived>
+    void knn(const Eigen::MatrixBase<Derived>& point,
+             int k,
+             std::vector<int>& indices,
+             std::vector<T>& distances) const;
+
+    /** Find all the vertices within a radius of a vertex.
+     *
+     *  @param x The query vertex.
+     *  @param radius The search radius.
+     *  @param indices The output neighbors, sorted by distance.
+     *  @param distances The output distances of the neighbors.
+     */
+    void radius(int x,
+                T radius,
+                std::vector<int>& indices,
+                std::vector<T>& distances) const;
+
+    /** Find all the vertices within a radius of a point.
+     *
+     *  @param point The query point, of the same dimension as the embedding.
+     *  @param radius The search radius.
+     *  @param indices The output neighbors, sorted by distance.
+     *  @param distances The output distances of the neighbors.
+     */
+    template<typename Derived>
+    void radius(const Eigen::MatrixBase<Derived>& point,
+                T radius,
+                std::vector<int>& indices,
+                std::vector<T>& distances) const;
+
+public:
+    /** The spectral embedding.
+     *
+     */
+    const SpectralEmbedding<T>* embedding = nullptr;
+
+    /** Number of leading dimensions used by the tree.
+     *
+     */
+    int dims = 0;
+
+private:
+    struct Node
+    {
+        int begin;
+        int end;
+        int left = -1;
+        int right = -1;
+        int axis = -1;
+        T split = 0;
+    };
+
+    int _build(int begin, int end, int leaf_size);
+
+    T _box_distance(int node, const T* point) const;
+
+    template<typename Visitor>
+    void _search(int node, const T* point, Visitor& visitor) const;
+
+private:
+    std::vector<Node> _nodes;
+    std::vector<int> _order;
+    std::vector<T> _lower;
+    std::vector<T> _upper;
+    Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> _leading;
+};
+
+/** @}*/
+} // namespace Euclid
+
+#include "src/SpectralKdTree.cpp"
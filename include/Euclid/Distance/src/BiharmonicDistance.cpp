@@ -1,8 +1,23 @@
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
+
+#include <Euclid/Geometry/TriMeshGeometry.h>
 
 namespace Euclid
 {
 
+namespace _impl
+{
+
+/** Number of right hand sides solved together by a thread.*/
+constexpr const int biharmonic_batch_size = 16;
+
+/** Number of diagonal elements of the Green's function computed together.*/
+constexpr const int biharmonic_diagonal_block = 256;
+
+} // namespace _impl
+
 template<typename DerivedA, typename DerivedB, typename T>
 T biharmonic_distance(const Eigen::MatrixBase<DerivedA>& lambdas,
                       const Eigen::MatrixBase<DerivedB>& phis,
@@ -18,4 +33,153 @@ T biharmonic_distance(const Eigen::MatrixBase<DerivedA>& lambdas,
     return std::sqrt(dist);
 }
 
+template<typename Mesh>
+void ExactBiharmonicDistance<Mesh>::build(const Mesh& mesh,
+                                          const SpMat* cot_mat,
+                                          const SpMat* mass_mat)
+{
+    this->mesh = &mesh;
+    if (cot_mat) {
+        this->cot_mat.reset(cot_mat);
+    }
+    else {
+        this->cot_mat.reset(new SpMat(cotangent_matrix(mesh)), true);
+    }
+    if (mass_mat) {
+        this->mass_mat.reset(mass_mat);
+    }
+    else {
+        this->mass_mat.reset(new SpMat(mass_matrix(mesh)), true);
+    }
+    _mass = this->mass_mat->diagonal();
+    _area = _mass.sum();
+    diagonal.resize(0);
+
+    // The cotangent matrix is singular, pin the first vertex to zero
+    SpMat pinned = *this->cot_mat;
+    for (int j = 0; j < pinned.outerSize(); ++j) {
+        for (typename SpMat::InnerIterator it(pinned, j); it; ++it) {
+            if (it.row() == 0 || it.col() == 0) {
+                it.valueRef() = (it.row() == it.col() ? 1 : 0);
+            }
+        }
+    }
+    pinned.prune(static_cast<FT>(0));
+    pinned.coeffRef(0, 0) = 1;
+
+    this->solver.compute(pinned);
+    if (this->solver.info() != Eigen::Success) {
+        throw std::runtime_error("Unable to factor the cotangent matrix.");
+    }
+}
+
+template<typename Mesh>
+typename ExactBiharmonicDistance<Mesh>::Mat
+ExactBiharmonicDistance<Mesh>::_solve(const Mat& rhs) const
+{
+    // Project out the constant functions so that the pinned system is
+    // consistent, then make the solutions mass-orthogonal to constants
+    Mat b = rhs;
+    Eigen::Matrix<FT, 1, Eigen::Dynamic> sums = b.colwise().sum() / _area;
+    b.noalias() -= _mass * sums;
+    b.row(0).setZero();
+
+    const int n = static_cast<int>(b.cols());
+    Mat x(b.rows(), n);
+#pragma omp parallel for schedule(dynamic)
+    for (int j = 0; j < n; j += _impl::biharmonic_batch_size) {
+        auto bs = std::min(_impl::biharmonic_batch_size, n - j);
+        x.middleCols(j, bs) = this->solver.solve(b.middleCols(j, bs));
+    }
+    if (this->solver.info() != Eigen::Success) {
+        throw std::runtime_error("Unable to solve the biharmonic equation.");
+    }
+
+    Eigen::Matrix<FT, 1, Eigen::Dynamic> means =
+        _mass.transpose() * x / _area;
+    x.rowwise() -= means;
+    return x;
+}
+
+template<typename Mesh>
+typename ExactBiharmonicDistance<Mesh>::Mat
+ExactBiharmonicDistance<Mesh>::_green(const Mat& rhs) const
+{
+    Mat u = _solve(rhs);
+    u = _mass.asDiagonal() * u;
+    return _solve(u);
+}
+
+template<typename Mesh>
+void ExactBiharmonicDistance<Mesh>::_compute_diagonal()
+{
+    const int nv = static_cast<int>(_mass.size());
+    diagonal.resize(nv);
+    for (int j = 0; j < nv; j += _impl::biharmonic_diagonal_block) {
+        auto bs = std::min(_impl::biharmonic_diagonal_block, nv - j);
+        Mat rhs = Mat::Zero(nv, bs);
+        rhs.middleRows(j, bs).setIdentity();
+        Mat g = _green(rhs);
+        diagonal.segment(j, bs) = g.middleRows(j, bs).diagonal();
+    }
+}
+
+template<typename Mesh>
+typename ExactBiharmonicDistance<Mesh>::FT
+ExactBiharmonicDistance<Mesh>::compute(const Vertex& v0, const Vertex& v1)
+{
+    auto vimap = get(boost::vertex_index, *this->mesh);
+    auto i0 = get(vimap, v0);
+    auto i1 = get(vimap, v1);
+    Mat rhs = Mat::Zero(_mass.size(), 1);
+    rhs(i0, 0) += 1;
+    rhs(i1, 0) -= 1;
+    Mat g = _green(rhs);
+    return std::sqrt(std::max(g(i0, 0) - g(i1, 0), static_cast<FT>(0)));
+}
+
+template<typename Mesh>
+template<typename T>
+void ExactBiharmonicDistance<Mesh>::compute(const Vertex& v,
+                                            std::vector<T>& distances)
+{
+    Mat dists;
+    compute(std::vector<Vertex>{ v }, dists);
+    distances.resize(dists.rows());
+    for (size_t i = 0; i < distances.size(); ++i) {
+        distances[i] = static_cast<T>(dists(i, 0));
+    }
+}
+
+template<typename Mesh>
+template<typename Derived>
+void ExactBiharmonicDistance<Mesh>::compute(
+    const std::vector<Vertex>& sources,
+    Eigen::MatrixBase<Derived>& distances)
+{
+    if (diagonal.size() == 0) {
+        _compute_diagonal();
+    }
+
+    auto vimap = get(boost::vertex_index, *this->mesh);
+    const int nv = static_cast<int>(_mass.size());
+    const int ns = static_cast<int>(sources.size());
+    Mat rhs = Mat::Zero(nv, ns);
+    for (int j = 0; j < ns; ++j) {
+        rhs(get(vimap, sources[j]), j) = 1;
+    }
+    Mat g = _green(rhs);
+
+    // d(x, y)^2 = G(x, x) + G(y, y) - 2G(x, y)
+    distances.derived().resize(nv, ns);
+    for (int j = 0; j < ns; ++j) {
+        auto s = get(vimap, sources[j]);
+        distances.col(j) =
+            ((diagonal.array() + g(s, j) - 2 * g.col(j).array()).max(0).sqrt())
+                .matrix()
+                .template cast<typename Derived::Scalar>();
+        distances(s, j) = 0;
+    }
+}
+
 } // namespace Euclid
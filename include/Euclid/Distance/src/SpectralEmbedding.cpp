@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Euclid
+{
+
+template<typename T>
+template<typename DerivedA, typename DerivedB>
+void SpectralEmbedding<T>::build(const Eigen::MatrixBase<DerivedA>& lambdas,
+                                 const Eigen::MatrixBase<DerivedB>& phis,
+                                 SpectralDistance type,
+                                 double t)
+{
+    if (lambdas.size() != phis.cols()) {
+        throw std::invalid_argument("Size of eigenpairs do not match.");
+    }
+
+    // Relative threshold of the zero eigenvalues
+    const T zero = static_cast<T>(1e-8) * lambdas.cwiseAbs().maxCoeff();
+    Vec weights(lambdas.size());
+    for (Eigen::Index i = 0; i < lambdas.size(); ++i) {
+        auto lambda = static_cast<T>(lambdas(i));
+        if (lambda <= zero) {
+            weights(i) = 0;
+            continue;
+        }
+        switch (type) {
+        case SpectralDistance::biharmonic:
+            weights(i) = 1 / lambda;
+            break;
+        case SpectralDistance::diffusion:
+            weights(i) = static_cast<T>(std::exp(-t * lambda));
+            break;
+        case SpectralDistance::commute_time:
+            weights(i) = 1 / std::sqrt(lambda);
+            break;
+        }
+    }
+
+    Eigen::Index k = 0;
+    for (Eigen::Index i = 0; i < weights.size(); ++i) {
+        if (weights(i) != 0) {
+            ++k;
+        }
+    }
+    embedding.resize(k, phis.rows());
+    for (Eigen::Index i = 0, j = 0; i < weights.size(); ++i) {
+        if (weights(i) != 0) {
+            embedding.row(j++) =
+                weights(i) * phis.col(i).transpose().template cast<T>();
+        }
+    }
+    sqnorms = embedding.colwise().squaredNorm().transpose();
+}
+
+template<typename T>
+T SpectralEmbedding<T>::distance(int x, int y) const
+{
+    return (embedding.col(x) - embedding.col(y)).norm();
+}
+
+template<typename T>
+template<typename Derived>
+void SpectralEmbedding<T>::distances(int x,
+                                     Eigen::MatrixBase<Derived>& dists) const
+{
+    // |a - b|^2 = |a|^2 + |b|^2 - 2 a.b
+    Vec dots = embedding.transpose() * embedding.col(x);
+    dists.derived().resize(size(), 1);
+    auto sqdists = sqnorms.array() + sqnorms(x) - 2 * dots.array();
+    dists = sqdists.max(0).sqrt().matrix();
+    dists(x) = 0;
+}
+
+template<typename T>
+template<typename Derived>
+void SpectralEmbedding<T>::distances(int row,
+                                     int rows,
+                                     int col,
+                                     int cols,
+                                     Eigen::MatrixBase<Derived>& dists) const
+{
+    dists.derived().resize(rows, cols);
+    dists.derived().noalias() = static_cast<T>(-2) *
+                                embedding.middleCols(row, rows).transpose() *
+                                embedding.middleCols(col, cols);
+#pragma omp parallel for
+    for (int j = 0; j < cols; ++j) {
+        for (int i = 0; i < rows; ++i) {
+            auto d = dists(i, j) + sqnorms(row + i) + sqnorms(col + j);
+            dists(i, j) = (d > 0 && row + i != col + j) ? std::sqrt(d) : 0;
+        }
+    }
+}
+
+template<typename T>
+template<typename Derived>
+void SpectralEmbedding<T>::distances(Eigen::MatrixBase<Derived>& dists) const
+{
+    distances(0, size(), 0, size(), dists);
+}
+
+template<typename T>
+template<typename Callback>
+void SpectralEmbedding<T>::for_each_tile(int tile_size,
+                                         Callback&& callback) const
+{
+    if (tile_size <= 0) {
+        throw std::invalid_argument("tile_size should be positive.");
+    }
+    const int nv = size();
+    Mat tile;
+    for (int row = 0; row < nv; row += tile_size) {
+        auto rows = std::min(tile_size, nv - row);
+        for (int col = 0; col < nv; col += tile_size) {
+            auto cols = std::min(tile_size, nv - col);
+            distances(row, rows, col, cols, tile);
+            callback(row, col, static_cast<const Mat&>(tile));
+        }
+    }
+}
+
+template<typename T>
+int SpectralEmbedding<T>::size() const
+{
+    return static_cast<int>(embedding.cols());
+}
+
+} // namespace Euclid
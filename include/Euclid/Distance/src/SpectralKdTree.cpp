@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+namespace Euclid
+{
+
+template<typename T>
+void SpectralKdTree<T>::build(const SpectralEmbedding<T>& embedding,
+                              int dims,
+                              int leaf_size)
+{
+    if (dims <= 0 || leaf_size <= 0) {
+        throw std::invalid_argument("dims and leaf_size should be positive.");
+    }
+    if (embedding.embedding.rows() == 0) {
+        throw std::invalid_argument("The embedding has no dimension.");
+    }
+    this->embedding = &embedding;
+    this->dims = std::min(dims, static_cast<int>(embedding.embedding.rows()));
+
+    const int nv = embedding.size();
+    _order.resize(nv);
+    std::iota(_order.begin(), _order.end(), 0);
+    _nodes.clear();
+    _lower.clear();
+    _upper.clear();
+    if (nv > 0) {
+        _build(0, nv, leaf_size);
+    }
+
+    // Store the leading coordinates in tree order for coherent leaf scans
+    _leading.resize(this->dims, nv);
+    for (int i = 0; i < nv; ++i) {
+        _leading.col(i) = embedding.embedding.col(_order[i]).head(this->dims);
+    }
+}
+
+template<typename T>
+int SpectralKdTree<T>::_build(int begin, int end, int leaf_size)
+{
+    const auto& coords = embedding->embedding;
+    const int id = static_cast<int>(_nodes.size());
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    _nodes.push_back(node);
+
+    _lower.resize(_lower.size() + dims, std::numeric_limits<T>::max());
+    _upper.resize(_upper.size() + dims, std::numeric_limits<T>::lowest());
+    auto lower = _lower.data() + id * dims;
+    auto upper = _upper.data() + id * dims;
+    for (int i = begin; i < end; ++i) {
+        for (int d = 0; d < dims; ++d) {
+            auto value = coords(d, _order[i]);
+            lower[d] = std::min(lower[d], value);
+            upper[d] = std::max(upper[d], value);
+        }
+    }
+
+    if (end - begin <= leaf_size) {
+        return id;
+    }
+    int axis = 0;
+    for (int d = 1; d < dims; ++d) {
+        if (upper[d] - lower[d] > upper[axis] - lower[axis]) {
+            axis = d;
+        }
+    }
+    if (upper[axis] <= lower[axis]) {
+        return id; // all the points coincide
+    }
+
+    auto mid = begin + (end - begin) / 2;
+    std::nth_element(_order.begin() + begin,
+                     _order.begin() + mid,
+                     _order.begin() + end,
+                     [&coords, axis](int a, int b) {
+                         return coords(axis, a) < coords(axis, b);
+                     });
+    auto split = coords(axis, _order[mid]);
+    auto left = _build(begin, mid, leaf_size);
+    auto right = _build(mid, end, leaf_size);
+    _nodes[id].axis = axis;
+    _nodes[id].split = split;
+    _nodes[id].left = left;
+    _nodes[id].right = right;
+    return id;
+}
+
+template<typename T>
+T SpectralKdTree<T>::_box_distance(int node, const T* point) const
+{
+    auto lower = _lower.data() + node * dims;
+    auto upper = _upper.data() + node * dims;
+    T dist = 0;
+    for (int d = 0; d < dims; ++d) {
+        T diff = 0;
+        if (point[d] < lower[d]) {
+            diff = lower[d] - point[d];
+        }
+        else if (point[d] > upper[d]) {
+            diff = point[d] - upper[d];
+        }
+        dist += diff * diff;
+    }
+    return dist;
+}
+
+template<typename T>
+template<typename Visitor>
+void SpectralKdTree<T>::_search(int node,
+                                const T* point,
+                                Visitor& visitor) const
+{
+    if (_box_distance(node, point) > visitor.bound) {
+        return;
+    }
+
+    const auto& n = _nodes[node];
+    if (n.axis < 0) {
+        const auto& coords = embedding->embedding;
+        const int k = static_cast<int>(coords.rows());
+        for (int i = n.begin; i < n.end; ++i) {
+            // Lower bound from the leading dimensions, then the exact distance
+            // with early termination
+            auto lead = _leading.col(i).data();
+            T dist = 0;
+            for (int d = 0; d < dims; ++d) {
+                auto diff = lead[d] - point[d];
+                dist += diff * diff;
+            }
+            if (dist > visitor.bound) {
+                continue;
+            }
+            auto v = _order[i];
+            auto full = coords.col(v).data();
+            for (int d = dims; d < k && dist <= visitor.bound; ++d) {
+                auto diff = full[d] - point[d];
+                dist += diff * diff;
+            }
+            if (dist <= visitor.bound) {
+                visitor.visit(v, dist);
+            }
+        }
+        return;
+    }
+
+    if (point[n.axis] < n.split) {
+        _search(n.left, point, visitor);
+        _search(n.right, point, visitor);
+    }
+    else {
+        _search(n.right, point, visitor);
+        _search(n.left, point, visitor);
+    }
+}
+
+template<typename T>
+void SpectralKdTree<T>::knn(int x,
+                            int k,
+                            std::vector<int>& indices,
+                            std::vector<T>& distances) const
+{
+    knn(embedding->embedding.col(x), k, indices, distances);
+}
+
+template<typename T>
+template<typename Derived>
+void SpectralKdTree<T>::knn(const Eigen::MatrixBase<Derived>& point,
+                            int k,
+                            std::vector<int>& indices,
+                            std::vector<T>& distances) const
+{
+    if (point.size() != embedding->embedding.rows()) {
+        throw std::invalid_argument("Dimension of the query is incorrect.");
+    }
+    indices.clear();
+    distances.clear();
+    if (k <= 0 || _nodes.empty()) {
+        return;
+    }
+
+    struct KnnVisitor
+    {
+        size_t k;
+        T bound = std::numeric_limits<T>::max();
+        std::priority_queue<std::pair<T, int>> heap;
+
+        void visit(int v, T dist)
+        {
+            heap.emplace(dist, v);
+            if (heap.size() > k) {
+                heap.pop();
+            }
+            if (heap.size() == k) {
+                bound = heap.top().first;
+            }
+        }
+    };
+
+    Eigen::Matrix<T, Eigen::Dynamic, 1> query = point.template cast<T>();
+    KnnVisitor visitor;
+    visitor.k = static_cast<size_t>(k);
+    _search(0, query.data(), visitor);
+
+    indices.resize(visitor.heap.size());
+    distances.resize(visitor.heap.size());
+    for (auto i = indices.size(); i-- > 0;) {
+        indices[i] = visitor.heap.top().second;
+        distances[i] = std::sqrt(visitor.heap.top().first);
+        visitor.heap.pop();
+    }
+}
+
+template<typename T>
+void SpectralKdTree<T>::radius(int x,
+                               T radius,
+                               std::vector<int>& indices,
+                               std::vector<T>& distances) const
+{
+    this->radius(embedding->embedding.col(x), radius, indices, distances);
+}
+
+template<typename T>
+template<typename Derived>
+void SpectralKdTree<T>::radius(const Eigen::MatrixBase<Derived>& point,
+                               T radius,
+                               std::vector<int>& indices,
+                               std::vector<T>& distances) const
+{
+    if (point.size() != embedding->embedding.rows()) {
+        throw std::invalid_argument("Dimension of the query is incorrect.");
+    }
+    indices.clear();
+    distances.clear();
+    if (radius < 0 || _nodes.empty()) {
+        return;
+    }
+
+    struct RadiusVisitor
+    {
+        T bound;
+        std::vector<std::pair<T, int>> neighbors;
+
+        void visit(int v, T dist)
+        {
+            neighbors.emplace_back(dist, v);
+        }
+    };
+
+    Eigen::Matrix<T, Eigen::Dynamic, 1> query = point.template cast<T>();
+    RadiusVisitor visitor;
+    visitor.bound = radius * radius;
+    _search(0, query.data(), visitor);
+
+    std::sort(visitor.neighbors.begin(), visitor.neighbors.end());
+    indices.reserve(visitor.neighbors.size());
+    distances.reserve(visitor.neighbors.size());
+    for (const auto& neighbor : visitor.neighbors) {
+        indices.push_back(neighbor.second);
+        distances.push_back(std::sqrt(neighbor.first));
+    }
+}
+
+} // namespace Euclid
@@ -63,6 +63,52 @@ unsigned spectrum(const Mesh& mesh,
                   unsigned max_iter = 1000,
                   double tolerance = 1e-10);
 
+/**Approximate spectral decomposition of a mesh.
+ *
+ * Randomized subspace iteration on the shift-inverted operator, followed by a
+ * Rayleigh-Ritz projection. A random block of k + oversampling vectors is
+ * pushed through a few power iterations, each being one batch of sparse
+ * solves with a pre-factored matrix and one dense QR. This parallelizes much
+ * better than the Lanczos restarts used by spectrum, and is meant for quick
+ * looks on very large meshes.
+ *
+ * For each eigenpair an error estimate @f$\|L\phi - \lambda A\phi\|_{A^{-1}}@f$
+ * is reported, which bounds the distance from the approximated eigenvalue to
+ * the nearest exact one.
+ *
+ * @param mesh The input mesh.
+ * @param k The number of eigenvalues to compute.
+ * @param lambdas The output eigenvalues, sorted in ascending order.
+ * @param phis The output eigenfunctions corresponding to the eigenvalues.
+ * @param errors The output error estimates of each eigenpair.
+ * @param op The operator to use.
+ * @param oversampling The number of extra vectors in the random subspace.
+ * Larger values improve the accuracy of the last eigenpairs.
+ * @param power_iters The number of power iterations.
+ * @param seed The seed of the random starting subspace.
+ *
+ * @return The number of eigenpairs.
+ *
+ * **Reference**
+ *
+ * [1] Halko, N., Martinsson, P. G., Tropp, J. A.
+ * Finding structure with randomness: Probabilistic algorithms for constructing
+ * approximate matrix decompositions.
+ * SIAM Review, 2011.
+ *
+ * @sa spectrum
+ */
+template<typename Mesh, typename DerivedA, typename DerivedB, typename DerivedC>
+unsigned approximate_spectrum(const Mesh& mesh,
+                              unsigned k,
+                              Eigen::MatrixBase<DerivedA>& lambdas,
+                              Eigen::MatrixBase<DerivedB>& phis,
+                              Eigen::MatrixBase<DerivedC>& errors,
+                              SpecOp op = SpecOp::mesh_laplacian,
+                              unsigned oversampling = 10,
+                              unsigned power_iters = 4,
+                              unsigned seed = 0);
+
 /** @}*/
 } // namespace Euclid
 
@@ -0,0 +1,110 @@
+/** Matrix-free spectral filtering.
+ *
+ *  Many spectral quantities, e.g. the heat kernel signature, are diagonals of
+ *  a filtered Laplacian @f$\Phi g(\Lambda) \Phi^T@f$. This package estimates
+ *  such diagonals without computing any eigenpairs, by expanding the filters
+ *  into Chebyshev polynomials of the Laplacian and probing them with random
+ *  vectors. The cost is dominated by sparse matrix-vector products, so it
+ *  scales to meshes where eigen decomposition is infeasible.
+ *
+ *  **References**
+ *
+ *  [1] Hutchinson, M. F.
+ *  A stochastic estimator of the trace of the influence matrix for Laplacian
+ *  smoothing splines.
+ *  Communications in Statistics - Simulation and Computation, 1990.
+ *
+ *  [2] Bekas, C., Kokiopoulou, E., Saad, Y.
+ *  An estimator for the diagonal of a matrix.
+ *  Applied Numerical Mathematics, 2007.
+ *
+ *  [3] Hammond, D. K., Vandergheynst, P., Gribonval, R.
+ *  Wavelets on graphs via spectral graph theory.
+ *  Applied and Computational Harmonic Analysis, 2011.
+ *
+ *  @defgroup PkgSpectralFilter Spectral Filter
+ *  @ingroup PkgGeometry
+ */
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+namespace Euclid
+{
+/** @{*/
+
+/** An upper bound of the spectrum of the mesh Laplacian.
+ *
+ *  Return a Gershgorin bound of the largest eigenvalue of the generalized
+ *  eigen problem @f$L\phi = \lambda A\phi@f$, where @f$L@f$ is the cotangent
+ *  matrix and @f$A@f$ is the lumped mass matrix.
+ *
+ *  @param cot_mat The cotangent matrix.
+ *  @param mass_mat The diagonal mass matrix.
+ *
+ *  @sa cotangent_matrix, mass_matrix
+ */
+template<typename T>
+T max_eigenvalue_bound(const Eigen::SparseMatrix<T>& cot_mat,
+                       const Eigen::SparseMatrix<T>& mass_mat);
+
+/** Chebyshev coefficients of a spectral filter.
+ *
+ *  Approximate g on @f$[0, \lambda_{max}]@f$ by
+ *  @f$\sum_k c_k T_k(2\lambda/\lambda_{max} - 1)@f$.
+ *
+ *  @param filter The filter function g.
+ *  @param order The order of the polynomial expansion.
+ *  @param lambda_max The upper bound of the spectrum.
+ *  @param coefficients The output coefficients, of size order + 1.
+ */
+template<typename T, typename Derived>
+void chebyshev_coefficients(const std::function<T(T)>& filter,
+                            unsigned order,
+                            T lambda_max,
+                            Eigen::MatrixBase<Derived>& coefficients);
+
+/** Estimate the diagonals of filtered Laplacians.
+ *
+ *  For each filter @f$g@f$, estimate @f$\sum_i g(\lambda_i) \phi_i(x)^2@f$ for
+ *  all vertices x, as well as the trace @f$\sum_i g(\lambda_i)@f$, where
+ *  @f$(\lambda_i, \phi_i)@f$ are all the mass-normalized eigenpairs of the
+ *  mesh Laplacian. The filters are expanded into Chebyshev polynomials and
+ *  evaluated on random Rademacher probes, all filters sharing the same
+ *  polynomial recurrence.
+ *
+ *  **Note**
+ *
+ *  The filters should be smooth on the spectrum. The order needed to resolve
+ *  a heat kernel @f$e^{-t\lambda}@f$ grows roughly like
+ *  @f$\sqrt{t\lambda_{max}}@f$, so large time scales need high orders. The
+ *  variance of the estimation decreases linearly with the number of probes.
+ *
+ *  @param cot_mat The cotangent matrix.
+ *  @param mass_mat The diagonal mass matrix.
+ *  @param filters The spectral filters.
+ *  @param diagonals The output nv x filters.size() matrix of diagonals.
+ *  @param traces The output traces of each filter.
+ *  @param order The order of the Chebyshev expansion.
+ *  @param probes The number of random probing vectors.
+ *  @param seed The seed of the random probes.
+ *
+ *  @sa max_eigenvalue_bound, chebyshev_coefficients
+ */
+template<typename T, typename DerivedA, typename DerivedB>
+void filter_diagonals(const Eigen::SparseMatrix<T>& cot_mat,
+                      const Eigen::SparseMatrix<T>& mass_mat,
+                      const std::vector<std::function<T(T)>>& filters,
+                      Eigen::MatrixBase<DerivedA>& diagonals,
+                      Eigen::MatrixBase<DerivedB>& traces,
+                      unsigned order = 100,
+                      unsigned probes = 64,
+                      unsigned seed = 0);
+
+/** @}*/
+} // namespace Euclid
+
+#include "src/SpectralFilter.cpp"
@@ -1,6 +1,12 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
 #include <string>
 
 #include <CGAL/boost/graph/properties.h>
+#include <Eigen/Eigenvalues>
+#include <Eigen/QR>
+#include <Eigen/SparseCholesky>
 #include <Eigen/SparseCore>
 #include <Euclid/Geometry/TriMeshGeometry.h>
 #include <Euclid/Util/Assert.h>
@@ -77,6 +83,89 @@ unsigned gen_solve(const Eigen::SparseMatrix<T>& S,
     return n;
 }
 
+/** Number of right hand sides solved together by a thread.*/
+constexpr const int randomized_batch_size = 16;
+
+/** Shift of the inverted operator, relative to the mean diagonal.*/
+constexpr const double randomized_shift = 1e-4;
+
+template<typename T, typename DerivedA, typename DerivedB, typename DerivedC>
+void randomized_solve(const Eigen::SparseMatrix<T>& S,
+                      const Eigen::SparseMatrix<T>& D,
+                      int k,
+                      int oversampling,
+                      int power_iters,
+                      unsigned seed,
+                      Eigen::MatrixBase<DerivedA>& lambdas,
+                      Eigen::MatrixBase<DerivedB>& phis,
+                      Eigen::MatrixBase<DerivedC>& errors)
+{
+    using Mat = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+    using Vec = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    using SpMat = Eigen::SparseMatrix<T>;
+    const int nv = static_cast<int>(S.rows());
+    const int l = std::min(k + oversampling, nv);
+
+    // A small shift relative to the scale of the spectrum keeps S + sD
+    // positive definite while separating the smallest eigenvalues well
+    Vec mass = D.diagonal();
+    Vec sqrt_mass = mass.cwiseSqrt();
+    Vec rsqrt_mass = sqrt_mass.cwiseInverse();
+    T shift = static_cast<T>(randomized_shift) *
+              (S.diagonal().array() / mass.array()).mean();
+    SpMat shifted = S + shift * D;
+    Eigen::SimplicialLDLT<SpMat> solver(shifted);
+    if (solver.info() != Eigen::Success) {
+        throw std::runtime_error("Unable to factor the shifted operator.");
+    }
+
+    // Q = (S + sD)^{-1} D Q, then D-orthonormalize Q
+    Mat Q(nv, l);
+    Mat Y(nv, l);
+    auto iterate = [&]() {
+        Y.noalias() = mass.asDiagonal() * Q;
+#pragma omp parallel for schedule(dynamic)
+        for (int j = 0; j < l; j += randomized_batch_size) {
+            auto bs = std::min(randomized_batch_size, l - j);
+            Q.middleCols(j, bs) = solver.solve(Y.middleCols(j, bs));
+        }
+        Y.noalias() = sqrt_mass.asDiagonal() * Q;
+        Eigen::HouseholderQR<Mat> qr(Y);
+        Q.noalias() = rsqrt_mass.asDiagonal() *
+                      (qr.householderQ() * Mat::Identity(nv, l));
+    };
+
+    std::mt19937 rd_gen(seed);
+    std::normal_distribution<T> rd_normal;
+    for (int j = 0; j < l; ++j) {
+        for (int i = 0; i < nv; ++i) {
+            Q(i, j) = rd_normal(rd_gen);
+        }
+    }
+    for (int i = 0; i <= power_iters; ++i) {
+        iterate();
+    }
+
+    // Rayleigh-Ritz projection
+    Mat SQ = S * Q;
+    Mat A = Q.transpose() * SQ;
+    Mat B = Q.transpose() * mass.asDiagonal() * Q;
+    A = (A + A.transpose()).eval() * static_cast<T>(0.5);
+    B = (B + B.transpose()).eval() * static_cast<T>(0.5);
+    Eigen::GeneralizedSelfAdjointEigenSolver<Mat> eigensolver(A, B);
+    if (eigensolver.info() != Eigen::Success) {
+        throw std::runtime_error("Eigen decomposition failed.");
+    }
+    Vec values = eigensolver.eigenvalues().head(k);
+    Mat vectors = eigensolver.eigenvectors().leftCols(k);
+
+    lambdas = values;
+    phis = Q * vectors;
+    Mat residuals = SQ * vectors;
+    residuals -= mass.asDiagonal() * phis * values.asDiagonal();
+    errors = (rsqrt_mass.asDiagonal() * residuals).colwise().norm().transpose();
+}
+
 } // namespace _impl
 
 template<typename Mesh, typename DerivedA, typename DerivedB>
@@ -132,4 +221,68 @@ unsigned spectrum(const Mesh& mesh,
     return n;
 }
 
+template<typename Mesh, typename DerivedA, typename DerivedB, typename DerivedC>
+unsigned approximate_spectrum(const Mesh& mesh,
+                              unsigned k,
+                              Eigen::MatrixBase<DerivedA>& lambdas,
+                              Eigen::MatrixBase<DerivedB>& phis,
+                              Eigen::MatrixBase<DerivedC>& errors,
+                              SpecOp op,
+                              unsigned oversampling,
+                              unsigned power_iters,
+                              unsigned seed)
+{
+    using T = typename CGAL::Kernel_traits<typename boost::property_traits<
+        typename boost::property_map<Mesh, boost::vertex_point_t>::type>::
+                                               value_type>::Kernel::FT;
+    using SpMat = Eigen::SparseMatrix<T>;
+    auto nv = num_vertices(mesh);
+
+    if (k > nv) {
+        std::string err("You've requested ");
+        err.append(std::to_string(k));
+        err.append(" eigenvalues but there are only ");
+        err.append(std::to_string(nv));
+        err.append(" vertices in your mesh.");
+        EWARNING(err);
+        k = nv;
+    }
+
+    if (op == SpecOp::mesh_laplacian) {
+        SpMat C = Euclid::cotangent_matrix(mesh);
+        SpMat D = Euclid::mass_matrix(mesh);
+        _impl::randomized_solve(C,
+                                D,
+                                k,
+                                oversampling,
+                                power_iters,
+                                seed,
+                                lambdas,
+                                phis,
+                                errors);
+    }
+    else {
+        auto result = Euclid::adjacency_matrix(mesh);
+        SpMat A = std::get<0>(result);
+        SpMat D = std::get<1>(result);
+        SpMat L = D - A;
+        SpMat I(nv, nv);
+        I.setIdentity();
+        _impl::randomized_solve(L,
+                                I,
+                                k,
+                                oversampling,
+                                power_iters,
+                                seed,
+                                lambdas,
+                                phis,
+                                errors);
+    }
+    EASSERT(lambdas.rows() == k);
+    EASSERT(phis.cols() == k);
+    EASSERT(phis.rows() == nv);
+
+    return k;
+}
+
 } // namespace Euclid
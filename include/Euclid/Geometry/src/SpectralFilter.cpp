@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include <boost/math/constants/constants.hpp>
+
+namespace Euclid
+{
+
+namespace _impl
+{
+
+/** Number of probes that are pushed through the recurrence together.*/
+constexpr const int filter_block_size = 8;
+
+/** Number of polynomial terms accumulated before folding into the result.*/
+constexpr const int filter_chunk_size = 16;
+
+} // namespace _impl
+
+template<typename T>
+T max_eigenvalue_bound(const Eigen::SparseMatrix<T>& cot_mat,
+                       const Eigen::SparseMatrix<T>& mass_mat)
+{
+    using Vec = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    Vec rsqrt_mass = mass_mat.diagonal().cwiseSqrt().cwiseInverse();
+
+    // Gershgorin bound of M^{-1/2} L M^{-1/2}
+    Vec row_sums = Vec::Zero(cot_mat.rows());
+    for (int j = 0; j < cot_mat.outerSize(); ++j) {
+        for (typename Eigen::SparseMatrix<T>::InnerIterator it(cot_mat, j); it;
+             ++it) {
+            row_sums(it.row()) +=
+                std::abs(it.value()) * rsqrt_mass(it.row()) * rsqrt_mass(j);
+        }
+    }
+    return row_sums.maxCoeff();
+}
+
+template<typename T, typename Derived>
+void chebyshev_coefficients(const std::function<T(T)>& filter,
+                            unsigned order,
+                            T lambda_max,
+                            Eigen::MatrixBase<Derived>& coefficients)
+{
+    const auto pi = boost::math::constants::pi<T>();
+    const int n = 2 * (order + 1);
+    Eigen::Matrix<T, Eigen::Dynamic, 1> values(n);
+    for (int j = 0; j < n; ++j) {
+        auto theta = pi * (j + static_cast<T>(0.5)) / n;
+        auto lambda = (std::cos(theta) + 1) * static_cast<T>(0.5) * lambda_max;
+        values(j) = filter(lambda);
+    }
+
+    coefficients.derived().resize(order + 1, 1);
+    for (unsigned k = 0; k <= order; ++k) {
+        T c = 0;
+        for (int j = 0; j < n; ++j) {
+            c += values(j) * std::cos(k * pi * (j + static_cast<T>(0.5)) / n);
+        }
+        coefficients(k, 0) = c * 2 / n;
+    }
+    coefficients(0, 0) *= static_cast<T>(0.5);
+}
+
+template<typename T, typename DerivedA, typename DerivedB>
+void filter_diagonals(const Eigen::SparseMatrix<T>& cot_mat,
+                      const Eigen::SparseMatrix<T>& mass_mat,
+                      const std::vector<std::function<T(T)>>& filters,
+                      Eigen::MatrixBase<DerivedA>& diagonals,
+                      Eigen::MatrixBase<DerivedB>& traces,
+                      unsigned order,
+                      unsigned probes,
+                      unsigned seed)
+{
+    using Vec = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    using Mat = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+    using RowSpMat = Eigen::SparseMatrix<T, Eigen::RowMajor>;
+    const int nv = static_cast<int>(cot_mat.rows());
+    const int nf = static_cast<int>(filters.size());
+
+    if (cot_mat.rows() != cot_mat.cols() || mass_mat.rows() != nv) {
+        throw std::invalid_argument("Size of input matrices do not match.");
+    }
+    if (order == 0 || probes == 0) {
+        throw std::invalid_argument("order and probes should be positive.");
+    }
+
+    // Map the spectrum of the symmetric operator M^{-1/2} L M^{-1/2} onto
+    // [-1, 1], where the Chebyshev recurrence is stable
+    T lambda_max = max_eigenvalue_bound(cot_mat, mass_mat);
+    Vec rsqrt_mass = mass_mat.diagonal().cwiseSqrt().cwiseInverse();
+    RowSpMat op = (static_cast<T>(2) / lambda_max) * rsqrt_mass.asDiagonal() *
+                  cot_mat * rsqrt_mass.asDiagonal();
+    RowSpMat identity(nv, nv);
+    identity.setIdentity();
+    op -= identity;
+    op.makeCompressed();
+
+    Mat coefficients(order + 1, nf);
+    for (int f = 0; f < nf; ++f) {
+        Vec c;
+        chebyshev_coefficients(filters[f], order, lambda_max, c);
+        coefficients.col(f) = c;
+    }
+
+    // Accumulate z .* T_k(A) z for chunks of k and fold them into the result
+    Mat estimates = Mat::Zero(nv, nf);
+    Mat terms(nv, _impl::filter_chunk_size);
+    std::mt19937 rd_gen(seed);
+    std::bernoulli_distribution rd_sign;
+
+    for (unsigned p = 0; p < probes; p += _impl::filter_block_size) {
+        const int bs =
+            std::min(_impl::filter_block_size, static_cast<int>(probes - p));
+        Mat z(nv, bs);
+        for (int j = 0; j < bs; ++j) {
+            for (int i = 0; i < nv; ++i) {
+                z(i, j) = rd_sign(rd_gen) ? 1 : -1;
+            }
+        }
+
+        Mat t_prev = z;
+        Mat t_curr = op * z;
+        Mat t_next(nv, bs);
+        int chunk = 0;
+        for (unsigned k = 0; k <= order; ++k) {
+            const Mat& tk = (k == 0 ? t_prev : t_curr);
+#pragma omp parallel for
+            for (int i = 0; i < nv; ++i) {
+                terms(i, chunk) = z.row(i).dot(tk.row(i));
+            }
+            if (++chunk == _impl::filter_chunk_size || k == order) {
+                auto k0 = k + 1 - chunk;
+                estimates.noalias() +=
+                    terms.leftCols(chunk) * coefficients.middleRows(k0, chunk);
+                chunk = 0;
+            }
+            if (k >= 1 && k < order) {
+                t_next.noalias() = op * t_curr;
+                t_next = 2 * t_next - t_prev;
+                t_prev.swap(t_curr);
+                t_curr.swap(t_next);
+            }
+        }
+    }
+
+    // diag(Phi g Phi^T) = diag(M^{-1/2} g(A) M^{-1/2})
+    estimates /= static_cast<T>(probes);
+    traces.derived().resize(nf, 1);
+    traces = estimates.colwise().sum().transpose();
+    diagonals.derived().resize(nv, nf);
+    diagonals = rsqrt_mass.cwiseAbs2().asDiagonal() * estimates;
+}
+
+} // namespace Euclid
@@ -0,0 +1,263 @@
+/** Emesh I/O.
+ *
+ *  Emesh is the native binary mesh format of Euclid, meant for passing meshes
+ *  between processing stages without parsing text. A file is a directory of
+ *  named blocks, each holding a row-major matrix of values, e.g. positions,
+ *  indices, normals, texcoords, colors, per-vertex fields or the arrays of a
+ *  sparse operator. Blocks start at 64-byte aligned offsets so that a memory
+ *  mapped file can be used in place.
+ *
+ *  Blocks may optionally be compressed, floats by quantization to 16 bits and
+ *  integers by delta coding, in which case they have to be decoded instead.
+ *  Values are stored in the byte order of the machine writing the file.
+ *
+ *  @defgroup PkgEmeshIO Emesh I/O
+ *  @ingroup PkgIO
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+namespace Euclid
+{
+namespace _impl
+{
+// Forward declaration
+class MappedFile;
+
+/** Identity of T, a parameter of this type is not used for deduction.*/
+template<typename T>
+struct NonDeduced
+{
+    using type = T;
+};
+
+template<typename T>
+using NonDeduced_t = typename NonDeduced<T>::type;
+} // namespace _impl
+
+/** @{*/
+
+/** Type of the values in an emesh block.
+ *
+ */
+enum class EmeshType : uint32_t
+{
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    int64,
+    uint64,
+    float32,
+    float64
+};
+
+/** Encoding of the values in an emesh block.
+ *
+ */
+enum class EmeshEncoding : uint32_t
+{
+    raw,       /**< values as they are, usable in place.*/
+    quantized, /**< floats quantized to 16 bits within their column range.*/
+    delta      /**< integers as varints of the difference to the last one.*/
+};
+
+/** Description of an emesh block.
+ *
+ */
+struct EmeshBlock
+{
+    std::string name;
+    /** Type of the values before encoding.*/
+    EmeshType type;
+    EmeshEncoding encoding;
+    size_t rows;
+    size_t cols;
+};
+
+/** A writer of emesh files.
+ *
+ *  Blocks are encoded when they are added and written all at once.
+ *
+ *  **Note**
+ *
+ *  The common mesh properties are stored in blocks named positions, indices,
+ *  normals, texcoords and colors, which are the blocks used by read_emesh and
+ *  write_emesh.
+ */
+class EmeshWriter
+{
+public:
+    /** Add a block of rows x cols values in row-major order.
+     *
+     *  Quantized encoding only applies to floats with at most 4 columns, and
+     *  delta encoding only to integers.
+     */
+    template<typename T>
+    void add(const std::string& name,
+             const T* values,
+             size_t rows,
+             size_t cols,
+             EmeshEncoding encoding = EmeshEncoding::raw);
+
+    /** Add a block of values with cols values per row.
+     *
+     */
+    template<typename T>
+    void add(const std::string& name,
+             const std::vector<T>& values,
+             size_t cols,
+             EmeshEncoding encoding = EmeshEncoding::raw);
+
+    /** Add a sparse matrix.
+     *
+     *  The matrix is stored in compressed form as the blocks name.outer,
+     *  name.inner and name.values.
+     */
+    template<typename T, int Options, typename StorageIndex>
+    void add(const std::string& name,
+             const Eigen::SparseMatrix<T, Options, StorageIndex>& matrix);
+
+    /** Write all blocks to a file.
+     *
+     */
+    void write(const std::string& filename) const;
+
+private:
+    struct Block
+    {
+        EmeshBlock info;
+        std::array<double, 8> params;
+        std::vector<char> bytes;
+    };
+
+private:
+    std::vector<Block> _blocks;
+};
+
+/** An emesh file mapped into memory.
+ *
+ *  Raw blocks are accessed in place through Eigen maps, which stay valid as
+ *  long as the MappedEmesh is alive. Blocks of any encoding can be decoded
+ *  into vectors of any type.
+ */
+class MappedEmesh
+{
+public:
+    /** Row-major matrix view of a block.*/
+    template<typename T>
+    using MatrixMap = Eigen::Map<const Eigen::Matrix<T,
+                                                     Eigen::Dynamic,
+                                                     Eigen::Dynamic,
+                                                     Eigen::RowMajor>>;
+
+    /** Map an emesh file into memory.
+     *
+     */
+    explicit MappedEmesh(const std::string& filename);
+
+    ~MappedEmesh();
+
+    MappedEmesh(const MappedEmesh&) = delete;
+
+    MappedEmesh& operator=(const MappedEmesh&) = delete;
+
+    MappedEmesh(MappedEmesh&& rhs) noexcept;
+
+    MappedEmesh& operator=(MappedEmesh&& rhs) noexcept;
+
+    /** Return the description of all blocks.
+     *
+     */
+    const std::vector<EmeshBlock>& blocks() const
+    {
+        return _blocks;
+    }
+
+    /** Return the description of a block, or nullptr if there's none.
+     *
+     */
+    const EmeshBlock* find(const std::string& name) const;
+
+    /** Return a block in place.
+     *
+     *  Throw if the block is not raw or its values are not of type T.
+     */
+    template<typename T>
+    MatrixMap<T> matrix(const std::string& name) const;
+
+    /** Return a sparse matrix in place.
+     *
+     *  Throw if the arrays of the matrix are not stored with the same options
+     *  and types.
+     */
+    template<typename T,
+             int Options = Eigen::ColMajor,
+             typename StorageIndex = int>
+    Eigen::Map<const Eigen::SparseMatrix<T, Options, StorageIndex>> sparse(
+        const std::string& name) const;
+
+    /** Decode a block into a vector of values in row-major order.
+     *
+     */
+    template<typename T>
+    void decode(const std::string& name, std::vector<T>& values) const;
+
+private:
+    size_t _index(const std::string& name) const;
+
+private:
+    std::unique_ptr<_impl::MappedFile> _file;
+    std::vector<EmeshBlock> _blocks;
+    std::vector<std::array<double, 8>> _params;
+    std::vector<size_t> _offsets;
+    std::vector<size_t> _sizes;
+};
+
+/** Write emesh file.
+ *
+ *  If compress is true, positions, normals and texcoords are quantized and
+ *  indices are delta coded.
+ *
+ *  @sa EmeshWriter
+ */
+template<int N, typename FT, typename IT>
+void write_emesh(
+    const std::string& filename,
+    const std::vector<FT>& positions,
+    const std::vector<IT>& indices,
+    _impl::NonDeduced_t<const std::vector<FT>*> normals = nullptr,
+    _impl::NonDeduced_t<const std::vector<FT>*> texcoords = nullptr,
+    const std::vector<unsigned char>* colors = nullptr,
+    bool compress = false);
+
+/** Read emesh file.
+ *
+ *  Properties missing from the file are cleared. The optional properties
+ *  don't take part in template argument deduction, so nullptr can be used
+ *  without template parameters.
+ *
+ *  @sa MappedEmesh
+ */
+template<int N, typename FT, typename IT>
+void read_emesh(const std::string& filename,
+                std::vector<FT>& positions,
+                std::vector<IT>& indices,
+                _impl::NonDeduced_t<std::vector<FT>*> normals = nullptr,
+                _impl::NonDeduced_t<std::vector<FT>*> texcoords = nullptr,
+                std::vector<unsigned char>* colors = nullptr);
+
+/** @}*/
+} // namespace Euclid
+
+#include "src/EmeshIO.cpp"
@@ -8,6 +8,7 @@
  */
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 namespace Euclid
@@ -15,8 +16,13 @@ namespace Euclid
 /** @{*/
 
 /** Remove duplicate vertices.
+ *
+ *  Points are sorted in parallel to find duplicates. A point is merged into
+ *  the first point within epsilon of it which is not merged itself, and the
+ *  removed points are filled with points from the back of the vector.
  *
  *  @param positions A vector of point positions.
+ *  @param epsilon Distance tolerance, 0 to merge identical points only.
  *  @return Number of duplicate vertices.
  *
  *  **Note**
@@ -25,17 +31,20 @@ namespace Euclid
  *  use the other overload to fix indices.
  */
 template<typename T>
-size_t remove_duplicate_vertices(std::vector<T>& positions);
+size_t remove_duplicate_vertices(std::vector<T>& positions,
+                                 double epsilon = 0.0);
 
 /** Remove duplicate vertices and fix indices.
  *
  *  @param positions A vector of point positions.
  *  @param indices A vector of point indices.
+ *  @param epsilon Distance tolerance, 0 to merge identical points only.
  *  @return Number of duplicate vertices.
  */
 template<int N, typename T1, typename T2>
 size_t remove_duplicate_vertices(std::vector<T1>& positions,
-                                 std::vector<T2>& indices);
+                                 std::vector<T2>& indices,
+                                 double epsilon = 0.0);
 
 /** Remove duplicate faces of a mesh.
  *
@@ -67,6 +76,45 @@ template<int N, typename T1, typename T2>
 size_t remove_degenerate_faces(const std::vector<T1>& positions,
                                std::vector<T2>& indices);
 
+/** Statistics of fix_mesh.
+ *
+ */
+struct FixMeshStats
+{
+    /** Index of removed vertices in vertex_map.*/
+    static constexpr size_t removed = static_cast<size_t>(-1);
+
+    size_t duplicate_vertices = 0;
+    size_t duplicate_faces = 0;
+    size_t degenerate_faces = 0;
+    size_t unreferenced_vertices = 0;
+    /** Seconds spent on welding vertices.*/
+    double weld_time = 0.0;
+    /** Seconds spent on checking faces.*/
+    double face_time = 0.0;
+    /** Seconds spent on compacting positions and indices.*/
+    double compact_time = 0.0;
+    /** New index of each input vertex, or removed.*/
+    std::vector<size_t> vertex_map;
+};
+
+/** Fix a mesh in one go.
+ *
+ *  The result is the same as removing duplicate vertices, duplicate faces,
+ *  degenerate faces and unreferenced vertices one after another, but the
+ *  checks run in parallel on index arrays, and the positions and indices are
+ *  compacted only once at last.
+ *
+ *  @param positions A vector of point positions.
+ *  @param indices A vector of point indices.
+ *  @param epsilon Distance tolerance for duplicate vertices.
+ *  @return Number of removed elements and time of each stage.
+ */
+template<int N, typename T1, typename T2>
+FixMeshStats fix_mesh(std::vector<T1>& positions,
+                      std::vector<T2>& indices,
+                      double epsilon = 0.0);
+
 /** @}*/
 } // namespace Euclid
 
@@ -43,6 +43,9 @@ void read_obj(const std::string& filename,
  *  the vertex of a cube may have one position but three normals corresponding
  *  to three faces. Thus the output properties may have different sizes, so as
  *  the indices.
+ *
+ *  Faces may use any of the v, v/vt, v//vn and v/vt/vn formats, and negative
+ *  indices relative to the vertices defined so far.
  */
 template<int N, typename FT, typename IT>
 void read_obj(const std::string& filename,
@@ -53,7 +53,9 @@ void read_off(const std::string& filename,
  *  Off file can store positions, indices, vertex colors and face colors. Note
  *  that index count can vary per face, but it's asumed to be fixed for all
  *  faces by this reader. Also note that off file format can store edge indices,
- *  which is often 0, thus omitted by this reader.
+ *  which is often 0, thus omitted by this reader. Values are written in the
+ *  shortest form that reads back exactly, and large meshes are formatted in
+ *  parallel.
  *
  *  @tparam N Number of vertices per face.
  *  @tparam FT Type of floating point value.
@@ -13,6 +13,11 @@
  */
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -24,6 +29,12 @@ namespace Euclid
 // Forward declaration
 class PlyReader;
 class PlyWriter;
+namespace _impl
+{
+struct PlyPropertyPlan;
+struct PlyElementPlan;
+class MappedFile;
+} // namespace _impl
 
 /** @{*/
 
@@ -771,7 +782,8 @@ private:
  *
  *  1. Header is read and parsed into elements and properties in read_ply.
  *  2. read_ply will call PlyReader::on_read.
- *  3. read_ply will then call PlyReader::read to do the actual reading.
+ *  3. read_ply will call PlyReader::read_element for each element, and if it
+ *  is not handled, PlyReader::read for each property of each instance.
  *
  *  **Note**
  *
@@ -795,6 +807,17 @@ public:
      */
     virtual void on_read(const PlyHeader&) {}
 
+    /** Read all instances of an element at once.
+     *
+     *  Override this function to decode a whole element in bulk instead of
+     *  value by value. Return false to fall back to PlyReader::read for each
+     *  property, which is what the default implementation does.
+     */
+    virtual bool read_element(const PlyElement&, std::ifstream&, PlyFormat)
+    {
+        return false;
+    }
+
     /** Read a PlyDoubleProperty.
      *
      */
@@ -882,6 +905,17 @@ public:
         return header;
     };
 
+    /** Write all instances of an element at once.
+     *
+     *  Override this function to encode a whole element in bulk instead of
+     *  value by value. Return false to fall back to PlyWriter::write for each
+     *  property, which is what the default implementation does.
+     */
+    virtual bool write_element(const PlyElement&, std::ofstream&, PlyFormat)
+    {
+        return false;
+    }
+
     /** Write a PlyDoubleProperty.
      *
      */
@@ -949,6 +983,11 @@ protected:
  *  So this class provides a native implementation to read this type of ply
  *  files. Note that it's assumed that all faces have the same number of
  *  vertices.
+ *
+ *  The header is compiled once into a decoding plan for each element, which
+ *  records the type, byte offset and destination of every property. Binary
+ *  elements with fixed size instances are then read in large blocks and
+ *  scattered into the buffers one property at a time.
  */
 template<int VN, typename FloatType, typename IndexType, typename ColorType>
 class CommonPlyReader : public PlyReader
@@ -970,48 +1009,118 @@ public:
 
     void on_read(const PlyHeader& header) override;
 
-    void read(const PlyDoubleProperty* property,
-              std::ifstream& stream,
-              PlyFormat format) override;
+    bool read_element(const PlyElement& element,
+                      std::ifstream& stream,
+                      PlyFormat format) override;
 
-    void read(const PlyFloatProperty* property,
-              std::ifstream& stream,
-              PlyFormat format) override;
+private:
+    template<typename Visitor>
+    bool _visit_target(const _impl::PlyPropertyPlan& property,
+                       size_t first,
+                       Visitor visitor);
 
-    void read(const PlyIntProperty* property,
-              std::ifstream& stream,
-              PlyFormat format) override;
+private:
+    std::vector<FloatType>& _positions;
+    std::vector<FloatType>* _normals = nullptr;
+    std::vector<FloatType>* _texcoords = nullptr;
+    std::vector<IndexType>* _indices = nullptr;
+    std::vector<ColorType>* _colors = nullptr;
+    std::vector<_impl::PlyElementPlan> _plans;
+    size_t _next_plan = 0;
+    int _color_components = 0;
+    std::vector<char> _buffer;
+};
 
-    void read(const PlyUintProperty* property,
-              std::ifstream& stream,
-              PlyFormat format) override;
+/** A ply reader delivering the common properties in chunks.
+ *
+ *  StreamingPlyReader reads the same properties as CommonPlyReader, but only
+ *  holds a fixed number of instances in memory at a time, so meshes larger
+ *  than the available memory can be processed out of core. Vertices and faces
+ *  are decoded into reused buffers and handed to a callback chunk by chunk.
+ *  Returning false from a callback stops reading the rest of the file.
+ *
+ *  Elements without a callback, e.g. the faces when only the vertices are
+ *  needed, and properties not asked for are skipped without being decoded.
+ *
+ *  @sa CommonPlyReader
+ */
+template<int VN, typename FloatType, typename IndexType, typename ColorType>
+class StreamingPlyReader : public PlyReader
+{
+public:
+    /** A chunk of consecutive instances of an element.
+     *
+     *  Buffers of properties not being read are nullptr.
+     */
+    struct Chunk
+    {
+        /** Index of the first instance in the chunk.*/
+        size_t first;
+        /** Number of instances in the chunk.*/
+        size_t count;
+        const std::vector<FloatType>* positions;
+        const std::vector<FloatType>* normals;
+        const std::vector<FloatType>* texcoords;
+        const std::vector<ColorType>* colors;
+        /** Number of components of each color.*/
+        int color_components;
+        const std::vector<IndexType>* indices;
+    };
 
-    void read(const PlyUcharProperty* property,
-              std::ifstream& stream,
-              PlyFormat format) override;
+    /** Callback invoked for each chunk, return false to stop reading.*/
+    using Callback = std::function<bool(const Chunk&)>;
 
-private:
-    template<typename TPlyProperty>
-    void _store_float(const TPlyProperty* property,
-                      std::ifstream& stream,
-                      PlyFormat format);
+    /** Constructor.
+     *
+     *  @param on_vertices Callback for chunks of vertices, or nullptr to skip
+     *  the vertices.
+     *  @param on_faces Callback for chunks of faces, or nullptr to skip the
+     *  faces.
+     *  @param chunk_size Maximum number of instances in a chunk.
+     *  @param normals Whether to read vertex normals.
+     *  @param texcoords Whether to read vertex texture coordinates.
+     *  @param colors Whether to read vertex colors.
+     */
+    StreamingPlyReader(Callback on_vertices,
+                       Callback on_faces = nullptr,
+                       size_t chunk_size = 65536,
+                       bool normals = false,
+                       bool texcoords = false,
+                       bool colors = false);
 
-    template<typename TPlyProperty>
-    void _store_color(const TPlyProperty* property,
+    void on_read(const PlyHeader& header) override;
+
+    bool read_element(const PlyElement& element,
                       std::ifstream& stream,
-                      PlyFormat format);
+                      PlyFormat format) override;
 
-    template<typename TPlyProperty>
-    void _store_indices(const TPlyProperty* property,
-                        std::ifstream& stream,
-                        PlyFormat format);
+    /** Whether a callback has stopped the reading.*/
+    bool stopped() const
+    {
+        return _stopped;
+    }
 
 private:
-    std::vector<FloatType>& _positions;
-    std::vector<FloatType>* _normals = nullptr;
-    std::vector<FloatType>* _texcoords = nullptr;
-    std::vector<IndexType>* _indices = nullptr;
-    std::vector<ColorType>* _colors = nullptr;
+    template<typename Visitor>
+    bool _visit_target(const _impl::PlyPropertyPlan& property,
+                       size_t first,
+                       Visitor visitor);
+
+private:
+    Callback _on_vertices;
+    Callback _on_faces;
+    size_t _chunk_size;
+    unsigned _vertex_targets;
+    std::vector<_impl::PlyElementPlan> _plans;
+    size_t _next_plan = 0;
+    bool _stopped = false;
+    int _color_components = 0;
+    std::vector<FloatType> _positions;
+    std::vector<FloatType> _normals;
+    std::vector<FloatType> _texcoords;
+    std::vector<ColorType> _colors;
+    std::vector<IndexType> _indices;
+    std::vector<char> _buffer;
 };
 
 /** A ply writer for a common set of properties.
@@ -1037,6 +1146,10 @@ private:
  *  So this class provides a native implementation to write this type of ply
  *  files. Note that it's assumed that all faces have the same number of
  *  vertices.
+ *
+ *  Like CommonPlyReader, each element is encoded following a compiled plan.
+ *  Binary rows are packed into a buffer in large blocks, and ascii lines are
+ *  formatted in parallel.
  */
 template<int VN, typename FloatType, typename IndexType, typename ColorType>
 class CommonPlyWriter : public PlyWriter
@@ -1086,6 +1199,10 @@ public:
 
     PlyHeader generate_header(PlyFormat format) const override;
 
+    bool write_element(const PlyElement& element,
+                       std::ofstream& stream,
+                       PlyFormat format) override;
+
     void write(const PlyDoubleProperty* property,
                std::ofstream& stream,
                PlyFormat format) override;
@@ -1122,6 +1239,11 @@ private:
                         std::ofstream& stream,
                         PlyFormat format);
 
+    template<typename Visitor>
+    bool _visit_source(const _impl::PlyPropertyPlan& property,
+                       size_t first,
+                       Visitor visitor) const;
+
 private:
     const std::vector<FloatType>& _positions;
     const std::vector<FloatType>* _normals = nullptr;
@@ -1134,6 +1256,158 @@ private:
     size_t _niter = 0;
     size_t _titer = 0;
     size_t _citer = 0;
+    std::vector<char> _buffer;
+};
+
+/** A read-only view of a property group in a memory mapped ply file.
+ *
+ *  Each instance of an element holds N values of type T, e.g. the x, y and z
+ *  coordinates of a vertex, which are consecutive in the file but instances
+ *  could be interleaved with other properties.
+ *
+ *  @sa MappedPly
+ */
+template<typename T, int N>
+class PlyView
+{
+public:
+    PlyView() = default;
+
+    PlyView(const char* data, size_t size, size_t stride)
+        : _data(data), _size(size), _stride(stride)
+    {}
+
+    /** Return the number of instances.
+     *
+     */
+    size_t size() const
+    {
+        return _size;
+    }
+
+    /** Return true if the view is empty.
+     *
+     *  A view is also empty if the layout of the file doesn't match.
+     */
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    /** Return the distance between two instances in bytes.
+     *
+     */
+    size_t stride() const
+    {
+        return _stride;
+    }
+
+    /** Return the j-th value of the i-th instance.
+     *
+     */
+    T operator()(size_t i, int j) const
+    {
+        T value;
+        std::memcpy(&value, _data + i * _stride + j * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    /** Return the values as an array of T.
+     *
+     *  If the values are not aligned for T or the stride is not a multiple of
+     *  sizeof(T), return nullptr. Otherwise the values could be wrapped by an
+     *  Eigen::Map with an outer stride of stride() / sizeof(T).
+     */
+    const T* data() const
+    {
+        auto address = reinterpret_cast<std::uintptr_t>(_data);
+        if (_data == nullptr || address % alignof(T) != 0 ||
+            _stride % sizeof(T) != 0) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T*>(_data);
+    }
+
+private:
+    const char* _data = nullptr;
+    size_t _size = 0;
+    size_t _stride = 0;
+};
+
+/** A ply file mapped into memory.
+ *
+ *  Instead of decoding the file into buffers, a binary little endian ply file
+ *  could be mapped into memory and its properties accessed in place, so
+ *  opening a huge file costs almost nothing and the pages are shared among
+ *  processes mapping the same file. The views returned are only valid during
+ *  the lifetime of the MappedPly. If the file is not binary little endian, or
+ *  the layout or types of the requested properties don't match, empty views
+ *  are returned and read_ply should be used instead.
+ */
+class MappedPly
+{
+public:
+    /** Map a ply file into memory.
+     *
+     */
+    explicit MappedPly(const std::string& filename);
+
+    ~MappedPly();
+
+    MappedPly(const MappedPly&) = delete;
+
+    MappedPly& operator=(const MappedPly&) = delete;
+
+    MappedPly(MappedPly&& rhs) noexcept;
+
+    MappedPly& operator=(MappedPly&& rhs) noexcept;
+
+    /** Return the header of the file.
+     *
+     */
+    const PlyHeader& header() const
+    {
+        return _header;
+    }
+
+    /** Return the view of vertex positions.
+     *
+     */
+    template<typename FloatType>
+    PlyView<FloatType, 3> positions() const;
+
+    /** Return the view of vertex normals.
+     *
+     */
+    template<typename FloatType>
+    PlyView<FloatType, 3> normals() const;
+
+    /** Return the view of face indices.
+     *
+     *  Only the vertex counts of the first and last faces are checked to be
+     *  VN, since checking all of them would read through the whole element.
+     */
+    template<int VN, typename IndexType>
+    PlyView<IndexType, VN> indices() const;
+
+private:
+    const PlyElement* _locate(const std::string& name,
+                              int vn,
+                              size_t& offset,
+                              size_t& stride) const;
+
+    template<typename T, int N>
+    PlyView<T, N> _view(const std::string& element,
+                        const std::array<const char*, N>& names) const;
+
+    void _check_bounds(size_t end) const;
+
+private:
+    std::unique_ptr<_impl::MappedFile> _file;
+    const char* _data = nullptr;
+    size_t _size = 0;
+    size_t _body = 0;
+    PlyHeader _header;
 };
 
 /** Read ply header.
@@ -0,0 +1,568 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "IOHelpers.h"
+
+namespace Euclid
+{
+
+namespace _impl
+{
+
+constexpr const char emesh_magic[8] = { 'E', 'M', 'E', 'S', 'H', 0, 0, 0 };
+constexpr const uint32_t emesh_version = 1;
+constexpr const uint32_t emesh_byte_order = 0x01020304;
+constexpr const size_t emesh_alignment = 64;
+constexpr const size_t emesh_name_size = 64;
+
+/** The header at the start of an emesh file.*/
+struct EmeshFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t n_blocks;
+    char reserved[40];
+};
+
+/** An entry of the block directory following the header.*/
+struct EmeshFileBlock
+{
+    char name[emesh_name_size];
+    uint32_t type;
+    uint32_t encoding;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t offset;
+    uint64_t size;
+    double params[8];
+};
+
+/** Return the emesh type of T.*/
+template<typename T>
+constexpr EmeshType emesh_type()
+{
+    static_assert(std::is_arithmetic_v<T>, "Emesh only stores numbers.");
+    if constexpr (std::is_floating_point_v<T>) {
+        static_assert(sizeof(T) == 4 || sizeof(T) == 8);
+        return sizeof(T) == 4 ? EmeshType::float32 : EmeshType::float64;
+    }
+    else if constexpr (sizeof(T) == 1) {
+        return std::is_signed_v<T> ? EmeshType::int8 : EmeshType::uint8;
+    }
+    else if constexpr (sizeof(T) == 2) {
+        return std::is_signed_v<T> ? EmeshType::int16 : EmeshType::uint16;
+    }
+    else if constexpr (sizeof(T) == 4) {
+        return std::is_signed_v<T> ? EmeshType::int32 : EmeshType::uint32;
+    }
+    else {
+        return std::is_signed_v<T> ? EmeshType::int64 : EmeshType::uint64;
+    }
+}
+
+/** Return the size of an emesh type in bytes.*/
+inline size_t emesh_type_size(EmeshType type)
+{
+    switch (type) {
+    case EmeshType::int8:
+    case EmeshType::uint8: return 1;
+    case EmeshType::int16:
+    case EmeshType::uint16: return 2;
+    case EmeshType::int32:
+    case EmeshType::uint32:
+    case EmeshType::float32: return 4;
+    default: return 8;
+    }
+}
+
+inline size_t emesh_align(size_t offset)
+{
+    return (offset + emesh_alignment - 1) / emesh_alignment * emesh_alignment;
+}
+
+/** Convert n values of type Src in place into an array.*/
+template<typename Src, typename T>
+void emesh_convert(const char* src, size_t n, T* dst)
+{
+    if constexpr (std::is_same_v<Src, T>) {
+        std::memcpy(dst, src, n * sizeof(T));
+    }
+    else {
+        auto values = reinterpret_cast<const Src*>(src);
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = static_cast<T>(values[i]);
+        }
+    }
+}
+
+/** Convert n values of an emesh type in place into an array.*/
+template<typename T>
+void emesh_convert(EmeshType type, const char* src, size_t n, T* dst)
+{
+    switch (type) {
+    case EmeshType::int8: emesh_convert<int8_t>(src, n, dst); break;
+    case EmeshType::uint8: emesh_convert<uint8_t>(src, n, dst); break;
+    case EmeshType::int16: emesh_convert<int16_t>(src, n, dst); break;
+    case EmeshType::uint16: emesh_convert<uint16_t>(src, n, dst); break;
+    case EmeshType::int32: emesh_convert<int32_t>(src, n, dst); break;
+    case EmeshType::uint32: emesh_convert<uint32_t>(src, n, dst); break;
+    case EmeshType::int64: emesh_convert<int64_t>(src, n, dst); break;
+    case EmeshType::uint64: emesh_convert<uint64_t>(src, n, dst); break;
+    case EmeshType::float32: emesh_convert<float>(src, n, dst); break;
+    case EmeshType::float64: emesh_convert<double>(src, n, dst); break;
+    }
+}
+
+inline void emesh_put_varint(uint64_t value, std::vector<char>& bytes)
+{
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<char>(value));
+}
+
+inline const char* emesh_get_varint(const char* p,
+                                    const char* end,
+                                    uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        auto byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return p;
+        }
+    }
+    throw std::runtime_error("Bad emesh file");
+}
+
+} // namespace _impl
+
+//-------------------EmeshWriter------------------------
+
+template<typename T>
+void EmeshWriter::add(const std::string& name,
+                      const T* values,
+                      size_t rows,
+                      size_t cols,
+                      EmeshEncoding encoding)
+{
+    if (name.empty() || name.size() >= _impl::emesh_name_size) {
+        throw std::invalid_argument("Invalid name of emesh block: " + name);
+    }
+    for (const auto& block : _blocks) {
+        if (block.info.name == name) {
+            throw std::invalid_argument("Duplicate emesh block: " + name);
+        }
+    }
+
+    Block block;
+    block.info = { name, _impl::emesh_type<T>(), encoding, rows, cols };
+    block.params.fill(0.0);
+    const auto n = rows * cols;
+    if (encoding == EmeshEncoding::raw) {
+        block.bytes.resize(n * sizeof(T));
+        if (n != 0) {
+            std::memcpy(block.bytes.data(), values, n * sizeof(T));
+        }
+    }
+    else if (encoding == EmeshEncoding::quantized) {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (cols == 0 || cols > 4) {
+                throw std::invalid_argument(
+                    "Only blocks of 1 to 4 columns can be quantized.");
+            }
+
+            // the range of each column is mapped onto 16 bits
+            for (size_t c = 0; c < cols; ++c) {
+                auto lo = std::numeric_limits<double>::max();
+                auto hi = std::numeric_limits<double>::lowest();
+                for (size_t i = c; i < n; i += cols) {
+                    lo = std::min(lo, static_cast<double>(values[i]));
+                    hi = std::max(hi, static_cast<double>(values[i]));
+                }
+                block.params[c] = rows == 0 ? 0.0 : lo;
+                block.params[4 + c] = rows == 0 ? 0.0 : (hi - lo) / 65535.0;
+            }
+            std::vector<uint16_t> quantized(n);
+            for (size_t i = 0; i < n; ++i) {
+                const auto c = i % cols;
+                const auto scale = block.params[4 + c];
+                quantized[i] =
+                    scale == 0.0
+                        ? 0
+                        : static_cast<uint16_t>(std::lround(
+                              (values[i] - block.params[c]) / scale));
+            }
+            block.bytes.resize(n * sizeof(uint16_t));
+            if (n != 0) {
+                std::memcpy(block.bytes.data(),
+                            quantized.data(),
+                            block.bytes.size());
+            }
+        }
+        else {
+            throw std::invalid_argument("Only floats can be quantized.");
+        }
+    }
+    else {
+        if constexpr (std::is_integral_v<T>) {
+            // zigzag coded differences are small for coherent indices
+            int64_t last = 0;
+            for (size_t i = 0; i < n; ++i) {
+                auto value = static_cast<int64_t>(values[i]);
+                auto delta = value - last;
+                last = value;
+                _impl::emesh_put_varint(
+                    (static_cast<uint64_t>(delta) << 1) ^
+                        static_cast<uint64_t>(delta >> 63),
+                    block.bytes);
+            }
+        }
+        else {
+            throw std::invalid_argument("Only integers can be delta coded.");
+        }
+    }
+    _blocks.push_back(std::move(block));
+}
+
+template<typename T>
+void EmeshWriter::add(const std::string& name,
+                      const std::vector<T>& values,
+                      size_t cols,
+                      EmeshEncoding encoding)
+{
+    if (cols == 0 || values.size() % cols != 0) {
+        throw std::invalid_argument(
+            "Size of values not compatible with columns");
+    }
+    add(name, values.data(), values.size() / cols, cols, encoding);
+}
+
+template<typename T, int Options, typename StorageIndex>
+void EmeshWriter::add(
+    const std::string& name,
+    const Eigen::SparseMatrix<T, Options, StorageIndex>& matrix)
+{
+    Eigen::SparseMatrix<T, Options, StorageIndex> compressed = matrix;
+    compressed.makeCompressed();
+    const auto outer = static_cast<size_t>(compressed.outerSize());
+    const auto nnz = static_cast<size_t>(compressed.nonZeros());
+    add(name + ".outer", compressed.outerIndexPtr(), outer + 1, 1);
+    add(name + ".inner", compressed.innerIndexPtr(), nnz, 1);
+    add(name + ".values", compressed.valuePtr(), nnz, 1);
+
+    auto& params = _blocks.back().params;
+    params[0] = static_cast<double>(compressed.rows());
+    params[1] = static_cast<double>(compressed.cols());
+    params[2] = (Options & Eigen::RowMajor) ? 1.0 : 0.0;
+}
+
+inline void EmeshWriter::write(const std::string& filename) const
+{
+    std::ofstream stream(filename, std::ios::binary);
+    _impl::check_fstream(stream, filename);
+
+    _impl::EmeshFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, _impl::emesh_magic, sizeof(header.magic));
+    header.version = _impl::emesh_version;
+    header.byte_order = _impl::emesh_byte_order;
+    header.n_blocks = _blocks.size();
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    auto offset = _impl::emesh_align(
+        sizeof(header) + _blocks.size() * sizeof(_impl::EmeshFileBlock));
+    for (const auto& block : _blocks) {
+        _impl::EmeshFileBlock entry;
+        std::memset(&entry, 0, sizeof(entry));
+        std::memcpy(entry.name, block.info.name.data(), block.info.name.size());
+        entry.type = static_cast<uint32_t>(block.info.type);
+        entry.encoding = static_cast<uint32_t>(block.info.encoding);
+        entry.rows = block.info.rows;
+        entry.cols = block.info.cols;
+        entry.offset = offset;
+        entry.size = block.bytes.size();
+        std::copy(block.params.begin(), block.params.end(), entry.params);
+        stream.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        offset = _impl::emesh_align(offset + block.bytes.size());
+    }
+
+    const char padding[_impl::emesh_alignment] = {};
+    for (const auto& block : _blocks) {
+        auto pos = static_cast<size_t>(stream.tellp());
+        stream.write(padding, _impl::emesh_align(pos) - pos);
+        stream.write(block.bytes.data(), block.bytes.size());
+    }
+    if (!stream) {
+        std::string err("Failed to write file ");
+        err.append(filename);
+        throw std::runtime_error(err);
+    }
+}
+
+//-------------------MappedEmesh------------------------
+
+inline MappedEmesh::MappedEmesh(const std::string& filename)
+    : _file(std::make_unique<_impl::MappedFile>(filename))
+{
+    const auto data = _file->data();
+    const auto size = _file->size();
+
+    _impl::EmeshFileHeader header;
+    if (size < sizeof(header)) {
+        throw std::runtime_error("Bad emesh file");
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, _impl::emesh_magic, sizeof(header.magic)) !=
+            0 ||
+        header.version != _impl::emesh_version) {
+        throw std::runtime_error("Bad emesh file");
+    }
+    if (header.byte_order != _impl::emesh_byte_order) {
+        throw std::runtime_error("Emesh file has a different byte order");
+    }
+    const auto n = static_cast<size_t>(header.n_blocks);
+    if ((size - sizeof(header)) / sizeof(_impl::EmeshFileBlock) < n) {
+        throw std::runtime_error("Bad emesh file");
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        _impl::EmeshFileBlock entry;
+        std::memcpy(&entry,
+                    data + sizeof(header) + i * sizeof(entry),
+                    sizeof(entry));
+        entry.name[_impl::emesh_name_size - 1] = '\0';
+        if (entry.type > static_cast<uint32_t>(EmeshType::float64) ||
+            entry.encoding > static_cast<uint32_t>(EmeshEncoding::delta) ||
+            entry.offset > size || entry.size > size - entry.offset) {
+            throw std::runtime_error("Bad emesh file");
+        }
+
+        EmeshBlock block{ entry.name,
+                          static_cast<EmeshType>(entry.type),
+                          static_cast<EmeshEncoding>(entry.encoding),
+                          static_cast<size_t>(entry.rows),
+                          static_cast<size_t>(entry.cols) };
+        size_t expected = entry.size;
+        if (block.encoding == EmeshEncoding::raw) {
+            expected = block.rows * block.cols *
+                       _impl::emesh_type_size(block.type);
+        }
+        else if (block.encoding == EmeshEncoding::quantized) {
+            expected = block.rows * block.cols * sizeof(uint16_t);
+        }
+        if (expected != entry.size) {
+            throw std::runtime_error("Bad emesh file");
+        }
+
+        std::array<double, 8> params;
+        std::copy(entry.params, entry.params + 8, params.begin());
+        _blocks.push_back(std::move(block));
+        _params.push_back(params);
+        _offsets.push_back(static_cast<size_t>(entry.offset));
+        _sizes.push_back(static_cast<size_t>(entry.size));
+    }
+}
+
+inline MappedEmesh::~MappedEmesh() = default;
+
+inline MappedEmesh::MappedEmesh(MappedEmesh&& rhs) noexcept = default;
+
+inline MappedEmesh& MappedEmesh::operator=(MappedEmesh&& rhs) noexcept =
+    default;
+
+inline const EmeshBlock* MappedEmesh::find(const std::string& name) const
+{
+    for (const auto& block : _blocks) {
+        if (block.name == name) {
+            return &block;
+        }
+    }
+    return nullptr;
+}
+
+template<typename T>
+MappedEmesh::MatrixMap<T> MappedEmesh::matrix(const std::string& name) const
+{
+    const auto i = _index(name);
+    const auto& block = _blocks[i];
+    if (block.encoding != EmeshEncoding::raw) {
+        throw std::runtime_error("Emesh block is encoded: " + name);
+    }
+    if (block.type != _impl::emesh_type<T>()) {
+        throw std::runtime_error("Wrong type of emesh block: " + name);
+    }
+    return MatrixMap<T>(
+        reinterpret_cast<const T*>(_file->data() + _offsets[i]),
+        static_cast<Eigen::Index>(block.rows),
+        static_cast<Eigen::Index>(block.cols));
+}
+
+template<typename T, int Options, typename StorageIndex>
+Eigen::Map<const Eigen::SparseMatrix<T, Options, StorageIndex>> MappedEmesh::
+    sparse(const std::string& name) const
+{
+    auto outer = matrix<StorageIndex>(name + ".outer");
+    auto inner = matrix<StorageIndex>(name + ".inner");
+    auto values = matrix<T>(name + ".values");
+    const auto& params = _params[_index(name + ".values")];
+    const bool row_major = (Options & Eigen::RowMajor) != 0;
+    if ((params[2] != 0.0) != row_major) {
+        throw std::runtime_error("Wrong storage order of emesh matrix: " +
+                                 name);
+    }
+    return Eigen::Map<const Eigen::SparseMatrix<T, Options, StorageIndex>>(
+        static_cast<Eigen::Index>(params[0]),
+        static_cast<Eigen::Index>(params[1]),
+        values.size(),
+        outer.data(),
+        inner.data(),
+        values.data());
+}
+
+template<typename T>
+void MappedEmesh::decode(const std::string& name, std::vector<T>& values) const
+{
+    const auto i = _index(name);
+    const auto& block = _blocks[i];
+    const auto& params = _params[i];
+    const auto src = _file->data() + _offsets[i];
+    const auto n = block.rows * block.cols;
+    values.resize(n);
+
+    if (block.encoding == EmeshEncoding::raw) {
+        _impl::emesh_convert(block.type, src, n, values.data());
+    }
+    else if (block.encoding == EmeshEncoding::quantized) {
+        auto quantized = reinterpret_cast<const uint16_t*>(src);
+        for (size_t j = 0; j < n; ++j) {
+            const auto c = j % block.cols;
+            values[j] =
+                static_cast<T>(params[c] + quantized[j] * params[4 + c]);
+        }
+    }
+    else {
+        const auto end = src + _sizes[i];
+        auto p = src;
+        int64_t last = 0;
+        for (size_t j = 0; j < n; ++j) {
+            uint64_t zigzag;
+            p = _impl::emesh_get_varint(p, end, zigzag);
+            auto delta = static_cast<int64_t>(zigzag >> 1) ^
+                         -static_cast<int64_t>(zigzag & 1);
+            last += delta;
+            values[j] = static_cast<T>(last);
+        }
+    }
+}
+
+inline size_t MappedEmesh::_index(const std::string& name) const
+{
+    for (size_t i = 0; i < _blocks.size(); ++i) {
+        if (_blocks[i].name == name) {
+            return i;
+        }
+    }
+    throw std::runtime_error("No emesh block named " + name);
+}
+
+//----------------Free Functions-------------------
+
+template<int N, typename FT, typename IT>
+void write_emesh(const std::string& filename,
+                 const std::vector<FT>& positions,
+                 const std::vector<IT>& indices,
+                 _impl::NonDeduced_t<const std::vector<FT>*> normals,
+                 _impl::NonDeduced_t<const std::vector<FT>*> texcoords,
+                 const std::vector<unsigned char>* colors,
+                 bool compress)
+{
+    const auto n = positions.size() / 3;
+    if (positions.size() % 3 != 0) {
+        throw std::invalid_argument("Size of positions is not divisible by 3");
+    }
+    if (indices.size() % N != 0) {
+        throw std::invalid_argument("Size of indices not compatible with N");
+    }
+    if (normals != nullptr && normals->size() != n * 3) {
+        throw std::invalid_argument(
+            "Size of normals not compatible with positions");
+    }
+    if (texcoords != nullptr && texcoords->size() != n * 2) {
+        throw std::invalid_argument(
+            "Size of texcoords not compatible with positions");
+    }
+    if (colors != nullptr && colors->size() != n * 3 &&
+        colors->size() != n * 4) {
+        throw std::invalid_argument(
+            "Size of colors not compatible with positions");
+    }
+
+    const auto fenc = compress ? EmeshEncoding::quantized : EmeshEncoding::raw;
+    const auto ienc = compress ? EmeshEncoding::delta : EmeshEncoding::raw;
+    EmeshWriter writer;
+    writer.add("positions", positions.data(), n, 3, fenc);
+    writer.add("indices", indices.data(), indices.size() / N, N, ienc);
+    if (normals != nullptr) {
+        writer.add("normals", normals->data(), n, 3, fenc);
+    }
+    if (texcoords != nullptr) {
+        writer.add("texcoords", texcoords->data(), n, 2, fenc);
+    }
+    if (colors != nullptr) {
+        auto cols = n == 0 ? 4 : colors->size() / n;
+        writer.add("colors", colors->data(), n, cols);
+    }
+    writer.write(filename);
+}
+
+template<int N, typename FT, typename IT>
+void read_emesh(const std::string& filename,
+                std::vector<FT>& positions,
+                std::vector<IT>& indices,
+                _impl::NonDeduced_t<std::vector<FT>*> normals,
+                _impl::NonDeduced_t<std::vector<FT>*> texcoords,
+                std::vector<unsigned char>* colors)
+{
+    MappedEmesh emesh(filename);
+    emesh.decode("positions", positions);
+    auto block = emesh.find("indices");
+    if (block == nullptr) {
+        indices.clear();
+    }
+    else if (block->cols != N) {
+        std::string err_str("Number of vertices per face should be ");
+        err_str.append(std::to_string(N));
+        err_str.append(", rather than ");
+        err_str.append(std::to_string(block->cols));
+        throw std::runtime_error(err_str);
+    }
+    else {
+        emesh.decode("indices", indices);
+    }
+
+    auto decode = [&emesh](const char* name, auto* values) {
+        if (values == nullptr) {
+            return;
+        }
+        if (emesh.find(name) != nullptr) {
+            emesh.decode(name, *values);
+        }
+        else {
+            values->clear();
+        }
+    };
+    decode("normals", normals);
+    decode("texcoords", texcoords);
+    decode("colors", colors);
+}
+
+} // namespace Euclid
@@ -1,11 +1,25 @@
 #pragma once
 
+#include <algorithm>
+#include <charconv>
 #include <fstream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace Euclid
 {
 
@@ -55,6 +69,174 @@ split(std::string_view str, char delim, std::string_view::size_type start = 0)
     return substrs;
 }
 
+/** Parse a number in [first, last) with std::from_chars.
+ *
+ *  A leading plus sign is accepted, return nullptr if there's no number.
+ */
+template<typename T>
+const char* parse_number(const char* first, const char* last, T& value)
+{
+    if (first != last && *first == '+') {
+        ++first;
+    }
+    auto [ptr, ec] = std::from_chars(first, last, value);
+    return ec == std::errc() ? ptr : nullptr;
+}
+
+/** Append the shortest representation of a number with std::to_chars.*/
+template<typename T>
+void append_number(std::string& str, T value)
+{
+    char buffer[64];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    str.append(buffer, result.ptr);
+}
+
+/** Write n lines of text formatted in parallel.
+ *
+ *  format(i, str) appends the i-th line to str. Lines are formatted in blocks
+ *  by all threads and written in order, so only a bounded number of blocks is
+ *  held in memory at a time.
+ */
+template<typename Format>
+void write_lines(std::ofstream& stream, size_t n, Format format)
+{
+    constexpr const size_t block_size = 1 << 14;
+    constexpr const int batch = 32;
+
+    std::vector<std::string> blocks(batch);
+    for (size_t first = 0; first < n; first += batch * block_size) {
+        const auto n_blocks = static_cast<int>(std::min<size_t>(
+            batch, (n - first + block_size - 1) / block_size));
+#pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < n_blocks; ++b) {
+            auto& block = blocks[b];
+            block.clear();
+            auto beg = first + b * block_size;
+            auto end = std::min(beg + block_size, n);
+            for (auto i = beg; i < end; ++i) {
+                format(i, block);
+            }
+        }
+        for (int b = 0; b < n_blocks; ++b) {
+            stream.write(blocks[b].data(), blocks[b].size());
+        }
+    }
+}
+
+/** A read-only file mapped into memory.*/
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& filename)
+    {
+        std::string err_str("Can't open file ");
+        err_str.append(filename);
+#ifdef _WIN32
+        _file = CreateFileA(filename.c_str(),
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+        if (_file == INVALID_HANDLE_VALUE) {
+            _file = nullptr;
+            throw std::runtime_error(err_str);
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(_file, &size)) {
+            _unmap();
+            throw std::runtime_error(err_str);
+        }
+        _size = static_cast<size_t>(size.QuadPart);
+        if (_size != 0) {
+            _mapping = CreateFileMappingA(
+                _file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (_mapping != nullptr) {
+                _data = static_cast<const char*>(
+                    MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+            }
+            if (_data == nullptr) {
+                _unmap();
+                throw std::runtime_error(err_str);
+            }
+        }
+#else
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error(err_str);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error(err_str);
+        }
+        _size = static_cast<size_t>(st.st_size);
+        if (_size != 0) {
+            auto data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error(err_str);
+            }
+            _data = static_cast<const char*>(data);
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile()
+    {
+        _unmap();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const
+    {
+        return _data;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+private:
+    void _unmap()
+    {
+#ifdef _WIN32
+        if (_data != nullptr) {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping != nullptr) {
+            CloseHandle(_mapping);
+        }
+        if (_file != nullptr) {
+            CloseHandle(_file);
+        }
+        _file = nullptr;
+        _mapping = nullptr;
+#else
+        if (_data != nullptr) {
+            munmap(const_cast<char*>(_data), _size);
+        }
+#endif
+        _data = nullptr;
+        _size = 0;
+    }
+
+private:
+    const char* _data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    HANDLE _file = nullptr;
+    HANDLE _mapping = nullptr;
+#endif
+};
+
 } // namespace _impl
 
 } // namespace Euclid
@@ -1,18 +1,22 @@
 #include <algorithm>
 #include <array>
-#include <map>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <numeric>
 #include <stdexcept>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <boost/functional/hash.hpp>
 #include <CGAL/Simple_cartesian.h>
 #include <CGAL/Kernel/global_functions.h>
 #include <Euclid/Util/Assert.h>
+#include <Euclid/Util/Timer.h>
 
 namespace Euclid
 {
@@ -35,50 +39,324 @@ std::array<T, N> to_canonical(const std::array<T, N>& face)
     return canonical;
 }
 
-} // namespace _impl
+/** Sort in parallel.
+ *
+ *  Chunks are sorted independently and then merged pairwise.
+ */
+template<typename Iter, typename Compare>
+void parallel_sort(Iter first, Iter last, Compare comp)
+{
+    constexpr const std::ptrdiff_t grain = 1 << 16;
+
+    const auto n = last - first;
+    const auto chunks = static_cast<int>((n + grain - 1) / grain);
+    if (chunks <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < chunks; ++i) {
+        auto begin = i * grain;
+        auto end = std::min(n, begin + grain);
+        std::sort(first + begin, first + end, comp);
+    }
+    for (auto width = grain; width < n; width *= 2) {
+        const auto merges = static_cast<int>((n + 2 * width - 1) / (2 * width));
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < merges; ++i) {
+            auto begin = i * 2 * width;
+            auto middle = std::min(n, begin + width);
+            auto end = std::min(n, begin + 2 * width);
+            std::inplace_merge(
+                first + begin, first + middle, first + end, comp);
+        }
+    }
+}
 
+/** Order pairs of a key array and an index.
+ *
+ *  Same as std::less, but comparing each key only once.
+ */
+struct KeyLess
+{
+    template<typename Key>
+    bool operator()(const std::pair<Key, size_t>& lhs,
+                    const std::pair<Key, size_t>& rhs) const
+    {
+        for (size_t i = 0; i < lhs.first.size(); ++i) {
+            if (lhs.first[i] != rhs.first[i]) {
+                return lhs.first[i] < rhs.first[i];
+            }
+        }
+        return lhs.second < rhs.second;
+    }
+};
+
+/** Map each point to the first point identical to it.
+ *
+ *  Points with NaN coordinates are not identical to any point.
+ */
 template<typename T>
-size_t remove_duplicate_vertices(std::vector<T>& positions)
+std::vector<size_t> identical_points(const std::vector<T>& positions)
 {
-    if (positions.empty()) {
-        EWARNING("positions is empty.");
-        return 0;
+    using Point = std::array<T, 3>;
+
+    const auto n = static_cast<int>(positions.size() / 3);
+    std::vector<size_t> reps(n);
+    std::iota(reps.begin(), reps.end(), 0);
+
+    // sort by position then index, so that equal points are consecutive
+    // with the first one in front
+    std::vector<std::pair<Point, size_t>> points;
+    points.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        Point p{ { positions[3 * i],
+                   positions[3 * i + 1],
+                   positions[3 * i + 2] } };
+        if (p == p) { // NaN is not equal to anything
+            points.emplace_back(p, i);
+        }
     }
-    if (positions.size() % 3 != 0) {
-        throw std::runtime_error("Input position size is not divisible by 3");
+    parallel_sort(points.begin(), points.end(), KeyLess());
+
+    const auto m = static_cast<int>(points.size());
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i = 0; i < m; ++i) {
+        if (i > 0 && points[i].first == points[i - 1].first) {
+            continue;
+        }
+        for (auto j = i + 1; j < m && points[j].first == points[i].first;
+             ++j) {
+            reps[points[j].second] = points[i].second;
+        }
     }
-    using Point = std::array<T, 3>;
+    return reps;
+}
 
-    // Find duplicate points
-    std::vector<size_t> marks;
-    std::unordered_set<Point, boost::hash<Point>> unique_points;
-    for (size_t i = 0; i < positions.size(); i += 3) {
-        Point p{ { positions[i], positions[i + 1], positions[i + 2] } };
-        auto [dummy, is_unique] = unique_points.insert(std::move(p));
-        if (!is_unique) {
-            marks.push_back(i);
+/** Find the representative of each point.
+ *
+ *  A point is merged into the first representative within epsilon of it,
+ *  or becomes a representative itself if there's none. Points with NaN
+ *  coordinates are never merged, and points with infinite coordinates are
+ *  only merged with identical points.
+ */
+template<typename T>
+std::vector<size_t> weld_points(const std::vector<T>& positions,
+                                double epsilon)
+{
+    using Cell = std::array<int64_t, 3>;
+
+    // identical points share the representative of the first one, so only
+    // the first ones are searched
+    auto reps = identical_points(positions);
+    if (epsilon == 0.0) {
+        return reps;
+    }
+
+    // cells wider than epsilon still hold all the neighbours, so the grid is
+    // coarsened where the cell indices and their neighbours would overflow
+    auto extent = 1.0;
+    for (auto x : positions) {
+        auto a = std::abs(static_cast<double>(x));
+        if (std::isfinite(a)) {
+            extent = std::max(extent, a);
+        }
+    }
+    const auto n = static_cast<int>(positions.size() / 3);
+    const auto inv = std::min(1.0 / epsilon, std::ldexp(1.0, 62) / extent);
+    const auto eps2 = epsilon * epsilon;
+    std::vector<Cell> cells(n);
+    std::vector<char> finite(n, 1);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            auto x = static_cast<double>(positions[3 * i + k]);
+            if (!std::isfinite(x)) {
+                finite[i] = 0;
+                break;
+            }
+            cells[i][k] = static_cast<int64_t>(std::floor(x * inv));
+        }
+    }
+
+    // group the first points by grid cell, neighbours within epsilon are in
+    // the adjacent cells
+    std::vector<std::pair<Cell, size_t>> points;
+    for (int i = 0; i < n; ++i) {
+        if (finite[i] && reps[i] == static_cast<size_t>(i)) {
+            points.emplace_back(cells[i], i);
+        }
+    }
+    parallel_sort(points.begin(), points.end(), KeyLess());
+    std::vector<Cell> keys;
+    std::vector<size_t> begins;
+    std::vector<size_t> groups(n);
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (keys.empty() || keys.back() != points[i].first) {
+            keys.push_back(points[i].first);
+            begins.push_back(i);
+        }
+        groups[points[i].second] = keys.size() - 1;
+    }
+
+    // representatives of a cell are stored in the slots of its points, and
+    // are more than epsilon apart, so only a few are visited for each point
+    std::vector<size_t> slots(points.size());
+    std::vector<size_t> counts(keys.size(), 0);
+    for (int i = 0; i < n; ++i) {
+        if (reps[i] != static_cast<size_t>(i)) {
+            reps[i] = reps[reps[i]];
+            continue;
+        }
+        if (!finite[i]) {
+            continue;
+        }
+        for (int64_t dx = -1; dx <= 1; ++dx) {
+            for (int64_t dy = -1; dy <= 1; ++dy) {
+                for (int64_t dz = -1; dz <= 1; ++dz) {
+                    Cell cell{ { cells[i][0] + dx,
+                                 cells[i][1] + dy,
+                                 cells[i][2] + dz } };
+                    auto iter =
+                        std::lower_bound(keys.begin(), keys.end(), cell);
+                    if (iter == keys.end() || *iter != cell) {
+                        continue;
+                    }
+                    auto g = iter - keys.begin();
+                    for (size_t k = 0; k < counts[g]; ++k) {
+                        auto j = slots[begins[g] + k];
+                        auto d2 = 0.0;
+                        for (int c = 0; c < 3; ++c) {
+                            auto d = static_cast<double>(positions[3 * i + c]) -
+                                     positions[3 * j + c];
+                            d2 += d * d;
+                        }
+                        if (d2 <= eps2) {
+                            reps[i] = std::min(reps[i], j);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        if (reps[i] == static_cast<size_t>(i)) {
+            auto g = groups[i];
+            slots[begins[g] + counts[g]++] = i;
         }
     }
+    return reps;
+}
 
-    // Move elements in the back into slots to be removed
-    size_t idx = positions.size() - 3;
+/** Remove the marked slots of order.
+ *
+ *  Marks are in ascending order, and slots from the back are moved into
+ *  them, which is how all the fixers compact their vectors.
+ */
+inline void remove_marked(std::vector<size_t>& order,
+                          const std::vector<size_t>& marks)
+{
+    auto last = order.size();
     for (auto iter = marks.rbegin(); iter != marks.rend(); ++iter) {
-        positions[*iter] = positions[idx];
-        positions[*iter + 1] = positions[idx + 1];
-        positions[*iter + 2] = positions[idx + 2];
-        idx -= 3;
+        order[*iter] = order[--last];
     }
+    order.resize(last);
+}
 
-    // Now drop the end
-    positions.erase(positions.begin() + idx + 3, positions.end());
+/** Keep the points in order.
+ *
+ *  This is done in place since a point is never moved backwards.
+ */
+template<typename T>
+void gather_points(std::vector<T>& positions, const std::vector<size_t>& order)
+{
+    for (size_t i = 0; i < order.size(); ++i) {
+        EASSERT(order[i] >= i);
+        if (order[i] != i) {
+            for (size_t k = 0; k < 3; ++k) {
+                positions[i * 3 + k] = positions[order[i] * 3 + k];
+            }
+        }
+    }
+    positions.erase(positions.begin() + order.size() * 3, positions.end());
     positions.shrink_to_fit();
+}
 
-    return marks.size();
+/** Find the points left after merging, and the new index of every point.
+ *
+ */
+inline std::vector<size_t> weld_map(const std::vector<size_t>& reps,
+                                    std::vector<size_t>& order)
+{
+    const auto n = reps.size();
+    std::vector<size_t> marks;
+    for (size_t i = 0; i < n; ++i) {
+        if (reps[i] != i) {
+            marks.push_back(i);
+        }
+    }
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 0);
+    remove_marked(order, marks);
+
+    std::vector<size_t> index_map(n);
+    for (size_t i = 0; i < order.size(); ++i) {
+        index_map[order[i]] = i;
+    }
+    for (auto i : marks) {
+        index_map[i] = index_map[reps[i]];
+    }
+    return index_map;
+}
+
+/** Whether two consecutive edges of a face are collinear.
+ *
+ */
+template<int N, typename T, typename Face>
+bool is_degenerate(const std::vector<T>& positions, const Face& face)
+{
+    using Kernel = CGAL::Simple_cartesian<T>;
+    using Point_3 = typename Kernel::Point_3;
+
+    auto point = [&](size_t i) {
+        auto p = face[i] * 3;
+        return Point_3{ positions[p], positions[p + 1], positions[p + 2] };
+    };
+    for (size_t j = 0; j < N - 1; ++j) {
+        if (CGAL::collinear<Kernel>(
+                point(j), point(j + 1), point((j + 2) % N))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace _impl
+
+template<typename T>
+size_t remove_duplicate_vertices(std::vector<T>& positions, double epsilon)
+{
+    if (positions.empty()) {
+        EWARNING("positions is empty.");
+        return 0;
+    }
+    if (positions.size() % 3 != 0) {
+        throw std::runtime_error("Input position size is not divisible by 3");
+    }
+    if (!(epsilon >= 0.0)) {
+        throw std::invalid_argument("Epsilon must be non-negative.");
+    }
+
+    auto reps = _impl::weld_points(positions, epsilon);
+    std::vector<size_t> order;
+    _impl::weld_map(reps, order);
+    _impl::gather_points(positions, order);
+    return reps.size() - order.size();
 }
 
 template<int N, typename T1, typename T2>
 size_t remove_duplicate_vertices(std::vector<T1>& positions,
-                                 std::vector<T2>& indices)
+                                 std::vector<T2>& indices,
+                                 double epsilon)
 {
     static_assert(N >= 3);
     if (positions.empty()) {
@@ -86,7 +364,7 @@ size_t remove_duplicate_vertices(std::vector<T1>& positions,
         return 0;
     }
     if (indices.empty()) {
-        remove_duplicate_vertices(positions);
+        return remove_duplicate_vertices(positions, epsilon);
     }
     if (positions.size() % 3 != 0) {
         throw std::runtime_error("Input position size is not divisible by 3");
@@ -101,69 +379,22 @@ size_t remove_duplicate_vertices(std::vector<T1>& positions,
         throw std::runtime_error(
             "Input indices is out of range of the position vector");
     }
-    using Point = std::array<T1, 3>;
-
-    // marks[duplicate] = first
-    // duplicate and first are indices into the position vector
-    std::map<size_t, size_t> marks;
-
-    // unique_points[point] = index
-    // index refers to the position vector
-    std::unordered_map<Point, size_t, boost::hash<Point>> unique_points;
-
-    // Map all the duplicate positions to their first appearance
-    for (size_t i = 0; i < positions.size(); i += 3) {
-        Point p{ { positions[i], positions[i + 1], positions[i + 2] } };
-        auto [iter, is_unique] = unique_points.try_emplace(std::move(p), i);
-        if (!is_unique) {
-            EASSERT(p == iter->first);
-            marks[i] = iter->second;
-        }
-    }
-
-    size_t idx = positions.size() - 3;
-
-    // values in index_swap refers to the index of a Point
-    std::vector<size_t> index_swap(positions.size() / 3);
-    std::iota(index_swap.begin(), index_swap.end(), 0);
-
-    for (auto iter = marks.rbegin(); iter != marks.rend(); ++iter, idx -= 3) {
-        // Replace positions in marks with positions in the back of the vector
-        auto pos = iter->first;
-        positions[pos] = positions[idx];
-        positions[pos + 1] = positions[idx + 1];
-        positions[pos + 2] = positions[idx + 2];
-
-        // Swap indices accordingly
-        std::swap(index_swap[pos / 3], index_swap[idx / 3]);
+    if (!(epsilon >= 0.0)) {
+        throw std::invalid_argument("Epsilon must be non-negative.");
     }
 
-    // index_map[old] = new
-    // old and new are indices of Point
-    std::vector<size_t> index_map(positions.size() / 3);
-
-    for (size_t i = 0; i < index_swap.size() - marks.size(); ++i) {
-        EASSERT(marks.find(index_swap[i] * 3) == marks.end());
-        index_map[index_swap[i]] = i;
-    }
-    for (size_t i = index_swap.size() - marks.size(); i < index_swap.size();
-         ++i) {
-        EASSERT(marks.find(index_swap[i] * 3) != marks.end());
-        index_map[index_swap[i]] = index_map[marks[index_swap[i] * 3] / 3];
-    }
+    auto reps = _impl::weld_points(positions, epsilon);
+    std::vector<size_t> order;
+    auto index_map = _impl::weld_map(reps, order);
+    _impl::gather_points(positions, order);
 
     // Now fix indices
-    for (auto& i : indices) {
-        auto new_idx = index_map[i];
-        EASSERT(new_idx < (positions.size() / 3 - marks.size()));
-        i = static_cast<T2>(new_idx);
+    const auto n = static_cast<int>(indices.size());
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i = 0; i < n; ++i) {
+        indices[i] = static_cast<T2>(index_map[indices[i]]);
     }
-
-    // Now erase garbage values at the tail of the vector
-    positions.erase(positions.begin() + idx + 3, positions.end());
-    positions.shrink_to_fit();
-
-    return marks.size();
+    return reps.size() - order.size();
 }
 
 template<int N, typename T>
@@ -293,30 +524,11 @@ size_t remove_degenerate_faces(const std::vector<T1>& positions,
         throw std::runtime_error(
             "Input indices is out of range of the position vector");
     }
-    using Kernel = CGAL::Simple_cartesian<T1>;
-    using Point_3 = typename Kernel::Point_3;
 
     std::vector<size_t> marks;
     for (size_t i = 0; i < indices.size(); i += N) {
-        for (size_t j = 0; j < N - 1; ++j) {
-            auto p0 = indices[i + j] * 3;
-            auto p1 = indices[i + j + 1] * 3;
-            auto p2 = (j == N - 2 ? indices[i] : indices[i + j + 2]) * 3;
-            auto x0 = positions[p0];
-            auto y0 = positions[p0 + 1];
-            auto z0 = positions[p0 + 2];
-            auto x1 = positions[p1];
-            auto y1 = positions[p1 + 1];
-            auto z1 = positions[p1 + 2];
-            auto x2 = positions[p2];
-            auto y2 = positions[p2 + 1];
-            auto z2 = positions[p2 + 2];
-            if (CGAL::collinear<Kernel>(Point_3{ x0, y0, z0 },
-                                        Point_3{ x1, y1, z1 },
-                                        Point_3{ x2, y2, z2 })) {
-                marks.push_back(i);
-                break;
-            }
+        if (_impl::is_degenerate<N>(positions, indices.data() + i)) {
+            marks.push_back(i);
         }
     }
 
@@ -333,4 +545,160 @@ size_t remove_degenerate_faces(const std::vector<T1>& positions,
     return marks.size();
 }
 
+template<int N, typename T1, typename T2>
+FixMeshStats fix_mesh(std::vector<T1>& positions,
+                      std::vector<T2>& indices,
+                      double epsilon)
+{
+    static_assert(N >= 3);
+    using Face = std::array<T2, N>;
+
+    FixMeshStats stats;
+    if (positions.empty()) {
+        EWARNING("positions is empty.");
+        return stats;
+    }
+    if (positions.size() % 3 != 0) {
+        throw std::runtime_error("Input position size is not divisible by 3");
+    }
+    if (indices.size() % N != 0) {
+        std::string err_str("Input index size is not divisible by ");
+        err_str.append(std::to_string(N));
+        throw(err_str);
+    }
+    if (!indices.empty() &&
+        *std::max_element(indices.begin(), indices.end()) >=
+            static_cast<T2>(positions.size() / 3)) {
+        throw std::runtime_error(
+            "Input indices is out of range of the position vector");
+    }
+    if (!(epsilon >= 0.0)) {
+        throw std::invalid_argument("Epsilon must be non-negative.");
+    }
+    Timer timer;
+
+    // Weld vertices, positions are only moved at last
+    timer.tick();
+    auto reps = _impl::weld_points(positions, epsilon);
+    std::vector<size_t> vertex_order;
+    auto welded = _impl::weld_map(reps, vertex_order);
+    stats.duplicate_vertices = reps.size() - vertex_order.size();
+    stats.weld_time = timer.tock();
+    if (indices.empty()) {
+        EWARNING("indices is empty.");
+        _impl::gather_points(positions, vertex_order);
+        stats.vertex_map = std::move(welded);
+        return stats;
+    }
+
+    // Remap faces to the welded vertices, duplicate faces are consecutive
+    // after sorting their canonical forms
+    timer.tick();
+    const auto n_faces = static_cast<int>(indices.size() / N);
+    std::vector<Face> faces(n_faces);
+    std::vector<std::pair<Face, size_t>> canonical(n_faces);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i = 0; i < n_faces; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            auto v = static_cast<size_t>(indices[i * N + j]);
+            faces[i][j] = static_cast<T2>(welded[v]);
+        }
+        canonical[i] = { _impl::to_canonical<T2, N>(faces[i]), i };
+    }
+    _impl::parallel_sort(
+        canonical.begin(), canonical.end(), _impl::KeyLess());
+
+    std::vector<char> duplicate(n_faces, 0);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i = 1; i < n_faces; ++i) {
+        if (canonical[i].first == canonical[i - 1].first) {
+            duplicate[canonical[i].second] = 1;
+        }
+    }
+    std::vector<size_t> face_order(n_faces);
+    std::iota(face_order.begin(), face_order.end(), 0);
+    std::vector<size_t> marks;
+    for (int i = 0; i < n_faces; ++i) {
+        if (duplicate[i]) {
+            marks.push_back(i);
+        }
+    }
+    _impl::remove_marked(face_order, marks);
+    stats.duplicate_faces = marks.size();
+
+    // Check the remaining faces, on the positions of the representatives
+    const auto n_unique = static_cast<int>(face_order.size());
+    std::vector<char> degenerate(n_unique);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i = 0; i < n_unique; ++i) {
+        std::array<size_t, N> face;
+        for (size_t j = 0; j < N; ++j) {
+            face[j] = reps[indices[face_order[i] * N + j]];
+        }
+        degenerate[i] = _impl::is_degenerate<N>(positions, face);
+    }
+    marks.clear();
+    for (int i = 0; i < n_unique; ++i) {
+        if (degenerate[i]) {
+            marks.push_back(i);
+        }
+    }
+    _impl::remove_marked(face_order, marks);
+    stats.degenerate_faces = marks.size();
+    stats.face_time = timer.tock();
+
+    // Drop unreferenced vertices, then move positions and indices once
+    timer.tick();
+    std::vector<size_t> order(vertex_order.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::vector<size_t> index_map(order);
+    if (!face_order.empty()) {
+        std::vector<char> referenced(order.size(), 0);
+        for (auto f : face_order) {
+            for (auto v : faces[f]) {
+                referenced[v] = 1;
+            }
+        }
+        marks.clear();
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (!referenced[i]) {
+                marks.push_back(i);
+            }
+        }
+        _impl::remove_marked(order, marks);
+        stats.unreferenced_vertices = marks.size();
+
+        std::fill(index_map.begin(), index_map.end(), FixMeshStats::removed);
+        for (size_t i = 0; i < order.size(); ++i) {
+            index_map[order[i]] = i;
+        }
+    }
+    else {
+        EWARNING("indices is empty.");
+    }
+    for (auto& v : order) {
+        v = vertex_order[v];
+    }
+    _impl::gather_points(positions, order);
+
+    const auto n = static_cast<int>(face_order.size());
+    std::vector<T2> new_indices(face_order.size() * N);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i = 0; i < n; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            new_indices[i * N + j] =
+                static_cast<T2>(index_map[faces[face_order[i]][j]]);
+        }
+    }
+    indices.swap(new_indices);
+
+    for (auto& v : welded) {
+        v = index_map[v];
+    }
+    stats.vertex_map = std::move(welded);
+    stats.compact_time = timer.tock();
+
+    return stats;
+}
+
 } // namespace Euclid
@@ -1,7 +1,10 @@
-#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <fstream>
 #include <stdexcept>
-#include <string_view>
+#include <string>
 
 #include <Euclid/Util/Assert.h>
 
@@ -13,105 +16,375 @@ namespace Euclid
 namespace _impl
 {
 
+/** Indices parsed from a chunk of an obj file.
+ *
+ *  Negative indices are relative to the vertices defined so far, so they are
+ *  stored relative to the start of the chunk and resolved once the number of
+ *  vertices in the preceding chunks is known.
+ */
+struct ObjIndices
+{
+    std::vector<int64_t> values;
+    std::vector<size_t> relative;
+};
+
+/** Properties parsed from a chunk of an obj file.
+ *
+ *  Texcoords and normals are counted even if their values are not kept, so
+ *  that relative indices can be resolved.
+ */
+template<typename FT>
+struct ObjChunk
+{
+    std::vector<FT> positions;
+    std::vector<FT> texcoords;
+    std::vector<FT> normals;
+    size_t n_texcoords = 0;
+    size_t n_normals = 0;
+    ObjIndices pindices;
+    ObjIndices tindices;
+    ObjIndices nindices;
+};
+
+inline bool obj_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* obj_skip_spaces(const char* p, const char* end)
+{
+    while (p != end && obj_space(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+inline const char* obj_skip_line(const char* p, const char* end)
+{
+    auto eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return eol == nullptr ? end : eol + 1;
+}
+
+template<typename T>
+const char* obj_parse(const char* p, const char* end, T& value)
+{
+    p = parse_number(obj_skip_spaces(p, end), end, value);
+    if (p == nullptr) {
+        throw std::runtime_error("Bad obj file");
+    }
+    return p;
+}
+
+/** Parse the first N values of a vertex property, ignoring the others.*/
 template<int N, typename FT>
-static void read_vertex_properties(std::ifstream& stream,
-                                   std::vector<FT>* buffer)
+const char* obj_parse_vertex(const char* p,
+                             const char* end,
+                             std::vector<FT>* buffer)
 {
     for (int i = 0; i < N; ++i) {
         FT value;
-        stream >> value;
-        buffer->push_back(value);
+        p = obj_parse(p, end, value);
+        if (buffer != nullptr) {
+            buffer->push_back(value);
+        }
     }
+    return obj_skip_line(p, end);
 }
 
-} // namespace _impl
+/** Store an index into a chunk given the number of vertices parsed so far.*/
+inline void obj_push_index(int64_t index, size_t count, ObjIndices& indices)
+{
+    if (index > 0) {
+        indices.values.push_back(index - 1);
+    }
+    else if (index < 0) {
+        indices.relative.push_back(indices.values.size());
+        indices.values.push_back(static_cast<int64_t>(count) + index);
+    }
+    else {
+        throw std::runtime_error("Bad obj file");
+    }
+}
 
-template<typename FT>
-void read_obj(const std::string& filename,
-              std::vector<FT>& positions,
-              std::vector<FT>* texcoords,
-              std::vector<FT>* normals)
+/** Parse a face of N vertices in the v, v/t, v//n or v/t/n format.*/
+template<int N, typename FT>
+const char* obj_parse_face(const char* p,
+                           const char* end,
+                           ObjChunk<FT>& chunk,
+                           bool tindices,
+                           bool nindices)
 {
-    std::ifstream stream(filename);
-    _impl::check_fstream(stream, filename);
+    int n = 0;
+    while (true) {
+        p = obj_skip_spaces(p, end);
+        if (p == end || *p == '\n' || *p == '#') {
+            break;
+        }
+        if (++n > N) {
+            std::string err_str("Input file contains a face that is not a ");
+            err_str.append(std::to_string(N)).append("-polygon");
+            throw std::runtime_error(err_str);
+        }
 
-    while (!stream.eof()) {
-        std::string specifier;
-        stream >> specifier;
-        if (specifier == "v") {
-            _impl::read_vertex_properties<3>(stream, &positions);
+        int64_t index;
+        p = obj_parse(p, end, index);
+        obj_push_index(index, chunk.positions.size() / 3, chunk.pindices);
+        if (p == end || *p != '/') {
+            continue;
         }
-        else if (specifier == "vt" && texcoords != nullptr) {
-            _impl::read_vertex_properties<2>(stream, texcoords);
+        ++p;
+        if (p != end && *p != '/') {
+            p = obj_parse(p, end, index);
+            if (tindices) {
+                obj_push_index(index, chunk.n_texcoords, chunk.tindices);
+            }
         }
-        else if (specifier == "vn" && normals != nullptr) {
-            _impl::read_vertex_properties<3>(stream, normals);
+        if (p != end && *p == '/') {
+            p = obj_parse(p + 1, end, index);
+            if (nindices) {
+                obj_push_index(index, chunk.n_normals, chunk.nindices);
+            }
         }
-        else {
-            std::string dummy;
-            std::getline(stream, dummy);
+        if (p != end && !obj_space(*p) && *p != '\n') {
+            throw std::runtime_error("Bad obj file");
         }
     }
+    if (n != N) {
+        std::string err_str("Input file contains a face that is not a ");
+        err_str.append(std::to_string(N)).append("-polygon");
+        throw std::runtime_error(err_str);
+    }
+    return obj_skip_line(p, end);
 }
 
+/** Parse the lines in [p, end), faces are parsed only if N is positive.*/
+template<int N, typename FT>
+void obj_parse_chunk(const char* p,
+                     const char* end,
+                     ObjChunk<FT>& chunk,
+                     bool texcoords,
+                     bool normals,
+                     bool tindices,
+                     bool nindices)
+{
+    while (p != end) {
+        p = obj_skip_spaces(p, end);
+        const auto n = end - p;
+        if (n > 1 && p[0] == 'v' && obj_space(p[1])) {
+            p = obj_parse_vertex<3>(p + 1, end, &chunk.positions);
+        }
+        else if (n > 2 && p[0] == 'v' && p[1] == 't' && obj_space(p[2])) {
+            p = obj_parse_vertex<2>(
+                p + 2, end, texcoords ? &chunk.texcoords : nullptr);
+            ++chunk.n_texcoords;
+        }
+        else if (n > 2 && p[0] == 'v' && p[1] == 'n' && obj_space(p[2])) {
+            p = obj_parse_vertex<3>(
+                p + 2, end, normals ? &chunk.normals : nullptr);
+            ++chunk.n_normals;
+        }
+        else if (N > 0 && n > 1 && p[0] == 'f' && obj_space(p[1])) {
+            p = obj_parse_face<N>(p + 1, end, chunk, tindices, nindices);
+        }
+        else if (p != end) {
+            p = obj_skip_line(p, end);
+        }
+    }
+}
+
+/** Copy the indices of a chunk, resolving the relative ones.*/
+template<typename IT>
+void obj_copy_indices(const ObjIndices& indices, int64_t base, IT* dst)
+{
+    for (size_t i = 0; i < indices.values.size(); ++i) {
+        dst[i] = static_cast<IT>(indices.values[i]);
+    }
+    for (auto i : indices.relative) {
+        auto index = indices.values[i] + base;
+        if (index < 0) {
+            throw std::runtime_error("Bad obj file");
+        }
+        dst[i] = static_cast<IT>(index);
+    }
+}
+
+/** Read an obj file, faces are read only if N is positive.
+ *
+ *  The file is mapped into memory and split at line boundaries into chunks,
+ *  which are parsed in parallel and then concatenated.
+ */
 template<int N, typename FT, typename IT>
 void read_obj(const std::string& filename,
               std::vector<FT>& positions,
-              std::vector<IT>& pindices,
+              std::vector<IT>* pindices,
               std::vector<FT>* texcoords,
               std::vector<IT>* tindices,
               std::vector<FT>* normals,
               std::vector<IT>* nindices)
 {
-    std::ifstream stream(filename);
-    _impl::check_fstream(stream, filename);
+    constexpr const size_t chunk_size = 1 << 20;
+
+    MappedFile file(filename);
+    const auto data = file.data();
+    const auto size = file.size();
+
+    // chunks start right after a line break
+    std::vector<const char*> bounds{ data };
+    for (size_t pos = chunk_size; pos < size; pos += chunk_size) {
+        auto first = std::max(bounds.back(), data + pos);
+        auto p = obj_skip_line(first, data + size);
+        if (p != bounds.back()) {
+            bounds.push_back(p);
+        }
+    }
+    if (bounds.back() != data + size) {
+        bounds.push_back(data + size);
+    }
+
+    const auto n_chunks = static_cast<int>(bounds.size()) - 1;
+    std::vector<ObjChunk<FT>> chunks(std::max(n_chunks, 0));
+    std::vector<std::exception_ptr> errors(chunks.size());
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < n_chunks; ++i) {
+        try {
+            obj_parse_chunk<N>(bounds[i],
+                               bounds[i + 1],
+                               chunks[i],
+                               texcoords != nullptr,
+                               normals != nullptr,
+                               tindices != nullptr,
+                               nindices != nullptr);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    }
+    for (const auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
 
-    while (!stream.eof()) {
-        std::string specifier;
-        stream >> specifier;
-        if (specifier == "#") {
-            std::string buffer;
-            std::getline(stream, buffer);
-        }
-        else if (specifier == "v") {
-            _impl::read_vertex_properties<3>(stream, &positions);
-        }
-        else if (specifier == "vt" && texcoords != nullptr) {
-            _impl::read_vertex_properties<2>(stream, texcoords);
-        }
-        else if (specifier == "vn" && normals != nullptr) {
-            _impl::read_vertex_properties<3>(stream, normals);
-        }
-        else if (specifier == "f") {
-            std::getline(stream, specifier);
-            auto faces = _impl::split(specifier, ' ', 1);
-            if (faces.size() != N) {
-                std::string err_str(
-                    "Input file contains a face that is not a ");
-                err_str.append(std::to_string(N)).append("-polygon");
-                throw std::runtime_error(err_str);
+    // offsets of each chunk into the outputs, relative to what's in them
+    struct Offsets
+    {
+        size_t positions, texcoords, normals;
+        size_t pindices, tindices, nindices;
+        size_t n_texcoords, n_normals;
+    };
+    std::vector<Offsets> offsets(chunks.size() + 1);
+    offsets[0] = { positions.size(),
+                   texcoords != nullptr ? texcoords->size() : 0,
+                   normals != nullptr ? normals->size() : 0,
+                   pindices != nullptr ? pindices->size() : 0,
+                   tindices != nullptr ? tindices->size() : 0,
+                   nindices != nullptr ? nindices->size() : 0,
+                   0,
+                   0 };
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const auto& c = chunks[i];
+        const auto& o = offsets[i];
+        offsets[i + 1] = { o.positions + c.positions.size(),
+                           o.texcoords + c.texcoords.size(),
+                           o.normals + c.normals.size(),
+                           o.pindices + c.pindices.values.size(),
+                           o.tindices + c.tindices.values.size(),
+                           o.nindices + c.nindices.values.size(),
+                           o.n_texcoords + c.n_texcoords,
+                           o.n_normals + c.n_normals };
+    }
+    const auto& total = offsets.back();
+    positions.resize(total.positions);
+    if (texcoords != nullptr) {
+        texcoords->resize(total.texcoords);
+    }
+    if (normals != nullptr) {
+        normals->resize(total.normals);
+    }
+    if (pindices != nullptr) {
+        pindices->resize(total.pindices);
+    }
+    if (tindices != nullptr) {
+        tindices->resize(total.tindices);
+    }
+    if (nindices != nullptr) {
+        nindices->resize(total.nindices);
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < n_chunks; ++i) {
+        try {
+            const auto& c = chunks[i];
+            const auto& o = offsets[i];
+            const auto& b = offsets[0];
+            std::copy(c.positions.begin(),
+                      c.positions.end(),
+                      positions.begin() + o.positions);
+            if (texcoords != nullptr) {
+                std::copy(c.texcoords.begin(),
+                          c.texcoords.end(),
+                          texcoords->begin() + o.texcoords);
             }
-            for (const auto& face : faces) {
-                auto idx = _impl::split(face, '/');
-                if (idx.size() >= 1) {
-                    pindices.push_back(std::stoi(std::string(idx[0])) - 1);
-                }
-                if (idx.size() >= 2 && tindices != nullptr) {
-                    tindices->push_back(std::stoi(std::string(idx[1])) - 1);
-                }
-                if (idx.size() == 3 && nindices != nullptr) {
-                    nindices->push_back(std::stoi(std::string(idx[2])) - 1);
-                }
-                if (idx.size() > 3) {
-                    throw std::runtime_error("Bad obj file");
-                }
+            if (normals != nullptr) {
+                std::copy(c.normals.begin(),
+                          c.normals.end(),
+                          normals->begin() + o.normals);
+            }
+            if (pindices != nullptr) {
+                obj_copy_indices(c.pindices,
+                                 (o.positions - b.positions) / 3,
+                                 pindices->data() + o.pindices);
+            }
+            if (tindices != nullptr) {
+                obj_copy_indices(c.tindices,
+                                 o.n_texcoords,
+                                 tindices->data() + o.tindices);
+            }
+            if (nindices != nullptr) {
+                obj_copy_indices(c.nindices,
+                                 o.n_normals,
+                                 nindices->data() + o.nindices);
             }
         }
-        else {
-            std::string dummy;
-            std::getline(stream, dummy);
+        catch (...) {
+            errors[i] = std::current_exception();
         }
     }
+    for (const auto& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+} // namespace _impl
+
+template<typename FT>
+void read_obj(const std::string& filename,
+              std::vector<FT>& positions,
+              std::vector<FT>* texcoords,
+              std::vector<FT>* normals)
+{
+    _impl::read_obj<0, FT, int>(
+        filename, positions, nullptr, texcoords, nullptr, normals, nullptr);
+}
+
+template<int N, typename FT, typename IT>
+void read_obj(const std::string& filename,
+              std::vector<FT>& positions,
+              std::vector<IT>& pindices,
+              std::vector<FT>* texcoords,
+              std::vector<IT>* tindices,
+              std::vector<FT>* normals,
+              std::vector<IT>* nindices)
+{
+    _impl::read_obj<N>(filename,
+                       positions,
+                       &pindices,
+                       texcoords,
+                       tindices,
+                       normals,
+                       nindices);
 }
 
 template<typename FT>
@@ -1,5 +1,7 @@
+#include <array>
 #include <fstream>
 #include <stdexcept>
+#include <string_view>
 #include <tuple>
 
 #include "IOHelpers.h"
@@ -10,18 +12,93 @@ namespace Euclid
 namespace _impl
 {
 
-inline std::tuple<size_t, size_t, size_t> read_header(std::ifstream& stream)
+inline bool off_space(char c)
 {
-    std::string word;
-    stream >> word;
+    return c == ' ' || c == '\t' || c == '\r';
+}
 
-    size_t n_vertices, n_faces, n_edges;
-    stream >> n_vertices >> n_faces >> n_edges;
+/** Split the next line which is not empty or a comment into tokens.
+ *
+ *  Return the number of tokens in the line, where at most K are stored.
+ */
+template<size_t K>
+size_t off_tokens(const char*& p,
+                  const char* end,
+                  std::array<std::string_view, K>& tokens)
+{
+    size_t n = 0;
+    while (p != end && n == 0) {
+        while (p != end && *p != '\n') {
+            while (p != end && off_space(*p)) {
+                ++p;
+            }
+            if (p == end || *p == '\n') {
+                break;
+            }
+            if (*p == '#' && n == 0) {
+                while (p != end && *p != '\n') {
+                    ++p;
+                }
+                break;
+            }
+            auto first = p;
+            while (p != end && !off_space(*p) && *p != '\n') {
+                ++p;
+            }
+            if (n < K) {
+                tokens[n] = std::string_view(first, p - first);
+            }
+            ++n;
+        }
+        if (p != end) {
+            ++p;
+        }
+    }
+    return n;
+}
 
-    std::string dummy;
-    std::getline(stream, dummy);
+template<typename T>
+T off_value(std::string_view token, const std::string& filename)
+{
+    T value{};
+    auto last = token.data() + token.size();
+    if (parse_number(token.data(), last, value) != last) {
+        std::string err("Invalid off file: ");
+        err.append(filename);
+        throw std::runtime_error(err);
+    }
+    return value;
+}
+
+/** Colors may be stored as floats, which are truncated like the integers.*/
+template<typename CT>
+CT off_color(std::string_view token, const std::string& filename)
+{
+    return static_cast<CT>(
+        static_cast<int>(off_value<double>(token, filename)));
+}
 
-    return std::make_tuple(n_vertices, n_faces, n_edges);
+inline std::tuple<size_t, size_t, size_t> read_header(
+    const char*& p,
+    const char* end,
+    const std::string& filename)
+{
+    // the counts may follow the keyword on the same line or the next one
+    std::array<std::string_view, 4> tokens;
+    auto n = off_tokens(p, end, tokens);
+    size_t first = 1;
+    if (n == 1) {
+        n = off_tokens(p, end, tokens) + 1;
+        first = 0;
+    }
+    if (n < 4) {
+        std::string err("Invalid off file: ");
+        err.append(filename);
+        throw std::runtime_error(err);
+    }
+    return std::make_tuple(off_value<size_t>(tokens[first], filename),
+                           off_value<size_t>(tokens[first + 1], filename),
+                           off_value<size_t>(tokens[first + 2], filename));
 }
 
 inline void write_header(std::ofstream& stream, size_t nv, size_t nf)
@@ -37,10 +114,11 @@ void read_off(const std::string& filename,
               std::vector<IT>* findices,
               std::vector<CT>* fcolors)
 {
-    std::ifstream stream(filename);
-    check_fstream(stream, filename);
+    MappedFile file(filename);
+    const char* p = file.data();
+    const char* end = p + file.size();
 
-    auto [nvertices, nfaces, nedges] = read_header(stream);
+    auto [nvertices, nfaces, nedges] = read_header(p, end, filename);
     positions.resize(nvertices * 3);
     if (vcolors != nullptr) {
         vcolors->resize(nvertices * 4);
@@ -52,54 +130,49 @@ void read_off(const std::string& filename,
         fcolors->resize(nfaces * 4);
     }
 
+    std::array<std::string_view, 7> vtokens;
     for (size_t i = 0; i < nvertices; ++i) {
-        std::string line;
-        std::getline(stream, line);
-        auto words = split(line, ' ');
-        if (words.size() != 3 && words.size() != 7) {
+        auto n = off_tokens(p, end, vtokens);
+        if (n != 3 && n != 7) {
             std::string err("Invalid off file: ");
             err.append(filename);
             throw std::runtime_error(err);
         }
 
         for (size_t j = 0; j < 3; ++j) {
-            auto p = std::stod(std::string(words[j]));
-            positions[3 * i + j] = static_cast<FT>(p);
+            positions[3 * i + j] = off_value<FT>(vtokens[j], filename);
         }
 
-        if (vcolors != nullptr && words.size() == 7) {
+        if (vcolors != nullptr && n == 7) {
             for (size_t j = 0; j < 4; ++j) {
-                auto c = std::stoi(std::string(words[3 + j]));
-                (*vcolors)[4 * i + j] = static_cast<CT>(c);
+                (*vcolors)[4 * i + j] = off_color<CT>(vtokens[3 + j], filename);
             }
         }
     }
     if (findices != nullptr && nfaces != 0) {
+        std::array<std::string_view, N + 5> ftokens;
         for (size_t i = 0; i < nfaces; ++i) {
-            std::string line;
-            std::getline(stream, line);
-            auto words = split(line, ' ');
-            if (words.size() != N + 1 && words.size() != N + 5) {
+            auto n = off_tokens(p, end, ftokens);
+            if (n != N + 1 && n != N + 5) {
                 std::string err("Invalid off file: ");
                 err.append(filename);
                 throw std::runtime_error(err);
             }
-            auto n = std::stoi(std::string(words[0]));
-            if (n != N) {
+            if (off_value<int>(ftokens[0], filename) != N) {
                 std::string err("Invalid off file: ");
                 err.append(filename);
                 throw std::runtime_error(err);
             }
 
             for (int j = 0; j < N; ++j) {
-                auto idx = std::stoul(std::string(words[j + 1]));
-                (*findices)[N * i + j] = static_cast<IT>(idx);
+                (*findices)[N * i + j] =
+                    off_value<IT>(ftokens[j + 1], filename);
             }
 
-            if (fcolors != nullptr && words.size() == N + 5) {
+            if (fcolors != nullptr && n == N + 5) {
                 for (size_t j = 0; j < 4; ++j) {
-                    auto c = std::stoi(std::string(words[j + 1 + N]));
-                    (*fcolors)[4 * i + j] = static_cast<CT>(c);
+                    (*fcolors)[4 * i + j] =
+                        off_color<CT>(ftokens[j + 1 + N], filename);
                 }
             }
         }
@@ -134,35 +207,46 @@ void write_off(const std::string& filename,
     }
     write_header(stream, nvertices, nfaces);
 
-    for (size_t i = 0; i < nvertices; ++i) {
+    write_lines(stream, nvertices, [&](size_t i, std::string& line) {
         for (size_t j = 0; j < 3; ++j) {
-            stream << positions[3 * i + j] << " ";
+            append_number(line, positions[3 * i + j]);
+            line.push_back(' ');
         }
 
         if (vcolors != nullptr) {
             for (size_t j = 0; j < 4; ++j) {
-                stream << static_cast<int>((*vcolors)[4 * i + j]) << " ";
+                append_number(line, static_cast<int>((*vcolors)[4 * i + j]));
+                line.push_back(' ');
             }
         }
 
-        stream << std::endl;
-    }
+        line.push_back('\n');
+    });
     if (findices != nullptr && nfaces != 0) {
-        for (size_t i = 0; i < nfaces; ++i) {
-            stream << N << " ";
+        write_lines(stream, nfaces, [&](size_t i, std::string& line) {
+            append_number(line, N);
+            line.push_back(' ');
 
             for (int j = 0; j < N; ++j) {
-                stream << (*findices)[N * i + j] << " ";
+                append_number(line, (*findices)[N * i + j]);
+                line.push_back(' ');
             }
 
             if (fcolors != nullptr) {
                 for (size_t j = 0; j < 4; ++j) {
-                    stream << static_cast<int>((*fcolors)[4 * i + j]) << " ";
+                    append_number(line,
+                                  static_cast<int>((*fcolors)[4 * i + j]));
+                    line.push_back(' ');
                 }
             }
 
-            stream << std::endl;
-        }
+            line.push_back('\n');
+        });
+    }
+    if (!stream) {
+        std::string err("Failed to write file ");
+        err.append(filename);
+        throw std::runtime_error(err);
     }
 }
 
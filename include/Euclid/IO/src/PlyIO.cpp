@@ -1,8 +1,12 @@
 #include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
+#include <string_view>
 
 #include <Euclid/Util/Assert.h>
 
@@ -16,7 +20,7 @@ namespace _impl
 
 /** Read a line in ply header, ignore comments.*/
 static inline std::vector<std::string> read_ply_header_line(
-    std::ifstream& stream)
+    std::istream& stream)
 {
     std::vector<std::string> words;
     do {
@@ -215,7 +219,7 @@ inline std::unique_ptr<PlyProperty> make_property<unsigned char>(
 }
 
 /** Implementation of reading ply header.*/
-static PlyHeader read_ply_header(std::ifstream& stream)
+static PlyHeader read_ply_header(std::istream& stream)
 {
     std::string line;
     std::getline(stream, line);
@@ -260,20 +264,25 @@ static PlyHeader read_ply_header(std::ifstream& stream)
                 }
                 else if (words[1] == "int") {
                     auto property = std::make_unique<PlyIntProperty>(words[2]);
+                    element.add_property(std::move(property));
                 }
                 else if (words[1] == "uint") {
                     auto property = std::make_unique<PlyUintProperty>(words[2]);
+                    element.add_property(std::move(property));
                 }
                 else if (words[1] == "short") {
                     auto property =
                         std::make_unique<PlyShortProperty>(words[2]);
+                    element.add_property(std::move(property));
                 }
                 else if (words[1] == "ushort") {
                     auto property =
                         std::make_unique<PlyUshortProperty>(words[2]);
+                    element.add_property(std::move(property));
                 }
                 else if (words[1] == "char") {
                     auto property = std::make_unique<PlyCharProperty>(words[2]);
+                    element.add_property(std::move(property));
                 }
                 else if (words[1] == "uchar") {
                     auto property =
@@ -343,6 +352,633 @@ static PlyHeader read_ply_header(std::ifstream& stream)
     return header;
 }
 
+/** Scalar types of ply values.*/
+enum class PlyType
+{
+    int8,
+    uint8,
+    int16,
+    uint16,
+    int32,
+    uint32,
+    float32,
+    float64
+};
+
+/** Destinations of the values decoded by CommonPlyReader.*/
+enum class PlyTarget
+{
+    none,
+    position,
+    normal,
+    texcoord,
+    color,
+    index
+};
+
+/** How to decode a property of an element.*/
+struct PlyPropertyPlan
+{
+    PlyType type;
+    size_t size;   // size of a value in bytes
+    size_t offset; // byte offset in an instance of fixed size
+    bool is_list;
+    PlyTarget target;
+    int component;
+};
+
+/** How to decode all instances of an element.*/
+struct PlyElementPlan
+{
+    std::vector<PlyPropertyPlan> properties;
+    size_t count;
+    size_t stride; // size of an instance in bytes, 0 if not fixed
+    int color_components;
+};
+
+/** Return the bit of a target in a set of targets.*/
+constexpr unsigned ply_target_bit(PlyTarget target)
+{
+    return 1u << static_cast<unsigned>(target);
+}
+
+/** Return the type of a property.*/
+inline PlyType ply_type(const PlyProperty& property)
+{
+    const auto type = property.type_str();
+    if (type == "char") {
+        return PlyType::int8;
+    }
+    else if (type == "uchar") {
+        return PlyType::uint8;
+    }
+    else if (type == "short") {
+        return PlyType::int16;
+    }
+    else if (type == "ushort") {
+        return PlyType::uint16;
+    }
+    else if (type == "int") {
+        return PlyType::int32;
+    }
+    else if (type == "uint") {
+        return PlyType::uint32;
+    }
+    else if (type == "float") {
+        return PlyType::float32;
+    }
+    else if (type == "double") {
+        return PlyType::float64;
+    }
+    else {
+        std::string err_str("Invalid property type ");
+        err_str.append(type);
+        throw std::runtime_error(err_str);
+    }
+}
+
+/** Return the size of a type in bytes.*/
+inline size_t ply_type_size(PlyType type)
+{
+    switch (type) {
+    case PlyType::int8:
+    case PlyType::uint8: return 1;
+    case PlyType::int16:
+    case PlyType::uint16: return 2;
+    case PlyType::int32:
+    case PlyType::uint32:
+    case PlyType::float32: return 4;
+    default: return 8;
+    }
+}
+
+/** Check if values of a ply type could be accessed as T in place.*/
+template<typename T>
+bool ply_type_matches(PlyType type)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        return (type == PlyType::float32 && sizeof(T) == 4) ||
+               (type == PlyType::float64 && sizeof(T) == 8);
+    }
+    else {
+        return type != PlyType::float32 && type != PlyType::float64 &&
+               ply_type_size(type) == sizeof(T);
+    }
+}
+
+/** Load a binary value from memory.*/
+template<typename T>
+T load_binary(const char* src, bool swap)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, src, sizeof(T));
+    if (swap && sizeof(T) > 1) {
+        swap_bytes(bytes, sizeof(T));
+    }
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+/** Convert n strided binary values of type Src into a strided array.*/
+template<typename Src, typename Dst>
+void scatter_binary(const char* src,
+                    size_t src_stride,
+                    size_t n,
+                    bool swap,
+                    Dst* dst,
+                    size_t dst_stride)
+{
+    if (swap) {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i * dst_stride] =
+                static_cast<Dst>(load_binary<Src>(src + i * src_stride, true));
+        }
+    }
+    else {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i * dst_stride] =
+                static_cast<Dst>(load_binary<Src>(src + i * src_stride, false));
+        }
+    }
+}
+
+/** Convert n strided binary values of a ply type into a strided array.*/
+template<typename Dst>
+void scatter_binary(PlyType type,
+                    const char* src,
+                    size_t src_stride,
+                    size_t n,
+                    bool swap,
+                    Dst* dst,
+                    size_t dst_stride)
+{
+    switch (type) {
+    case PlyType::int8:
+        scatter_binary<int8_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::uint8:
+        scatter_binary<uint8_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::int16:
+        scatter_binary<int16_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::uint16:
+        scatter_binary<uint16_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::int32:
+        scatter_binary<int32_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::uint32:
+        scatter_binary<uint32_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::float32:
+        scatter_binary<float>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::float64:
+        scatter_binary<double>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    }
+}
+
+/** Store a binary value into memory.*/
+template<typename T>
+void store_binary(T value, char* dst, bool swap)
+{
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if (swap && sizeof(T) > 1) {
+        swap_bytes(bytes, sizeof(T));
+    }
+    std::memcpy(dst, bytes, sizeof(T));
+}
+
+/** Convert a strided array into n strided binary values of type Dst.*/
+template<typename Dst, typename Src>
+void gather_binary(const Src* src,
+                   size_t src_stride,
+                   size_t n,
+                   bool swap,
+                   char* dst,
+                   size_t dst_stride)
+{
+    if (swap) {
+        for (size_t i = 0; i < n; ++i) {
+            store_binary(static_cast<Dst>(src[i * src_stride]),
+                         dst + i * dst_stride,
+                         true);
+        }
+    }
+    else {
+        for (size_t i = 0; i < n; ++i) {
+            store_binary(static_cast<Dst>(src[i * src_stride]),
+                         dst + i * dst_stride,
+                         false);
+        }
+    }
+}
+
+/** Convert a strided array into n strided binary values of a ply type.*/
+template<typename Src>
+void gather_binary(PlyType type,
+                   const Src* src,
+                   size_t src_stride,
+                   size_t n,
+                   bool swap,
+                   char* dst,
+                   size_t dst_stride)
+{
+    switch (type) {
+    case PlyType::int8:
+        gather_binary<int8_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::uint8:
+        gather_binary<uint8_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::int16:
+        gather_binary<int16_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::uint16:
+        gather_binary<uint16_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::int32:
+        gather_binary<int32_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::uint32:
+        gather_binary<uint32_t>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::float32:
+        gather_binary<float>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    case PlyType::float64:
+        gather_binary<double>(src, src_stride, n, swap, dst, dst_stride);
+        break;
+    }
+}
+
+/** Append an ascii value of a ply type to a string.*/
+template<typename T>
+void append_ascii(std::string& str, PlyType type, T value)
+{
+    switch (type) {
+    case PlyType::float32:
+        append_number(str, static_cast<float>(value));
+        break;
+    case PlyType::float64:
+        append_number(str, static_cast<double>(value));
+        break;
+    case PlyType::int8:
+    case PlyType::int16:
+    case PlyType::int32:
+        append_number(str, static_cast<int>(value));
+        break;
+    default: append_number(str, static_cast<unsigned>(value)); break;
+    }
+}
+
+/** Get an ascii value of a ply type from the stream.*/
+template<typename T>
+T get_ascii(std::ifstream& stream, PlyType type)
+{
+    if (type == PlyType::float32) {
+        return static_cast<T>(get_ascii<float>(stream));
+    }
+    else if (type == PlyType::float64) {
+        return static_cast<T>(get_ascii<double>(stream));
+    }
+    else {
+        return static_cast<T>(get_ascii<long long>(stream));
+    }
+}
+
+/** Throw if the number of vertices of a face is not VN.*/
+template<int VN>
+void check_face_size(unsigned count)
+{
+    if (count != VN) {
+        std::string err_str("Number of vertices per face should be ");
+        err_str.append(std::to_string(VN));
+        err_str.append(", rather than ");
+        err_str.append(std::to_string(count));
+        throw std::runtime_error(err_str);
+    }
+}
+
+/** Compile the plan to decode an element into the given set of targets.*/
+template<int VN>
+PlyElementPlan compile_ply_element(const PlyElement& element, unsigned targets)
+{
+    auto wanted = [targets](PlyTarget target) {
+        return (targets & ply_target_bit(target)) != 0;
+    };
+    const bool is_vertex = element.name() == "vertex";
+    const bool is_face = element.name() == "face";
+
+    PlyElementPlan plan;
+    plan.count = element.count();
+    plan.stride = 0;
+    plan.color_components = 0;
+    bool fixed = true;
+    for (const auto& p : element) {
+        PlyPropertyPlan property;
+        property.type = ply_type(p);
+        property.size = ply_type_size(property.type);
+        property.offset = plan.stride;
+        property.is_list = p.is_list();
+        property.target = PlyTarget::none;
+        property.component = 0;
+
+        const auto& name = p.name();
+        if (is_vertex && !p.is_list()) {
+            if (wanted(PlyTarget::position) &&
+                (name == "x" || name == "y" || name == "z")) {
+                property.target = PlyTarget::position;
+                property.component = name[0] - 'x';
+            }
+            else if (wanted(PlyTarget::normal) &&
+                     (name == "nx" || name == "ny" || name == "nz")) {
+                property.target = PlyTarget::normal;
+                property.component = name[1] - 'x';
+            }
+            else if (wanted(PlyTarget::texcoord) &&
+                     (name == "s" || name == "texture_u")) {
+                property.target = PlyTarget::texcoord;
+            }
+            else if (wanted(PlyTarget::texcoord) &&
+                     (name == "t" || name == "texture_v")) {
+                property.target = PlyTarget::texcoord;
+                property.component = 1;
+            }
+            else if (wanted(PlyTarget::color) &&
+                     (name == "red" || name == "green" || name == "blue" ||
+                      name == "alpha")) {
+                property.target = PlyTarget::color;
+                property.component = plan.color_components++;
+            }
+        }
+        else if (is_face && p.is_list() && wanted(PlyTarget::index) &&
+                 (name == "vertex_index" || name == "vertex_indices")) {
+            property.target = PlyTarget::index;
+        }
+
+        // a face list has a fixed size if it holds VN indices
+        if (!p.is_list()) {
+            plan.stride += property.size;
+        }
+        else if (property.target == PlyTarget::index) {
+            plan.stride += 1 + VN * property.size;
+        }
+        else {
+            fixed = false;
+        }
+        plan.properties.push_back(property);
+    }
+    if (!fixed) {
+        plan.stride = 0;
+    }
+    return plan;
+}
+
+/** Return the set of targets decoded by a plan.*/
+inline unsigned ply_plan_targets(const PlyElementPlan& plan)
+{
+    unsigned targets = 0;
+    for (const auto& p : plan.properties) {
+        if (p.target != PlyTarget::none) {
+            targets |= ply_target_bit(p.target);
+        }
+    }
+    return targets;
+}
+
+/** Decode n instances of an element from an ascii stream.
+ *
+ *  target(property, i, visitor) calls visitor(dst, dst_stride) with the
+ *  destination of the property of the i-th instance, and returns false if the
+ *  property is not decoded.
+ */
+template<int VN, typename Target>
+void read_ply_ascii(const PlyElementPlan& plan,
+                    std::ifstream& stream,
+                    size_t n,
+                    Target target)
+{
+    if (ply_plan_targets(plan) == 0) {
+        // each instance is on its own line
+        for (size_t i = 0; i < n; ++i) {
+            stream >> std::ws;
+            stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        for (const auto& p : plan.properties) {
+            if (p.is_list) {
+                auto count = get_ascii<unsigned>(stream);
+                bool stored = target(p, i, [&](auto dst, size_t) {
+                    using T = std::remove_pointer_t<decltype(dst)>;
+                    check_face_size<VN>(count);
+                    for (int j = 0; j < VN; ++j) {
+                        dst[j] = get_ascii<T>(stream, p.type);
+                    }
+                });
+                for (unsigned j = 0; !stored && j < count; ++j) {
+                    get_ascii<double>(stream, p.type);
+                }
+            }
+            else {
+                bool stored = target(p, i, [&](auto dst, size_t) {
+                    using T = std::remove_pointer_t<decltype(dst)>;
+                    *dst = get_ascii<T>(stream, p.type);
+                });
+                if (!stored) {
+                    get_ascii<double>(stream, p.type);
+                }
+            }
+        }
+    }
+}
+
+/** Decode n instances of an element from a binary stream.
+ *
+ *  Instances of fixed size are read in blocks, and skipped without being read
+ *  if no property is decoded.
+ *
+ *  @sa read_ply_ascii
+ */
+template<int VN, typename Target>
+void read_ply_binary(const PlyElementPlan& plan,
+                     std::ifstream& stream,
+                     bool swap,
+                     size_t n,
+                     std::vector<char>& buffer,
+                     Target target)
+{
+    constexpr const size_t block_size = 1 << 22;
+
+    if (plan.stride != 0 && ply_plan_targets(plan) == 0) {
+        stream.seekg(n * plan.stride, std::ios::cur);
+        return;
+    }
+
+    if (plan.stride != 0) {
+        // read blocks of instances and scatter each property
+        const auto block = std::max<size_t>(1, block_size / plan.stride);
+        for (size_t first = 0; first < n; first += block) {
+            const auto m = std::min(block, n - first);
+            buffer.resize(m * plan.stride);
+            stream.read(buffer.data(), buffer.size());
+            if (!stream) {
+                return;
+            }
+
+            for (const auto& p : plan.properties) {
+                const auto src = buffer.data() + p.offset;
+                target(p, first, [&](auto dst, size_t dst_stride) {
+                    if (!p.is_list) {
+                        scatter_binary(
+                            p.type, src, plan.stride, m, swap, dst, dst_stride);
+                        return;
+                    }
+                    for (size_t i = 0; i < m; ++i) {
+                        check_face_size<VN>(
+                            static_cast<uint8_t>(src[i * plan.stride]));
+                    }
+                    for (int j = 0; j < VN; ++j) {
+                        scatter_binary(p.type,
+                                       src + 1 + j * p.size,
+                                       plan.stride,
+                                       m,
+                                       swap,
+                                       dst + j,
+                                       dst_stride);
+                    }
+                });
+            }
+        }
+        return;
+    }
+
+    // instances with lists of varying sizes are read one by one
+    for (size_t i = 0; i < n; ++i) {
+        for (const auto& p : plan.properties) {
+            size_t count = 1;
+            if (p.is_list) {
+                char byte = 0;
+                stream.get(byte);
+                count = static_cast<uint8_t>(byte);
+            }
+            buffer.resize(count * p.size);
+            stream.read(buffer.data(), buffer.size());
+            if (!stream) {
+                return;
+            }
+
+            target(p, i, [&](auto dst, size_t) {
+                if (p.is_list) {
+                    check_face_size<VN>(static_cast<unsigned>(count));
+                }
+                scatter_binary(
+                    p.type, buffer.data(), p.size, count, swap, dst, 1);
+            });
+        }
+    }
+}
+
+/** Encode n instances of an element into an ascii stream.
+ *
+ *  source(property, i, visitor) calls visitor(src, src_stride) with the
+ *  source of the property of the i-th instance, and returns false if there's
+ *  none, in which case zeros are written. Lines are formatted in parallel.
+ */
+template<int VN, typename Source>
+void write_ply_ascii(const PlyElementPlan& plan,
+                     std::ofstream& stream,
+                     size_t n,
+                     Source source)
+{
+    write_lines(stream, n, [&](size_t i, std::string& line) {
+        for (size_t k = 0; k < plan.properties.size(); ++k) {
+            const auto& p = plan.properties[k];
+            if (k != 0) {
+                line.push_back(' ');
+            }
+            if (p.is_list) {
+                append_number(line, VN);
+            }
+            const int count = p.is_list ? VN : 1;
+            bool stored = source(p, i, [&](auto src, size_t) {
+                for (int j = 0; j < count; ++j) {
+                    if (p.is_list) {
+                        line.push_back(' ');
+                    }
+                    append_ascii(line, p.type, src[j]);
+                }
+            });
+            for (int j = 0; !stored && j < count; ++j) {
+                if (p.is_list) {
+                    line.push_back(' ');
+                }
+                line.push_back('0');
+            }
+        }
+        line.push_back('\n');
+    });
+}
+
+/** Encode n instances of an element into a binary stream.
+ *
+ *  Instances are packed into rows of a buffer in blocks, one property at a
+ *  time, and each block is written at once.
+ *
+ *  @sa write_ply_ascii
+ */
+template<int VN, typename Source>
+void write_ply_binary(const PlyElementPlan& plan,
+                      std::ofstream& stream,
+                      bool swap,
+                      size_t n,
+                      std::vector<char>& buffer,
+                      Source source)
+{
+    constexpr const size_t block_size = 1 << 22;
+
+    if (plan.stride == 0) {
+        throw std::runtime_error("Ply elements of varying sizes can't be "
+                                 "written in bulk");
+    }
+    const auto block = std::max<size_t>(1, block_size / plan.stride);
+    for (size_t first = 0; first < n; first += block) {
+        const auto m = std::min(block, n - first);
+        buffer.assign(m * plan.stride, 0);
+
+        for (const auto& p : plan.properties) {
+            const auto dst = buffer.data() + p.offset;
+            source(p, first, [&](auto src, size_t src_stride) {
+                if (!p.is_list) {
+                    gather_binary(
+                        p.type, src, src_stride, m, swap, dst, plan.stride);
+                    return;
+                }
+                for (size_t i = 0; i < m; ++i) {
+                    dst[i * plan.stride] = static_cast<char>(VN);
+                }
+                for (int j = 0; j < VN; ++j) {
+                    gather_binary(p.type,
+                                  src + j,
+                                  src_stride,
+                                  m,
+                                  swap,
+                                  dst + 1 + j * p.size,
+                                  plan.stride);
+                }
+            });
+        }
+        stream.write(buffer.data(), buffer.size());
+    }
+}
+
 /** Implementation of writing the ply header.*/
 static void write_ply_header(std::ofstream& stream, const PlyHeader& header)
 {
@@ -742,228 +1378,280 @@ template<int VN, typename FloatType, typename IndexType, typename ColorType>
 void CommonPlyReader<VN, FloatType, IndexType, ColorType>::on_read(
     const PlyHeader& header)
 {
+    using _impl::PlyTarget;
+    using _impl::ply_target_bit;
+
+    unsigned targets = ply_target_bit(PlyTarget::position);
+    if (_normals != nullptr) {
+        targets |= ply_target_bit(PlyTarget::normal);
+    }
+    if (_texcoords != nullptr) {
+        targets |= ply_target_bit(PlyTarget::texcoord);
+    }
+    if (_colors != nullptr) {
+        targets |= ply_target_bit(PlyTarget::color);
+    }
+    if (_indices != nullptr) {
+        targets |= ply_target_bit(PlyTarget::index);
+    }
+
+    _plans.clear();
+    _next_plan = 0;
+    _color_components = 0;
     for (const auto& e : header) {
-        if (e.name() == "vertex") {
-            for (size_t i = 0; i < e.n_props();) {
-                if (e.property(i)->name() == "x") {
-                    EASSERT(e.property(i + 1)->name() == "y");
-                    EASSERT(e.property(i + 2)->name() == "z");
-                    _positions.clear();
-                    _positions.reserve(e.count() * 3);
-                    _positions.shrink_to_fit();
-                    i += 3;
-                }
-                else if (_normals != nullptr && e.property(i)->name() == "nx") {
-                    EASSERT(e.property(i + 1)->name() == "ny");
-                    EASSERT(e.property(i + 2)->name() == "nz");
-                    _normals->clear();
-                    _normals->reserve(e.count() * 3);
-                    _normals->shrink_to_fit();
-                    i += 3;
-                }
-                else if (_texcoords != nullptr &&
-                         (e.property(i)->name() == "s" ||
-                          e.property(i)->name() == "texture_u")) {
-                    EASSERT(e.property(i + 1)->name() == "t" ||
-                            e.property(i + 1)->name() == "texture_v");
-                    _texcoords->clear();
-                    _texcoords->reserve(e.count() * 2);
-                    _texcoords->shrink_to_fit();
-                    i += 2;
-                }
-                else {
-                    ++i;
-                }
-            }
+        auto plan = _impl::compile_ply_element<VN>(e, targets);
+
+        // allocate the buffers of the properties found
+        auto found = _impl::ply_plan_targets(plan);
+        if (found & ply_target_bit(PlyTarget::position)) {
+            _positions.assign(e.count() * 3, 0);
+            _positions.shrink_to_fit();
         }
-        else if (e.name() == "face") {
-            for (const auto& p : e) {
-                if (_indices != nullptr && (p.name() == "vertex_index" ||
-                                            p.name() == "vertex_indices")) {
-                    _indices->clear();
-                    _indices->reserve(e.count() * VN);
-                    _indices->shrink_to_fit();
-                }
-            }
+        if (found & ply_target_bit(PlyTarget::normal)) {
+            _normals->assign(e.count() * 3, 0);
+            _normals->shrink_to_fit();
         }
-        else {
-            // Ignore
+        if (found & ply_target_bit(PlyTarget::texcoord)) {
+            _texcoords->assign(e.count() * 2, 0);
+            _texcoords->shrink_to_fit();
+        }
+        if (found & ply_target_bit(PlyTarget::color)) {
+            _color_components = plan.color_components;
+            _colors->assign(e.count() * _color_components, 0);
+            _colors->shrink_to_fit();
         }
+        if (found & ply_target_bit(PlyTarget::index)) {
+            _indices->assign(e.count() * VN, 0);
+            _indices->shrink_to_fit();
+        }
+        _plans.push_back(std::move(plan));
     }
 }
-template<int VN, typename FloatType, typename IndexType, typename ColorType>
-void CommonPlyReader<VN, FloatType, IndexType, ColorType>::read(
-    const PlyDoubleProperty* property,
-    std::ifstream& stream,
-    PlyFormat format)
-{
-    _store_float(property, stream, format);
-}
 
 template<int VN, typename FloatType, typename IndexType, typename ColorType>
-void CommonPlyReader<VN, FloatType, IndexType, ColorType>::read(
-    const PlyFloatProperty* property,
+bool CommonPlyReader<VN, FloatType, IndexType, ColorType>::read_element(
+    const PlyElement&,
     std::ifstream& stream,
     PlyFormat format)
 {
-    _store_float(property, stream, format);
-}
+    if (_next_plan >= _plans.size()) {
+        return false;
+    }
 
-template<int VN, typename FloatType, typename IndexType, typename ColorType>
-void CommonPlyReader<VN, FloatType, IndexType, ColorType>::read(
-    const PlyIntProperty* property,
-    std::ifstream& stream,
-    PlyFormat format)
-{
-    _store_indices(property, stream, format);
+    const auto& plan = _plans[_next_plan++];
+    auto target = [this](const auto& property, size_t i, auto visitor) {
+        return _visit_target(property, i, visitor);
+    };
+    if (format == PlyFormat::ascii) {
+        _impl::read_ply_ascii<VN>(plan, stream, plan.count, target);
+    }
+    else {
+        bool file_little_endian = format == PlyFormat::binary_little_endian;
+        _impl::read_ply_binary<VN>(plan,
+                                   stream,
+                                   file_little_endian != _sys_little_endian,
+                                   plan.count,
+                                   _buffer,
+                                   target);
+    }
+    if (!stream) {
+        throw std::runtime_error("Unexpected end of ply file");
+    }
+    return true;
 }
 
 template<int VN, typename FloatType, typename IndexType, typename ColorType>
-void CommonPlyReader<VN, FloatType, IndexType, ColorType>::read(
-    const PlyUintProperty* property,
-    std::ifstream& stream,
-    PlyFormat format)
-{
-    _store_indices(property, stream, format);
+template<typename Visitor>
+bool CommonPlyReader<VN, FloatType, IndexType, ColorType>::_visit_target(
+    const _impl::PlyPropertyPlan& property,
+    size_t first,
+    Visitor visitor)
+{
+    const auto c = property.component;
+    switch (property.target) {
+    case _impl::PlyTarget::position:
+        visitor(_positions.data() + first * 3 + c, 3);
+        return true;
+    case _impl::PlyTarget::normal:
+        visitor(_normals->data() + first * 3 + c, 3);
+        return true;
+    case _impl::PlyTarget::texcoord:
+        visitor(_texcoords->data() + first * 2 + c, 2);
+        return true;
+    case _impl::PlyTarget::color:
+        visitor(_colors->data() + first * _color_components + c,
+                _color_components);
+        return true;
+    case _impl::PlyTarget::index:
+        visitor(_indices->data() + first * VN, VN);
+        return true;
+    default: return false;
+    }
 }
 
-template<int VN, typename FloatType, typename IndexType, typename ColorType>
-void CommonPlyReader<VN, FloatType, IndexType, ColorType>::read(
-    const PlyUcharProperty* property,
-    std::ifstream& stream,
-    PlyFormat format)
-{
-    _store_color(property, stream, format);
-}
+//-------------------StreamingPlyReader------------------------
 
 template<int VN, typename FloatType, typename IndexType, typename ColorType>
-template<typename TPlyProperty>
-void CommonPlyReader<VN, FloatType, IndexType, ColorType>::_store_float(
-    const TPlyProperty* property,
-    std::ifstream& stream,
-    PlyFormat format)
-{
-    // First read out value then decide what to do with it.
-    // By this way we can safely skip unrecognised properties.
-    FloatType value;
-    if (format == PlyFormat::ascii) {
-        auto v = property->get_ascii(stream);
-        value = static_cast<FloatType>(v);
-    }
-    else {
-        auto v = property->get_binary(stream,
-                                      format == PlyFormat::binary_little_endian,
-                                      _sys_little_endian);
-        value = static_cast<FloatType>(v);
-    }
-
-    if (property->name() == "x" || property->name() == "y" ||
-        property->name() == "z") {
-        _positions.push_back(value);
+StreamingPlyReader<VN, FloatType, IndexType, ColorType>::StreamingPlyReader(
+    Callback on_vertices,
+    Callback on_faces,
+    size_t chunk_size,
+    bool normals,
+    bool texcoords,
+    bool colors)
+    : _on_vertices(std::move(on_vertices)), _on_faces(std::move(on_faces)),
+      _chunk_size(chunk_size)
+{
+    using _impl::PlyTarget;
+    using _impl::ply_target_bit;
+
+    if (chunk_size == 0) {
+        throw std::invalid_argument("Chunk size must be positive.");
     }
-    else if (_normals != nullptr &&
-             (property->name() == "nx" || property->name() == "ny" ||
-              property->name() == "nz")) {
-        _normals->push_back(value);
+    _vertex_targets = ply_target_bit(PlyTarget::position);
+    if (normals) {
+        _vertex_targets |= ply_target_bit(PlyTarget::normal);
     }
-    else if (_texcoords != nullptr &&
-             (property->name() == "s" || property->name() == "texture_u" ||
-              property->name() == "t" || property->name() == "texture_v")) {
-        _texcoords->push_back(value);
+    if (texcoords) {
+        _vertex_targets |= ply_target_bit(PlyTarget::texcoord);
     }
-    else {
-        // Ignore
+    if (colors) {
+        _vertex_targets |= ply_target_bit(PlyTarget::color);
     }
 }
 
 template<int VN, typename FloatType, typename IndexType, typename ColorType>
-template<typename TPlyProperty>
-void CommonPlyReader<VN, FloatType, IndexType, ColorType>::_store_color(
-    const TPlyProperty* property,
-    std::ifstream& stream,
-    PlyFormat format)
+void StreamingPlyReader<VN, FloatType, IndexType, ColorType>::on_read(
+    const PlyHeader& header)
 {
-    ColorType value;
-    if (format == PlyFormat::ascii) {
-        auto v = property->get_ascii(stream);
-        value = static_cast<ColorType>(v);
-    }
-    else {
-        auto v = property->get_binary(stream,
-                                      format == PlyFormat::binary_little_endian,
-                                      _sys_little_endian);
-        value = static_cast<ColorType>(v);
-    }
-
-    if (_colors != nullptr &&
-        (property->name() == "red" || property->name() == "green" ||
-         property->name() == "blue" || property->name() == "alpha")) {
-        _colors->push_back(value);
-    }
-    else {
-        // Ignore
+    _plans.clear();
+    _next_plan = 0;
+    _stopped = false;
+    for (const auto& e : header) {
+        // elements nobody listens to are compiled without any target
+        unsigned targets = 0;
+        if (e.name() == "vertex" && _on_vertices) {
+            targets = _vertex_targets;
+        }
+        else if (e.name() == "face" && _on_faces) {
+            targets = _impl::ply_target_bit(_impl::PlyTarget::index);
+        }
+        _plans.push_back(_impl::compile_ply_element<VN>(e, targets));
     }
 }
 
 template<int VN, typename FloatType, typename IndexType, typename ColorType>
-template<typename TPlyProperty>
-void CommonPlyReader<VN, FloatType, IndexType, ColorType>::_store_indices(
-    const TPlyProperty* property,
+bool StreamingPlyReader<VN, FloatType, IndexType, ColorType>::read_element(
+    const PlyElement& element,
     std::ifstream& stream,
     PlyFormat format)
 {
-    if (property->is_list()) {
-        std::vector<IndexType> values;
-        if (format == PlyFormat::ascii) {
-            unsigned count;
-            stream >> count;
-            if (count != VN) {
-                std::string err_str("Number of vertices per face should be ");
-                err_str.append(std::to_string(VN));
-                err_str.append(", rather than ");
-                err_str.append(std::to_string(count));
-                throw std::runtime_error(err_str);
-            }
+    using _impl::PlyTarget;
+    using _impl::ply_target_bit;
 
-            values.resize(count);
-            for (size_t i = 0; i < count; ++i) {
-                auto v = property->get_ascii(stream);
-                values[i] = static_cast<IndexType>(v);
-            }
+    if (_next_plan >= _plans.size()) {
+        return false;
+    }
+    const auto& plan = _plans[_next_plan++];
+    if (_stopped) {
+        return true;
+    }
+
+    const bool swap = format != PlyFormat::ascii &&
+                      (format == PlyFormat::binary_little_endian) !=
+                          _sys_little_endian;
+    auto target = [this](const auto& property, size_t i, auto visitor) {
+        return _visit_target(property, i, visitor);
+    };
+    auto read = [&](size_t n) {
+        if (format == PlyFormat::ascii) {
+            _impl::read_ply_ascii<VN>(plan, stream, n, target);
         }
         else {
-            char byte;
-            stream.get(byte);
-            auto count = static_cast<unsigned>(byte);
-            if (count != VN) {
-                std::string err_str("Number of vertices per face should be ");
-                err_str.append(std::to_string(VN));
-                err_str.append(", rather than ");
-                err_str.append(std::to_string(count));
-                throw std::runtime_error(err_str);
-            }
-
-            values.resize(count);
-            for (size_t i = 0; i < count; ++i) {
-                auto v = property->get_binary(
-                    stream,
-                    format == PlyFormat::binary_little_endian,
-                    _sys_little_endian);
-                values[i] = static_cast<IndexType>(v);
-            }
+            _impl::read_ply_binary<VN>(plan, stream, swap, n, _buffer, target);
+        }
+        if (!stream) {
+            throw std::runtime_error("Unexpected end of ply file");
         }
+    };
 
-        if (_indices != nullptr && (property->name() == "vertex_index" ||
-                                    property->name() == "vertex_indices")) {
-            std::copy(
-                values.begin(), values.end(), std::back_inserter(*_indices));
+    const auto targets = _impl::ply_plan_targets(plan);
+    const auto& callback = element.name() == "face" ? _on_faces : _on_vertices;
+    if (targets == 0) {
+        read(plan.count);
+        return true;
+    }
+
+    // the chunk only exposes the buffers of the properties found
+    _color_components = plan.color_components;
+    Chunk chunk;
+    chunk.color_components = _color_components;
+    chunk.positions =
+        targets & ply_target_bit(PlyTarget::position) ? &_positions : nullptr;
+    chunk.normals =
+        targets & ply_target_bit(PlyTarget::normal) ? &_normals : nullptr;
+    chunk.texcoords =
+        targets & ply_target_bit(PlyTarget::texcoord) ? &_texcoords : nullptr;
+    chunk.colors =
+        targets & ply_target_bit(PlyTarget::color) ? &_colors : nullptr;
+    chunk.indices =
+        targets & ply_target_bit(PlyTarget::index) ? &_indices : nullptr;
+
+    for (size_t first = 0; first < plan.count; first += _chunk_size) {
+        const auto n = std::min(_chunk_size, plan.count - first);
+        if (chunk.positions != nullptr) {
+            _positions.assign(n * 3, 0);
         }
-        else {
-            // Ignore
+        if (chunk.normals != nullptr) {
+            _normals.assign(n * 3, 0);
+        }
+        if (chunk.texcoords != nullptr) {
+            _texcoords.assign(n * 2, 0);
+        }
+        if (chunk.colors != nullptr) {
+            _colors.assign(n * _color_components, 0);
+        }
+        if (chunk.indices != nullptr) {
+            _indices.assign(n * VN, 0);
+        }
+        read(n);
+
+        chunk.first = first;
+        chunk.count = n;
+        if (!callback(chunk)) {
+            _stopped = true;
+            break;
         }
     }
-    else {
-        // Ignore
+    return true;
+}
+
+template<int VN, typename FloatType, typename IndexType, typename ColorType>
+template<typename Visitor>
+bool StreamingPlyReader<VN, FloatType, IndexType, ColorType>::_visit_target(
+    const _impl::PlyPropertyPlan& property,
+    size_t first,
+    Visitor visitor)
+{
+    const auto c = property.component;
+    switch (property.target) {
+    case _impl::PlyTarget::position:
+        visitor(_positions.data() + first * 3 + c, 3);
+        return true;
+    case _impl::PlyTarget::normal:
+        visitor(_normals.data() + first * 3 + c, 3);
+        return true;
+    case _impl::PlyTarget::texcoord:
+        visitor(_texcoords.data() + first * 2 + c, 2);
+        return true;
+    case _impl::PlyTarget::color:
+        visitor(_colors.data() + first * _color_components + c,
+                _color_components);
+        return true;
+    case _impl::PlyTarget::index:
+        visitor(_indices.data() + first * VN, VN);
+        return true;
+    default: return false;
     }
 }
 
@@ -1020,6 +1708,51 @@ PlyHeader CommonPlyWriter<VN, FloatType, IndexType, ColorType>::generate_header(
     return header;
 }
 
+template<int VN, typename FloatType, typename IndexType, typename ColorType>
+bool CommonPlyWriter<VN, FloatType, IndexType, ColorType>::write_element(
+    const PlyElement& element,
+    std::ofstream& stream,
+    PlyFormat format)
+{
+    using _impl::PlyTarget;
+    using _impl::ply_target_bit;
+
+    unsigned targets = ply_target_bit(PlyTarget::position);
+    if (_normals != nullptr) {
+        targets |= ply_target_bit(PlyTarget::normal);
+    }
+    if (_texcoords != nullptr) {
+        targets |= ply_target_bit(PlyTarget::texcoord);
+    }
+    if (_colors != nullptr) {
+        targets |= ply_target_bit(PlyTarget::color);
+    }
+    if (_indices != nullptr) {
+        targets |= ply_target_bit(PlyTarget::index);
+    }
+    auto plan = _impl::compile_ply_element<VN>(element, targets);
+
+    auto source = [this](const auto& property, size_t i, auto visitor) {
+        return _visit_source(property, i, visitor);
+    };
+    if (format == PlyFormat::ascii) {
+        _impl::write_ply_ascii<VN>(plan, stream, plan.count, source);
+    }
+    else if (plan.stride != 0) {
+        bool file_little_endian = format == PlyFormat::binary_little_endian;
+        _impl::write_ply_binary<VN>(plan,
+                                    stream,
+                                    file_little_endian != _sys_little_endian,
+                                    plan.count,
+                                    _buffer,
+                                    source);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
 template<int VN, typename FloatType, typename IndexType, typename ColorType>
 void CommonPlyWriter<VN, FloatType, IndexType, ColorType>::write(
     const PlyDoubleProperty* property,
@@ -1174,6 +1907,199 @@ void CommonPlyWriter<VN, FloatType, IndexType, ColorType>::_write_indices(
     }
 }
 
+template<int VN, typename FloatType, typename IndexType, typename ColorType>
+template<typename Visitor>
+bool CommonPlyWriter<VN, FloatType, IndexType, ColorType>::_visit_source(
+    const _impl::PlyPropertyPlan& property,
+    size_t first,
+    Visitor visitor) const
+{
+    const auto c = property.component;
+    const auto colors = _has_alpha ? 4 : 3;
+    switch (property.target) {
+    case _impl::PlyTarget::position:
+        visitor(_positions.data() + first * 3 + c, 3);
+        return true;
+    case _impl::PlyTarget::normal:
+        visitor(_normals->data() + first * 3 + c, 3);
+        return true;
+    case _impl::PlyTarget::texcoord:
+        visitor(_texcoords->data() + first * 2 + c, 2);
+        return true;
+    case _impl::PlyTarget::color:
+        visitor(_colors->data() + first * colors + c, colors);
+        return true;
+    case _impl::PlyTarget::index:
+        visitor(_indices->data() + first * VN, VN);
+        return true;
+    default: return false;
+    }
+}
+
+//-------------------MappedPly------------------------
+
+inline MappedPly::MappedPly(const std::string& filename)
+    : _file(std::make_unique<_impl::MappedFile>(filename)),
+      _data(_file->data()), _size(_file->size()), _header(PlyFormat::ascii)
+{
+    // the body starts right after the line of end_header
+    std::string_view text(_data, _size);
+    auto end = text.find("end_header");
+    if (end != std::string_view::npos) {
+        end = text.find('\n', end);
+    }
+    if (end == std::string_view::npos) {
+        throw std::runtime_error("Bad ply file");
+    }
+    _body = end + 1;
+    std::istringstream stream(std::string(_data, _body));
+    _header = _impl::read_ply_header(stream);
+}
+
+inline MappedPly::~MappedPly() = default;
+
+inline MappedPly::MappedPly(MappedPly&& rhs) noexcept
+    : _header(PlyFormat::ascii)
+{
+    *this = std::move(rhs);
+}
+
+inline MappedPly& MappedPly::operator=(MappedPly&& rhs) noexcept
+{
+    std::swap(_data, rhs._data);
+    std::swap(_size, rhs._size);
+    std::swap(_body, rhs._body);
+    std::swap(_header, rhs._header);
+    std::swap(_file, rhs._file);
+    return *this;
+}
+
+template<typename FloatType>
+PlyView<FloatType, 3> MappedPly::positions() const
+{
+    return _view<FloatType, 3>("vertex", { "x", "y", "z" });
+}
+
+template<typename FloatType>
+PlyView<FloatType, 3> MappedPly::normals() const
+{
+    return _view<FloatType, 3>("vertex", { "nx", "ny", "nz" });
+}
+
+template<int VN, typename IndexType>
+PlyView<IndexType, VN> MappedPly::indices() const
+{
+    size_t offset, stride;
+    auto element = _locate("face", VN, offset, stride);
+    if (element == nullptr || element->count() == 0) {
+        return PlyView<IndexType, VN>();
+    }
+
+    size_t pos = 0;
+    for (const auto& p : *element) {
+        auto type = _impl::ply_type(p);
+        auto size = _impl::ply_type_size(type);
+        if (!p.is_list()) {
+            pos += size;
+            continue;
+        }
+
+        // a wrong VN shows up as a wrong count in the first face
+        auto first = _data + offset + pos;
+        if (!_impl::ply_type_matches<IndexType>(type) ||
+            offset + pos >= _size || static_cast<uint8_t>(*first) != VN) {
+            return PlyView<IndexType, VN>();
+        }
+        _check_bounds(offset + element->count() * stride);
+        auto last = first + (element->count() - 1) * stride;
+        if (static_cast<uint8_t>(*last) != VN) {
+            return PlyView<IndexType, VN>();
+        }
+        return PlyView<IndexType, VN>(first + 1, element->count(), stride);
+    }
+    return PlyView<IndexType, VN>();
+}
+
+inline const PlyElement* MappedPly::_locate(const std::string& name,
+                                            int vn,
+                                            size_t& offset,
+                                            size_t& stride) const
+{
+    if (_header.format() != PlyFormat::binary_little_endian ||
+        !_impl::sys_little_endian()) {
+        return nullptr;
+    }
+
+    // elements before the requested one must have fixed size instances too
+    offset = _body;
+    for (const auto& e : _header) {
+        stride = 0;
+        bool fixed = true;
+        for (const auto& p : e) {
+            auto size = _impl::ply_type_size(_impl::ply_type(p));
+            if (!p.is_list()) {
+                stride += size;
+            }
+            else if (vn > 0 && e.name() == "face" &&
+                     (p.name() == "vertex_index" ||
+                      p.name() == "vertex_indices")) {
+                stride += 1 + vn * size;
+            }
+            else {
+                fixed = false;
+            }
+        }
+        if (e.name() == name) {
+            return fixed ? &e : nullptr;
+        }
+        if (!fixed) {
+            return nullptr;
+        }
+        offset += e.count() * stride;
+    }
+    return nullptr;
+}
+
+template<typename T, int N>
+PlyView<T, N> MappedPly::_view(const std::string& element,
+                               const std::array<const char*, N>& names) const
+{
+    size_t offset, stride;
+    auto e = _locate(element, 0, offset, stride);
+    if (e == nullptr || e->count() == 0) {
+        return PlyView<T, N>();
+    }
+    _check_bounds(offset + e->count() * stride);
+
+    // the values should be consecutive and of type T
+    size_t pos = 0;
+    size_t first = 0;
+    int found = 0;
+    for (const auto& p : *e) {
+        auto type = _impl::ply_type(p);
+        if (found < N && p.name() == names[found] &&
+            _impl::ply_type_matches<T>(type) &&
+            (found == 0 || pos == first + found * sizeof(T))) {
+            if (found == 0) {
+                first = pos;
+            }
+            ++found;
+        }
+        pos += _impl::ply_type_size(type);
+    }
+    if (found != N) {
+        return PlyView<T, N>();
+    }
+    return PlyView<T, N>(_data + offset + first, e->count(), stride);
+}
+
+inline void MappedPly::_check_bounds(size_t end) const
+{
+    if (end > _size) {
+        throw std::runtime_error("Unexpected end of ply file");
+    }
+}
+
 //----------------Free Functions-------------------
 
 inline PlyHeader read_ply_header(const std::string& filename)
@@ -1209,6 +2135,9 @@ inline void read_ply(const std::string& filename, PlyReader& reader)
     }
 
     for (const auto& elem : header) {
+        if (reader.read_element(elem, stream, header.format())) {
+            continue;
+        }
         for (size_t i = 0; i < elem.count(); ++i) {
             for (const auto& prop : elem) {
                 prop.apply(reader, stream, header.format());
@@ -1290,6 +2219,9 @@ inline void write_ply(const std::string& filename,
     }
 
     for (const auto& elem : header) {
+        if (writer.write_element(elem, stream, format)) {
+            continue;
+        }
         for (size_t i = 0; i < elem.count(); ++i) {
             for (size_t j = 0; j < elem.n_props(); ++j) {
                 const auto prop = elem.property(j);
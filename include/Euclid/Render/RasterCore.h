@@ -0,0 +1,364 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <boost/math/constants/constants.hpp>
+#include <Euclid/Render/RenderCore.h>
+
+namespace Euclid
+{
+/**@{ @ingroup PkgRasterizer*/
+
+/** A camera model used for rasterization.
+ *
+ */
+class RasCamera : public Camera
+{
+public:
+    /** Create a RasCamera.
+     *
+     */
+    RasCamera() = default;
+
+    /** Create a RasCamera.
+     *
+     *  @param position Position.
+     *  @param focus Focus.
+     *  @param up Rough up direction.
+     *  @param tnear The near clipping plane.
+     *  @param tfar The far clipping plane.
+     */
+    RasCamera(const Eigen::Vector3f& position,
+              const Eigen::Vector3f& focus,
+              const Eigen::Vector3f& up,
+              float tnear,
+              float tfar);
+
+    virtual ~RasCamera();
+
+    /** Return the view/lookat matrix.
+     *
+     */
+    Eigen::Matrix4f view() const;
+
+    /** Return the projection matrix.
+     *
+     */
+    virtual Eigen::Matrix4f projection() const = 0;
+};
+
+/** A RasCamera using perspective projection.
+ *
+ *  The range of visible frustum of a perspective camera is determined
+ *  by the field of view and aspect ratio.
+ */
+class PerspRasCamera : public RasCamera
+{
+public:
+    /** Create a PerspRasCamera using default parameters.
+     *
+     */
+    PerspRasCamera() : RasCamera(){};
+
+    /** Create a PerspRasCamera.
+     *
+     *  In addition to camera position and orientation, a perspective camera
+     *  uses field of view and apsect ratio to determine the extent of the
+     *  film plane.
+     *
+     *  @param position Position.
+     *  @param focus Focus.
+     *  @param up Rough up direction.
+     *  @param vfov Vertical field of view in degrees.
+     *  @param aspect Aspect ratio.
+     *  @param tnear Near plane of the view frustum.
+     *  @param tfar Far plane of the view frustum.
+     */
+    PerspRasCamera(const Eigen::Vector3f& position,
+                   const Eigen::Vector3f& focus,
+                   const Eigen::Vector3f& up,
+                   float vfov,
+                   float aspect,
+                   float tnear,
+                   float tfar);
+
+    /** Create a PerspRasCamera.
+     *
+     *  In addition to camera position and orientation, a perspective camera
+     *  uses field of view and apsect ratio to determine the extent of the
+     *  film plane.
+     *
+     *  @param position Position.
+     *  @param focus Focus.
+     *  @param up Rough up direction.
+     *  @param vfov Vertical field of view in degrees.
+     *  @param width Width of the image.
+     *  @param height Height of the image.
+     *  @param tnear Near plane of the view frustum.
+     *  @param tfar Far plane of the view frustum.
+     */
+    PerspRasCamera(const Eigen::Vector3f& position,
+                   const Eigen::Vector3f& focus,
+                   const Eigen::Vector3f& up,
+                   float vfov,
+                   unsigned width,
+                   unsigned height,
+                   float tnear,
+                   float tfar);
+
+    ~PerspRasCamera();
+
+    /** Set aspect ratio.
+     *
+     */
+    void set_aspect(float aspect);
+
+    /** Set aspect ratio.
+     *
+     */
+    void set_aspect(unsigned width, unsigned height);
+
+    /** Set vertical fov in degrees.
+     *
+     */
+    void set_fov(float vfov);
+
+    /** Return the projection matrix.
+     *
+     */
+    virtual Eigen::Matrix4f projection() const override;
+
+private:
+    float _vfov = boost::math::float_constants::half_pi;
+    float _aspect = 1.0f;
+};
+
+/** A RasCamera using orthographic projection.
+ *
+ *  The range of visible frustum of an orthographic camera is determined
+ *  by the extent of film plane in world space.
+ */
+class OrthoRasCamera : public RasCamera
+{
+public:
+    /** Create an OrthoRasCamera using default parameters.
+     *
+     */
+    OrthoRasCamera() : RasCamera(){};
+
+    /** Create an OrthoRasCamera.
+     *
+     *  In addition to camera position and orientation, an orthogonal camera
+     *  specifies width and height of the film plane directly.
+     *
+     *  @param position Position.
+     *  @param focus Focus.
+     *  @param up Rough up direction.
+     *  @param xextent Width of the frustum in world space.
+     *  @param yextent Height of the frustum in world space.
+     *  @param tnear Near clip plane.
+     *  @param tfar Far clip plane.
+     */
+    OrthoRasCamera(const Eigen::Vector3f& position,
+                   const Eigen::Vector3f& focus,
+                   const Eigen::Vector3f& up,
+                   float xextent,
+                   float yextent,
+                   float tnear,
+                   float tfar);
+
+    ~OrthoRasCamera();
+
+    /** Set the extent of the frustum.
+     *
+     */
+    void set_extent(float xextent, float yextent);
+
+    /** Return the projection matrix.
+     *
+     */
+    virtual Eigen::Matrix4f projection() const override;
+
+private:
+    float _xextent;
+    float _yextent;
+};
+
+/** The interface shared by all rasterizer backends.
+ *
+ *  Code written against this interface could switch between the Vulkan
+ *  Rasterizer and the CPU SoftRasterizer at runtime.
+ *
+ *  @sa Rasterizer, SoftRasterizer
+ */
+class RasterizerBase
+{
+public:
+    enum SampleCount
+    {
+        SAMPLE_COUNT_1 = 0x00000001,
+        SAMPLE_COUNT_2 = 0x00000002,
+        SAMPLE_COUNT_4 = 0x00000004,
+        SAMPLE_COUNT_8 = 0x00000008,
+    };
+
+public:
+    virtual ~RasterizerBase();
+
+    /** Attach a position buffer to the rasterizer.
+     *
+     *  User should at least provide this buffer for the rasterizer to render
+     *  anything. The size of the position buffer determines how many vertices
+     *  are drawn.
+     *
+     *  @param positions An array storing [x,y,z,x,y,z...] coordinates for each
+     *  point. Set position to nullptr to release the current buffer.
+     *  @param size The size of the buffer.
+     */
+    virtual void attach_position_buffer(const float* positions,
+                                        size_t size) = 0;
+
+    /** Attach a normal buffer to the rasterizer.
+     *
+     *  Normal buffer is requested in render_shaded.
+     *
+     *  @param normals An array storing [x,y,z,x,y,z...] coordinates for each
+     *  point. Set normal to nullptr to release the current buffer.
+     *  @param size The size of the buffer.
+     */
+    virtual void attach_normal_buffer(const float* normals, size_t size) = 0;
+
+    /** Attach a color buffer to the rasterizer.
+     *
+     *  If color buffer is provided, the rasterizer will use this buffer in
+     *  the render_shaded and render_unlit functions. Otherwise, it will use the
+     *  colors provided in the material.
+     *
+     *  @param colors An array storing [r,g,b,r,g,b...] colors for each point.
+     *  The values range in [0 1]. Set colors to nullptr to release the current
+     *  buffer and fall back to the material.
+     *  @param size The size of the buffer.
+     */
+    virtual void attach_color_buffer(const float* colors, size_t size) = 0;
+
+    /** Attach an index buffer to the Rasterizer.
+     *
+     *  If index buffer is provided, the rasterizer will use indexed drawing
+     *  mode. Otherwise, it will use plain drawing mode.
+     *
+     *  @param indices An array storing [v1,v2,v3,v1,v2,v3...] indices for each
+     *  triangle. Set indices to nullptr to release the current buffer and
+     *  fall back to plain drawing mode.
+     *  @param size The size of the buffer.
+     */
+    virtual void attach_index_buffer(const unsigned* indices, size_t size) = 0;
+
+    /** Release all associated buffers.
+     *
+     */
+    virtual void release_buffers() = 0;
+
+    /** Change the material of the model.
+     *
+     */
+    virtual void set_material(const Material& material) = 0;
+
+    /** Change the light settings.
+     *
+     */
+    virtual void set_light(const Light& light) = 0;
+
+    /** Change the color of background.
+     *
+     */
+    virtual void set_background(const Eigen::Array3f& color) = 0;
+
+    /** Change the color of background.
+     *
+     */
+    virtual void set_background(float r, float g, float b) = 0;
+
+    /** Set the size and sampling of the resulting image.
+     *
+     */
+    virtual void set_image(uint32_t width,
+                           uint32_t height,
+                           SampleCount samples) = 0;
+
+    /** Render the mesh into a shaded image.
+     *
+     *  This function renders the mesh with simple lambertian shading, using a
+     *  point light located at the camera position.
+     *
+     *  @param model The model matrix.
+     *  @param camera Camera.
+     *  @param pixels Output pixels
+     *  @param interleaved If true, pixels are stored like [RGBRGBRGB...],
+     *  otherwise pixels are stored like [RRR...GGG...BBB...].
+     */
+    virtual void render_shaded(const Eigen::Matrix4f& model,
+                               const RasCamera& camera,
+                               std::vector<uint8_t>& pixels,
+                               bool interleaved = true) = 0;
+
+    /** Render the mesh into a unlit image.
+     *
+     *  Only show raw diffuse color or vertex color if provided.
+     *
+     *  @param model The model matrix.
+     *  @param camera Camera.
+     *  @param pixels Output pixels.
+     *  @param interleaved If true, pixels are stored like [RGBRGBRGB...],
+     *  otherwise pixels are stored like [RRR...GGG...BBB...].
+     */
+    virtual void render_unlit(const Eigen::Matrix4f& model,
+                              const RasCamera& camera,
+                              std::vector<uint8_t>& pixels,
+                              bool interleaved = true) = 0;
+
+    /** Render the mesh into a depth image.
+     *
+     *  The minimum depth value is mapped to 255 in image, and the maximum
+     * depth value is mapped to 0.
+     *
+     *  @param model The model matrix.
+     *  @param camera Camera.
+     *  @param pixels Output pixels.
+     *  @param interleaved If true, pixels are stored like [RGBRGBRGB...],
+     *  otherwise pixels are stored like [RRR...GGG...BBB...].
+     *  @param linear If true, return linearized depth value, otherwise
+     * return z value as it is.
+     */
+    virtual void render_depth(const Eigen::Matrix4f& model,
+                              const RasCamera& camera,
+                              std::vector<uint8_t>& pixels,
+                              bool interleaved = true,
+                              bool linear = true) = 0;
+
+    /** Render the mesh into a depth image.
+     *
+     *  The depth values are returned as they are, while the depth of the
+     *  background is one.
+     *
+     *  @param model The model matrix.
+     *  @param camera Camera.
+     *  @param values The depth values.
+     *  @param linear If true, return linearized depth value, otherwise return z
+     *  value as it is.
+     */
+    virtual void render_depth(const Eigen::Matrix4f& model,
+                              const RasCamera& camera,
+                              std::vector<float>& values,
+                              bool linear = true) = 0;
+
+protected:
+    static const Material _default_material;
+
+    static const Light _default_light;
+};
+
+/** @}*/
+} // namespace Euclid
+
+#include "src/RasterCore.cpp"
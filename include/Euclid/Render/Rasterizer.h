@@ -1,213 +1,32 @@
 /** Render mesh using GPU rasterization.
  *
  *  Many times geometry algorithms require analysis on the rendered views.
- *  This package utilizes Vulkan to do headless GPU rendering.
+ *  This package utilizes Vulkan to do headless GPU rendering. A CPU
+ *  implementation of the same interface is provided for machines without a
+ *  suitable GPU.
  *
  *  @defgroup PkgRasterizer Rasterizer
  *  @ingroup PkgRender
  */
 #pragma once
 
+#include <memory>
 #include <vector>
-#include <boost/math/constants/constants.hpp>
 #include <vulkan/vulkan.h>
-#include <Euclid/Render/RenderCore.h>
+#include <Euclid/Render/RasterCore.h>
+#include <Euclid/Render/SoftRasterizer.h>
 #include <config.h>
 
 namespace Euclid
 {
 /** @{*/
 
-/** A camera model used for rasterization.
- *
- */
-class RasCamera : public Camera
-{
-public:
-    /** Create a RasCamera.
-     *
-     */
-    RasCamera() = default;
-
-    /** Create a RasCamera.
-     *
-     *  @param position Position.
-     *  @param focus Focus.
-     *  @param up Rough up direction.
-     *  @param tnear The near clipping plane.
-     *  @param tfar The far clipping plane.
-     */
-    RasCamera(const Eigen::Vector3f& position,
-              const Eigen::Vector3f& focus,
-              const Eigen::Vector3f& up,
-              float tnear,
-              float tfar);
-
-    virtual ~RasCamera();
-
-    /** Return the view/lookat matrix.
-     *
-     */
-    Eigen::Matrix4f view() const;
-
-    /** Return the projection matrix.
-     *
-     */
-    virtual Eigen::Matrix4f projection() const = 0;
-};
-
-/** A RasCamera using perspective projection.
- *
- *  The range of visible frustum of a perspective camera is determined
- *  by the field of view and aspect ratio.
- */
-class PerspRasCamera : public RasCamera
-{
-public:
-    /** Create a PerspRasCamera using default parameters.
-     *
-     */
-    PerspRasCamera() : RasCamera(){};
-
-    /** Create a PerspRasCamera.
-     *
-     *  In addition to camera position and orientation, a perspective camera
-     *  uses field of view and apsect ratio to determine the extent of the
-     *  film plane.
-     *
-     *  @param position Position.
-     *  @param focus Focus.
-     *  @param up Rough up direction.
-     *  @param vfov Vertical field of view in degrees.
-     *  @param aspect Aspect ratio.
-     *  @param tnear Near plane of the view frustum.
-     *  @param tfar Far plane of the view frustum.
-     */
-    PerspRasCamera(const Eigen::Vector3f& position,
-                   const Eigen::Vector3f& focus,
-                   const Eigen::Vector3f& up,
-                   float vfov,
-                   float aspect,
-                   float tnear,
-                   float tfar);
-
-    /** Create a PerspRasCamera.
-     *
-     *  In addition to camera position and orientation, a perspective camera
-     *  uses field of view and apsect ratio to determine the extent of the
-     *  film plane.
-     *
-     *  @param position Position.
-     *  @param focus Focus.
-     *  @param up Rough up direction.
-     *  @param vfov Vertical field of view in degrees.
-     *  @param width Width of the image.
-     *  @param height Height of the image.
-     *  @param tnear Near plane of the view frustum.
-     *  @param tfar Far plane of the view frustum.
-     */
-    PerspRasCamera(const Eigen::Vector3f& position,
-                   const Eigen::Vector3f& focus,
-                   const Eigen::Vector3f& up,
-                   float vfov,
-                   unsigned width,
-                   unsigned height,
-                   float tnear,
-                   float tfar);
-
-    ~PerspRasCamera();
-
-    /** Set aspect ratio.
-     *
-     */
-    void set_aspect(float aspect);
-
-    /** Set aspect ratio.
-     *
-     */
-    void set_aspect(unsigned width, unsigned height);
-
-    /** Set vertical fov in degrees.
-     *
-     */
-    void set_fov(float vfov);
-
-    /** Return the projection matrix.
-     *
-     */
-    virtual Eigen::Matrix4f projection() const override;
-
-private:
-    float _vfov = boost::math::float_constants::half_pi;
-    float _aspect = 1.0f;
-};
-
-/** A RasCamera using orthographic projection.
- *
- *  The range of visible frustum of an orthographic camera is determined
- *  by the extent of film plane in world space.
- */
-class OrthoRasCamera : public RasCamera
-{
-public:
-    /** Create an OrthoRasCamera using default parameters.
-     *
-     */
-    OrthoRasCamera() : RasCamera(){};
-
-    /** Create an OrthoRasCamera.
-     *
-     *  In addition to camera position and orientation, an orthogonal camera
-     *  specifies width and height of the film plane directly.
-     *
-     *  @param position Position.
-     *  @param focus Focus.
-     *  @param up Rough up direction.
-     *  @param xextent Width of the frustum in world space.
-     *  @param yextent Height of the frustum in world space.
-     *  @param tnear Near clip plane.
-     *  @param tfar Far clip plane.
-     */
-    OrthoRasCamera(const Eigen::Vector3f& position,
-                   const Eigen::Vector3f& focus,
-                   const Eigen::Vector3f& up,
-                   float xextent,
-                   float yextent,
-                   float tnear,
-                   float tfar);
-
-    ~OrthoRasCamera();
-
-    /** Set the extent of the frustum.
-     *
-     */
-    void set_extent(float xextent, float yextent);
-
-    /** Return the projection matrix.
-     *
-     */
-    virtual Eigen::Matrix4f projection() const override;
-
-private:
-    float _xextent;
-    float _yextent;
-};
-
 /** A simple rasterizer.
  *
  *  This rasterizer could render several types of images of a triangle mesh.
  */
-class Rasterizer
+class Rasterizer : public RasterizerBase
 {
-public:
-    enum SampleCount
-    {
-        SAMPLE_COUNT_1 = 0x00000001,
-        SAMPLE_COUNT_2 = 0x00000002,
-        SAMPLE_COUNT_4 = 0x00000004,
-        SAMPLE_COUNT_8 = 0x00000008,
-    };
-
 public:
     /** Create a rasterizer.
      *
@@ -219,7 +38,7 @@ public:
                uint32_t height = 256,
                SampleCount samples = SAMPLE_COUNT_1);
 
-    ~Rasterizer();
+    ~Rasterizer() override;
 
     /** Attach a position buffer to the rasterizer.
      *
@@ -231,7 +50,7 @@ public:
      *  point. Set position to nullptr to release the current buffer.
      *  @param size The size of the buffer.
      */
-    void attach_position_buffer(const float* positions, size_t size);
+    void attach_position_buffer(const float* positions, size_t size) override;
 
     /** Attach a normal buffer to the rasterizer.
      *
@@ -241,7 +60,7 @@ public:
      *  point. Set normal to nullptr to release the current buffer.
      *  @param size The size of the buffer.
      */
-    void attach_normal_buffer(const float* normals, size_t size);
+    void attach_normal_buffer(const float* normals, size_t size) override;
 
     /** Attach a color buffer to the rasterizer.
      *
@@ -254,7 +73,7 @@ public:
      *  buffer and fall back to the material.
      *  @param size The size of the buffer.
      */
-    void attach_color_buffer(const float* colors, size_t size);
+    void attach_color_buffer(const float* colors, size_t size) override;
 
     /** Attach an index buffer to the Rasterizer.
      *
@@ -266,37 +85,39 @@ public:
      *  fall back to plain drawing mode.
      *  @param size The size of the buffer.
      */
-    void attach_index_buffer(const unsigned* indices, size_t size);
+    void attach_index_buffer(const unsigned* indices, size_t size) override;
 
     /** Release all associated buffers.
      *
      */
-    void release_buffers();
+    void release_buffers() override;
 
     /** Change the material of the model.
      *
      */
-    void set_material(const Material& material);
+    void set_material(const Material& material) override;
 
     /** Change the light settings.
      *
      */
-    void set_light(const Light& light);
+    void set_light(const Light& light) override;
 
     /** Change the color of background.
      *
      */
-    void set_background(const Eigen::Array3f& color);
+    void set_background(const Eigen::Array3f& color) override;
 
     /** Change the color of background.
      *
      */
-    void set_background(float r, float g, float b);
+    void set_background(float r, float g, float b) override;
 
     /** Set the size and sampling of the resulting image.
      *
      */
-    void set_image(uint32_t width, uint32_t height, SampleCount samples);
+    void set_image(uint32_t width,
+                   uint32_t height,
+                   SampleCount samples) override;
 
     /** Render the mesh into a shaded image.
      *
@@ -312,7 +133,7 @@ public:
     void render_shaded(const Eigen::Matrix4f& model,
                        const RasCamera& camera,
                        std::vector<uint8_t>& pixels,
-                       bool interleaved = true);
+                       bool interleaved = true) override;
 
     /** Render the mesh into a unlit image.
      *
@@ -327,7 +148,7 @@ public:
     void render_unlit(const Eigen::Matrix4f& model,
                       const RasCamera& camera,
                       std::vector<uint8_t>& pixels,
-                      bool interleaved = true);
+                      bool interleaved = true) override;
 
     /** Render the mesh into a depth image.
      *
@@ -346,7 +167,7 @@ public:
                       const RasCamera& camera,
                       std::vector<uint8_t>& pixels,
                       bool interleaved = true,
-                      bool linear = true);
+                      bool linear = true) override;
 
     /** Render the mesh into a depth image.
      *
@@ -362,7 +183,7 @@ public:
     void render_depth(const Eigen::Matrix4f& model,
                       const RasCamera& camera,
                       std::vector<float>& values,
-                      bool linear = true);
+                      bool linear = true) override;
 
 private:
     enum ShaderType : int
@@ -448,11 +269,6 @@ private:
                      uint32_t binding,
                      ShaderType shader);
 
-private:
-    static const Material _default_material;
-
-    static const Light _default_light;
-
 private:
     Material _material;
     Light _light;
@@ -510,6 +326,35 @@ private:
     std::vector<VkShaderModule> _shader_modules;
 };
 
+/** The backend used by make_rasterizer.
+ *
+ */
+enum class RasterBackend
+{
+    /** Use Vulkan if a suitable device exists, otherwise fall back to CPU.*/
+    automatic,
+
+    /** Always use the Vulkan Rasterizer.*/
+    vulkan,
+
+    /** Always use the CPU SoftRasterizer.*/
+    software
+};
+
+/** Create a rasterizer using the selected backend.
+ *
+ *  @param backend The backend.
+ *  @param width Width of the image.
+ *  @param height Height of the image.
+ *  @param samples Number of samples per pixel.
+ *  @return The rasterizer.
+ */
+std::unique_ptr<RasterizerBase> make_rasterizer(
+    RasterBackend backend = RasterBackend::automatic,
+    uint32_t width = 256,
+    uint32_t height = 256,
+    RasterizerBase::SampleCount samples = RasterizerBase::SAMPLE_COUNT_1);
+
 /** @}*/
 } // namespace Euclid
 
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <vector>
+
+#include <embree3/rtcore.h>
+
+namespace Euclid
+{
+/**@{ @ingroup PkgRayTracer*/
+
+/** Get an Embree device shared by the whole process.
+ *
+ *  Devices are created on first use, one for each thread configuration, and
+ *  live until the end of the program. Sharing one device avoids paying for its
+ *  creation in every ray tracer, and several thread pools competing for the
+ *  same cores. This function is thread safe.
+ *
+ *  @param threads Set to 0 to use number of hardware threads.
+ *  @return The device, which is owned by the registry and should not be
+ *  released by the caller.
+ */
+RTCDevice shared_device(int threads = 0);
+
+/** BVH build quality of a RayScene.
+ *
+ */
+enum class BuildQuality
+{
+    /** Fast build and slower traversal.*/
+    low,
+
+    /** Balanced build and traversal, the default.*/
+    medium,
+
+    /** Slow build and faster traversal.*/
+    high,
+
+    /** Build the BVH once, then only refit it when the positions are updated.
+     *
+     *  Suits deforming meshes with fixed connectivity, where a per frame
+     *  rebuild costs more than the slower traversal of a refitted BVH.
+     */
+    refit
+};
+
+/** A triangle mesh scene for ray tracing.
+ *
+ *  A RayScene owns the BVH of a triangle mesh, built on a shared device. It is
+ *  meant to be shared through std::shared_ptr, so that several RayTracer
+ *  instances and algorithms could render the same committed BVH
+ *  concurrently, without building it again. The scene should not be modified
+ *  while it is being rendered.
+ */
+class RayScene
+{
+public:
+    /** Create an empty scene.
+     *
+     *  @param threads Set to 0 to use number of hardware threads.
+     */
+    explicit RayScene(int threads = 0);
+
+    /** Create a scene and attach geometry buffers to it.
+     *
+     *  @param positions The geometry's positions buffer.
+     *  @param indices The geometry's indices buffer.
+     *  @param threads Set to 0 to use number of hardware threads.
+     *
+     *  @sa attach_geometry_buffers()
+     */
+    RayScene(const std::vector<float>& positions,
+             const std::vector<unsigned>& indices,
+             int threads = 0);
+
+    RayScene(const RayScene&) = delete;
+
+    RayScene& operator=(const RayScene&) = delete;
+
+    ~RayScene();
+
+    /** Attach shared geoemtry buffers to the scene and build the BVH.
+     *
+     *  These buffers are mapped directly by the scene so their lifetime
+     *  should outlive the end of rendering. Attaching another geometry will
+     *  automatically release the previous one.
+     *
+     *  **Note**
+     *
+     *  The user is responsible of padding the positions buffer with one more
+     *  float for Embree's SSE instructions to work correctly.
+     *
+     *  @param positions The geometry's positions buffer.
+     *  @param indices The geometry's indices buffer.
+     */
+    void attach_geometry_buffers(const std::vector<float>& positions,
+                                 const std::vector<unsigned>& indices);
+
+    /** Update the positions of the attached geometry.
+     *
+     *  The connectivity is kept, and the BVH is either rebuilt or refitted
+     *  depending on the build quality. The new positions could be the
+     *  attached buffer modified in place, or another buffer with the same
+     *  size and padding, which is then mapped instead of the previous one.
+     *
+     *  @param positions The new positions buffer.
+     */
+    void update_positions(const std::vector<float>& positions);
+
+    /** Release the attached geometry.
+     *
+     */
+    void release_buffers();
+
+    /** Change the BVH build quality.
+     *
+     *  The attached geometry, if any, is rebuilt with the new settings.
+     *
+     *  @param quality The build quality.
+     *  @param compact If true, use a more compact BVH which saves memory at
+     *  the cost of slightly slower traversal.
+     */
+    void set_build_quality(BuildQuality quality, bool compact = false);
+
+    /** The BVH build quality.
+     *
+     */
+    BuildQuality build_quality() const;
+
+    /** Return true if the BVH is compact.
+     *
+     */
+    bool compact() const;
+
+    /** Return true if no geometry is attached.
+     *
+     */
+    bool empty() const;
+
+    /** The Embree device.
+     *
+     */
+    RTCDevice device() const;
+
+    /** The committed Embree scene.
+     *
+     */
+    RTCScene scene() const;
+
+    /** The attached positions buffer, nullptr if the scene is empty.
+     *
+     */
+    const std::vector<float>* positions() const;
+
+    /** The attached indices buffer, nullptr if the scene is empty.
+     *
+     */
+    const std::vector<unsigned>* indices() const;
+
+private:
+    void _apply_build_quality();
+
+private:
+    RTCDevice _device;
+    RTCScene _scene;
+    RTCGeometry _geometry = nullptr;
+    unsigned _geom_id = RTC_INVALID_GEOMETRY_ID;
+    const std::vector<float>* _positions = nullptr;
+    const std::vector<unsigned>* _indices = nullptr;
+    BuildQuality _quality = BuildQuality::medium;
+    bool _compact = false;
+};
+
+/** @}*/
+} // namespace Euclid
+
+#include "src/RayScene.cpp"
@@ -9,10 +9,13 @@
 #pragma once
 
 #include <cmath>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <vector>
 
 #include <embree3/rtcore.h>
+#include <Euclid/Render/RayScene.h>
 #include <Euclid/Render/RenderCore.h>
 
 namespace Euclid
@@ -208,9 +211,61 @@ public:
     RTCRayHit gen_ray(float s, float t) const override;
 };
 
+/** Types of images rendered by a RayTracer.
+ *
+ */
+enum class RenderMode
+{
+    /** Face indices, see RayTracer::render_index().*/
+    index,
+
+    /** Depth values, see RayTracer::render_depth().*/
+    depth,
+
+    /** Silhouette, see RayTracer::render_silhouette().*/
+    silhouette,
+
+    /** Lambertian shading, see RayTracer::render_shaded().*/
+    shaded,
+
+    /** Pixel counts of each face, see RayTracer::render_histogram().*/
+    histogram
+};
+
+/** Output channels of RayTracer::render_gbuffer().
+ *
+ *  Each channel points to a caller-provided buffer of width * height elements
+ *  per component, stored bottom up like the other images of RayTracer.
+ *  Multi-component channels are planar, e.g. [xxx...yyy...zzz...]. Leave a
+ *  channel to nullptr to skip it.
+ */
+struct GBuffer
+{
+    /** Depth values, negative for the background.*/
+    float* depth = nullptr;
+
+    /** Face indices starting from 1, 0 for the background.*/
+    uint32_t* face = nullptr;
+
+    /** Barycentric coordinates (u, v) of the hit points, 2 components.*/
+    float* barycentric = nullptr;
+
+    /** Unit geometric normals, 3 components, zero for the background.*/
+    float* normal = nullptr;
+
+    /** Shaded colors in [0, 1], 3 components.*/
+    float* color = nullptr;
+
+    /** Foreground mask, 255 for the mesh and 0 for the background.*/
+    uint8_t* mask = nullptr;
+};
+
 /** A simple ray tracer.
  *
  *  This ray tracer could render several types of images of a triangle mesh.
+ *  The mesh is held by a RayScene, which could be shared with other ray
+ *  tracers, while colors, face masks, material and lighting are specific to
+ *  each ray tracer.
  */
 class RayTracer
 {
@@ -221,6 +276,12 @@ public:
      */
     explicit RayTracer(int threads = 0);
 
+    /** Create a ray tracer rendering a shared scene.
+     *
+     *  @param scene The scene.
+     */
+    explicit RayTracer(std::shared_ptr<RayScene> scene);
+
     ~RayTracer();
 
     /** Attach shared geoemtry buffers to the ray tracer.
@@ -229,7 +290,8 @@ public:
      *  directly by the RayTracer so their lifetime should outlive the end of
      *  rendering. This class can only render one mesh at a time, so attaching
      *  another geometry will automatically release the previously attached
-     *  geometry and all associated buffers.
+     *  geometry and all associated buffers. If the current scene is shared
+     *  with others, a new scene is created so that they are not affected.
      *
      *  **Note**
      *
@@ -249,12 +311,6 @@ public:
      *  lifetime should outlive the end of rendering. Attach another buffer will
      *  automatically release the previously attached one.
      *
-     *  **Note**
-     *
-     *  The user is responsible of padding the positions buffer with one more
-     *  float for Embree's SSE instructions to work correctly, if you are in
-     *  vertex color mode. Otherwise the padding will not be necessary.
-     *
      *  @param colors A color array storing [r,g,b,r,g,b...] values of each
      *  elements. The values range in [0 1]. Set colors to nullptr to disable
      *  color buffering and fall back to the material.
@@ -275,6 +331,40 @@ public:
      */
     void attach_face_mask_buffer(const std::vector<uint8_t>* mask);
 
+    /** Update the positions of the attached geometry.
+     *
+     *  This is much cheaper than attaching the geometry again, especially
+     *  with BuildQuality::refit. Note that the update is visible to all the
+     *  ray tracers sharing the scene.
+     *
+     *  @param positions The new positions buffer.
+     *
+     *  @sa RayScene::update_positions()
+     */
+    void update_positions(const std::vector<float>& positions);
+
+    /** Change the BVH build quality of the scene.
+     *
+     *  @param quality The build quality.
+     *  @param compact If true, use a more compact BVH.
+     *
+     *  @sa RayScene::set_build_quality()
+     */
+    void set_build_quality(BuildQuality quality, bool compact = false);
+
+    /** Render a shared scene.
+     *
+     *  Color and face mask buffers are released.
+     *
+     *  @param scene The scene.
+     */
+    void attach_scene(std::shared_ptr<RayScene> scene);
+
+    /** Return the scene, which could be shared with other ray tracers.
+     *
+     */
+    std::shared_ptr<RayScene> scene() const;
+
     /** Release all associated buffers.
      *
      */
@@ -321,23 +411,31 @@ public:
     /** Render the mesh into a shaded image.
      *
      *  This function renders the mesh with simple lambertian shading, using a
-     *  point light located at the camera position. Random multisampling is
-     *  enabled.
+     *  point light located at the camera position. Multisampling is enabled.
+     *
+     *  Samples of each pixel follow a low discrepancy sequence, randomly
+     *  shifted per pixel by a counter-based hash of the pixel index, so the
+     *  result is deterministic regardless of threading. With adaptive sampling
+     *  enabled, a pixel stops being sampled once the standard error of its
+     *  mean intensity drops below the tolerance.
      *
      *  @param pixels Output pixels
      *  @param camera Camera.
      *  @param width Image width.
      *  @param height Image height.
-     *  @param samples Number of samples per pixel.
+     *  @param samples Maximum number of samples per pixel, must be positive.
      *  @param interleaved If true, pixels are stored like [RGBRGBRGB...],
      *  otherwise pixels are stored like [RRR...GGG...BBB...].
+     *  @param tolerance The tolerance of adaptive sampling, in [0, 1] units
+     *  of intensity. Set to 0 to disable adaptive sampling.
      */
     void render_shaded(std::vector<uint8_t>& pixels,
                        const RayCamera& camera,
                        int width,
                        int height,
                        int samples,
-                       bool interleaved = true);
+                       bool interleaved = true,
+                       float tolerance = 0.0f);
 
     /** Render the mesh into a depth image.
      *
@@ -420,36 +518,228 @@ public:
                       int width,
                       int height);
 
+    /** Count the pixels covered by each face.
+     *
+     *  The result is the histogram of the uint32_t index image, but no image is
+     *  ever written. Each thread accumulates the hits of its tiles into a
+     *  private histogram, and these are summed up at the end. Since cameras
+     *  define the film in world space, passing a smaller width and height
+     *  gives a coarse histogram of the same view at a fraction of the cost.
+     *
+     *  @param counts Output pixel counts, of size number of faces + 1. The
+     *  first bin counts the background, and bin i + 1 counts face i.
+     *  @param camera Camera.
+     *  @param width Image width.
+     *  @param height Image height.
+     */
+    void render_histogram(std::vector<uint32_t>& counts,
+                          const RayCamera& camera,
+                          int width,
+                          int height);
+
+    /** Render several channels of the mesh in one pass.
+     *
+     *  Each primary ray is traced only once, and all the requested channels
+     *  are filled from the same hit. The shaded color is the same as
+     *  render_shaded(), before quantization.
+     *
+     *  @param gbuffer Output channels.
+     *  @param camera Camera.
+     *  @param width Image width.
+     *  @param height Image height.
+     *
+     *  @sa GBuffer
+     */
+    void render_gbuffer(const GBuffer& gbuffer,
+                        const RayCamera& camera,
+                        int width,
+                        int height);
+
+    /** Render a batch of views.
+     *
+     *  Tiles of all the views are scheduled together among threads, so that
+     *  many small images still keep all cores busy. Images are written one
+     *  after another into a caller-provided buffer, each using the same layout
+     *  as its single view counterpart, i.e. 3 * width * height interleaved
+     *  values for shaded and uint8_t index images, number of faces + 1 counts
+     *  for histograms, and width * height values otherwise.
+     *
+     *  @param pixels Output pixels, for RenderMode::index, silhouette and
+     *  shaded.
+     *  @param cameras Cameras of each view.
+     *  @param width Image width.
+     *  @param height Image height.
+     *  @param mode Type of the images.
+     */
+    void render_batch(uint8_t* pixels,
+                      const std::vector<const RayCamera*>& cameras,
+                      int width,
+                      int height,
+                      RenderMode mode);
+
+    /** Render a batch of views.
+     *
+     *  @param indices Output face indices for RenderMode::index, or pixel
+     *  counts for RenderMode::histogram.
+     *  @param cameras Cameras of each view.
+     *  @param width Image width.
+     *  @param height Image height.
+     *  @param mode Type of the images.
+     */
+    void render_batch(uint32_t* indices,
+                      const std::vector<const RayCamera*>& cameras,
+                      int width,
+                      int height,
+                      RenderMode mode);
+
+    /** Render a batch of views.
+     *
+     *  @param values Output depth values, for RenderMode::depth only.
+     *  @param cameras Cameras of each view.
+     *  @param width Image width.
+     *  @param height Image height.
+     *  @param mode Type of the images.
+     */
+    void render_batch(float* values,
+                      const std::vector<const RayCamera*>& cameras,
+                      int width,
+                      int height,
+                      RenderMode mode);
+
 private:
+    using DiffuseColor = std::function<Eigen::Array3f(unsigned, float, float)>;
+
+    /** An intersect context carrying the face mask of this ray tracer.
+     *
+     */
+    struct Context
+    {
+        RTCIntersectContext context;
+        const uint8_t* mask;
+    };
+
+    struct Packet
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+        bool interleaved;
+    };
+
+    /** Use a new scene with the same settings if the scene is shared.
+     *
+     */
+    void _unshare_scene();
+
+    /** Initialize an intersect context.
+     *
+     */
+    void _init_context(Context& context, bool coherent) const;
+
+    /** Filter out the masked faces of a context.
+     *
+     */
+    static void _mask_filter(const RTCFilterFunctionNArguments* args);
+
     /** Select the correct diffuse color function.
      *
      */
-    std::function<Eigen::Array3f(const RTCHit&)> _select_diffuse_color();
+    DiffuseColor _select_diffuse_color();
 
     /** Return diffuse color based on material.
      *
      */
-    Eigen::Array3f _diffuse_material(const RTCHit& hit);
+    Eigen::Array3f _diffuse_material(unsigned primid, float u, float v);
 
     /** Retrun diffuse color based on face color.
      *
      */
-    Eigen::Array3f _diffuse_face_color(const RTCHit& hit);
+    Eigen::Array3f _diffuse_face_color(unsigned primid, float u, float v);
 
     /** Retrun diffuse color based on vertex color.
      *
      */
-    Eigen::Array3f _diffuse_vertex_color(const RTCHit& hit);
+    Eigen::Array3f _diffuse_vertex_color(unsigned primid, float u, float v);
+
+    /** Render several views of the same size and mode.
+     *
+     */
+    template<typename Pixel>
+    void _render_views(Pixel* buffer,
+                       const RayCamera* const* cameras,
+                       int views,
+                       int width,
+                       int height,
+                       RenderMode mode,
+                       bool interleaved);
+
+    /** Count the pixels of each face in several views.
+     *
+     */
+    void _render_histograms(uint32_t* counts,
+                            const RayCamera* const* cameras,
+                            int views,
+                            int width,
+                            int height);
+
+    /** Run a kernel on all the ray packets of several images.
+     *
+     *  The images are split into square tiles which are scheduled dynamically
+     *  among threads, and each tile is traversed packet by packet. The kernel
+     *  is called with the view and the first pixel (x, y) of each packet.
+     */
+    template<typename Kernel>
+    void _for_each_packet(int views, int width, int height, Kernel&& kernel);
+
+    /** Write a traced packet of a view into its image.
+     *
+     */
+    void _write_packet(uint8_t* pixels,
+                       const Packet& target,
+                       RenderMode mode,
+                       const RayCamera& camera,
+                       const RTCRayHit8& rayhit,
+                       const int* valid,
+                       const DiffuseColor& diffuse_color);
+
+    /** Write a traced packet of a view into its image.
+     *
+     */
+    void _write_packet(uint32_t* indices,
+                       const Packet& target,
+                       RenderMode mode,
+                       const RayCamera& camera,
+                       const RTCRayHit8& rayhit,
+                       const int* valid,
+                       const DiffuseColor& diffuse_color);
+
+    /** Write a traced packet of a view into its image.
+     *
+     */
+    void _write_packet(float* values,
+                       const Packet& target,
+                       RenderMode mode,
+                       const RayCamera& camera,
+                       const RTCRayHit8& rayhit,
+                       const int* valid,
+                       const DiffuseColor& diffuse_color);
+
+    /** Shade a packet of primary rays.
+     *
+     *  Colors are stored as [r..., g..., b...].
+     */
+    void _shade_packet(const RTCRayHit8& rayhit,
+                       const DiffuseColor& diffuse_color,
+                       float* colors);
 
 private:
     Material _material;
     Eigen::Array3f _background = Eigen::Array3f::Zero();
-    RTCDevice _device;
-    RTCScene _scene;
-    RTCGeometry _geometry;
+    std::shared_ptr<RayScene> _scene;
+    int _threads;
     const std::vector<float>* _colors = nullptr;
     const std::vector<uint8_t>* _face_mask = nullptr;
-    int _geom_id = -1;
     bool _vertex_color = false;
     bool _lighting = true;
 };
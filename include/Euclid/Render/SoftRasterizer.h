@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <Euclid/Render/RasterCore.h>
+
+namespace Euclid
+{
+/**@{ @ingroup PkgRasterizer*/
+
+/** A rasterizer running on the CPU.
+ *
+ *  SoftRasterizer renders the same images as the Vulkan Rasterizer without
+ *  requiring a GPU. Triangles are clipped, culled and binned into screen
+ *  tiles, then each tile is rasterized by one thread using fixed point edge
+ *  functions, with a coarse depth buffer of 8x8 pixel blocks rejecting
+ *  occluded triangles early. Visible samples store only the face they see, and
+ *  shading is deferred until the tile is resolved, so each pixel is shaded
+ *  once per distinct face covering it. The sample locations of multisampling
+ *  follow the standard Vulkan ones.
+ *
+ *  If no normal buffer is attached, render_shaded falls back to face normals.
+ *
+ *  @sa Rasterizer, make_rasterizer
+ */
+class SoftRasterizer : public RasterizerBase
+{
+public:
+    /** Create a rasterizer.
+     *
+     *  @param width Width of the image.
+     *  @param height Height of the image.
+     *  @param samples Number of samples per pixel.
+     */
+    SoftRasterizer(uint32_t width = 256,
+                   uint32_t height = 256,
+                   SampleCount samples = SAMPLE_COUNT_1);
+
+    ~SoftRasterizer() override;
+
+    /** Attach a position buffer to the rasterizer.
+     *
+     *  The buffer is copied.
+     *
+     *  @sa RasterizerBase::attach_position_buffer
+     */
+    void attach_position_buffer(const float* positions, size_t size) override;
+
+    /** Attach a normal buffer to the rasterizer.
+     *
+     *  @sa RasterizerBase::attach_normal_buffer
+     */
+    void attach_normal_buffer(const float* normals, size_t size) override;
+
+    /** Attach a color buffer to the rasterizer.
+     *
+     *  @sa RasterizerBase::attach_color_buffer
+     */
+    void attach_color_buffer(const float* colors, size_t size) override;
+
+    /** Attach an index buffer to the Rasterizer.
+     *
+     *  @sa RasterizerBase::attach_index_buffer
+     */
+    void attach_index_buffer(const unsigned* indices, size_t size) override;
+
+    /** Release all associated buffers.
+     *
+     */
+    void release_buffers() override;
+
+    /** Change the material of the model.
+     *
+     */
+    void set_material(const Material& material) override;
+
+    /** Change the light settings.
+     *
+     */
+    void set_light(const Light& light) override;
+
+    /** Change the color of background.
+     *
+     */
+    void set_background(const Eigen::Array3f& color) override;
+
+    /** Change the color of background.
+     *
+     */
+    void set_background(float r, float g, float b) override;
+
+    /** Set the size and sampling of the resulting image.
+     *
+     */
+    void set_image(uint32_t width,
+                   uint32_t height,
+                   SampleCount samples) override;
+
+    /** Render the mesh into a shaded image.
+     *
+     *  @sa RasterizerBase::render_shaded
+     */
+    void render_shaded(const Eigen::Matrix4f& model,
+                       const RasCamera& camera,
+                       std::vector<uint8_t>& pixels,
+                       bool interleaved = true) override;
+
+    /** Render the mesh into a unlit image.
+     *
+     *  @sa RasterizerBase::render_unlit
+     */
+    void render_unlit(const Eigen::Matrix4f& model,
+                      const RasCamera& camera,
+                      std::vector<uint8_t>& pixels,
+                      bool interleaved = true) override;
+
+    /** Render the mesh into a depth image.
+     *
+     *  @sa RasterizerBase::render_depth
+     */
+    void render_depth(const Eigen::Matrix4f& model,
+                      const RasCamera& camera,
+                      std::vector<uint8_t>& pixels,
+                      bool interleaved = true,
+                      bool linear = true) override;
+
+    /** Render the mesh into a depth image.
+     *
+     *  @sa RasterizerBase::render_depth
+     */
+    void render_depth(const Eigen::Matrix4f& model,
+                      const RasCamera& camera,
+                      std::vector<float>& values,
+                      bool linear = true) override;
+
+private:
+    /** A screen space triangle set up for rasterization.*/
+    struct Triangle
+    {
+        int32_t x[3];
+        int32_t y[3];
+        float xa;
+        float ya;
+        float za;
+        float dzdx;
+        float dzdy;
+        float zmin;
+        int xmin;
+        int ymin;
+        int xmax;
+        int ymax;
+        uint32_t prim;
+    };
+
+private:
+    template<typename Resolve>
+    void _render(const Eigen::Matrix4f& model,
+                 const RasCamera& camera,
+                 Resolve resolve);
+
+    void _setup_triangle(uint32_t prim,
+                         std::vector<Triangle>& triangles,
+                         std::vector<uint32_t>* bins);
+
+    void _emit_triangle(const Eigen::Vector4f& v0,
+                        const Eigen::Vector4f& v1,
+                        const Eigen::Vector4f& v2,
+                        uint32_t prim,
+                        std::vector<Triangle>& triangles,
+                        std::vector<uint32_t>* bins);
+
+    void _rasterize(const Triangle& triangle, int x0, int y0, int x1, int y1);
+
+    void _clear_tile(int x0, int y0, int x1, int y1);
+
+    Eigen::Array3f _shade(uint32_t prim, int x, int y, bool lit) const;
+
+    void _resolve_color(bool lit,
+                        bool interleaved,
+                        uint8_t* pixels,
+                        int x0,
+                        int y0,
+                        int x1,
+                        int y1) const;
+
+    float _resolve_depth(int x, int y) const;
+
+    uint32_t _vertex(uint32_t prim, int corner) const;
+
+private:
+    Material _material;
+    Light _light;
+    Eigen::Array3f _background = Eigen::Array3f::Zero();
+    uint32_t _width;
+    uint32_t _height;
+    SampleCount _samples;
+    std::vector<float> _positions;
+    std::vector<float> _normals;
+    std::vector<float> _colors;
+    std::vector<unsigned> _indices;
+    Transform _transform;
+    int _tiles_x;
+    int _tiles_y;
+    std::vector<std::vector<Triangle>> _triangles;
+    std::vector<std::vector<uint32_t>> _bins;
+    std::vector<float> _depth;
+    std::vector<uint32_t> _faces;
+    std::vector<float> _block_depth;
+};
+
+/** @}*/
+} // namespace Euclid
+
+#include "src/SoftRasterizer.cpp"
@@ -0,0 +1,78 @@
+/** Bake visibility of a mesh into its vertices or faces.
+ *
+ *  Many analyses need per-element visibility rather than images, e.g. ambient
+ *  occlusion, or how much of the view sphere a face could be seen from. This
+ *  package fires streams of occlusion rays straight from the surface using
+ *  Embree, without rendering any images.
+ *
+ *  @defgroup PkgVisibility Visibility
+ *  @ingroup PkgRender
+ */
+#pragma once
+
+#include <limits>
+#include <vector>
+
+#include <Euclid/Render/RayScene.h>
+
+namespace Euclid
+{
+/** @{*/
+
+/** The mesh elements to bake values into.
+ *
+ */
+enum class BakeElement
+{
+    /** One value per vertex.*/
+    vertex,
+
+    /** One value per face.*/
+    face
+};
+
+/** Compute ambient occlusion.
+ *
+ *  For each element, cosine weighted rays are cast over the hemisphere around
+ *  its normal from the vertex or face centroid, and the fraction of occluded
+ *  rays is recorded. Vertex normals are area weighted averages of the face
+ *  normals. Samples follow a low discrepancy sequence shifted per element, so
+ *  the result is deterministic.
+ *
+ *  @param scene The scene, which should have a geometry attached.
+ *  @param occlusion The output occlusion of each element in [0, 1], 0 means
+ *  fully visible.
+ *  @param element Bake into vertices or faces.
+ *  @param samples Number of rays per element, must be positive.
+ *  @param max_distance Occluders farther than this distance are ignored.
+ */
+template<typename T>
+void ambient_occlusion(
+    const RayScene& scene,
+    std::vector<T>& occlusion,
+    BakeElement element = BakeElement::vertex,
+    int samples = 64,
+    float max_distance = std::numeric_limits<float>::infinity());
+
+/** Compute the visible fraction of the view sphere.
+ *
+ *  For each element, the view directions are sampled uniformly on the unit
+ *  sphere, and a direction sees the element if the element faces it and the
+ *  ray from the element towards it is not blocked, i.e. as seen from an
+ *  orthographic camera on a view sphere at infinity.
+ *
+ *  @param scene The scene, which should have a geometry attached.
+ *  @param visibility The output visible fraction of each element in [0, 1].
+ *  @param element Bake into vertices or faces.
+ *  @param samples Number of view directions, must be positive.
+ */
+template<typename T>
+void view_visibility(const RayScene& scene,
+                     std::vector<T>& visibility,
+                     BakeElement element = BakeElement::face,
+                     int samples = 256);
+
+/** @}*/
+} // namespace Euclid
+
+#include "src/Visibility.cpp"
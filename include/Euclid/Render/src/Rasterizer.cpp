@@ -1,5 +1,7 @@
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 
 namespace Euclid
 {
@@ -64,137 +66,8 @@ static inline VkResult vkCreateRenderPass2KHR(
 
 } // namespace _impl
 
-/********************** RasCamera **********************/
-
-inline RasCamera::RasCamera(const Eigen::Vector3f& position,
-                            const Eigen::Vector3f& focus,
-                            const Eigen::Vector3f& up,
-                            float tnear,
-                            float tfar)
-    : Camera(position, focus, up, tnear, tfar)
-{}
-
-inline RasCamera::~RasCamera() = default;
-
-inline Eigen::Matrix4f RasCamera::view() const
-{
-    Eigen::Matrix4f m1, m2;
-    // clang-format off
-    m1 << u(0), u(1), u(2), 0.0f,
-          v(0), v(1), v(2), 0.0f,
-          dir(0), dir(1), dir(2), 0.0f,
-          0.0f, 0.0f, 0.0f, 1.0f;
-    m2 << 1.0f, 0.0f, 0.0f, -pos(0),
-          0.0f, 1.0f, 0.0f, -pos(1),
-          0.0f, 0.0f, 1.0f, -pos(2),
-          0.0f, 0.0f, 0.0f, 1.0f;
-    // clang-format on
-    return m1 * m2;
-}
-
-inline PerspRasCamera::PerspRasCamera(const Eigen::Vector3f& position,
-                                      const Eigen::Vector3f& focus,
-                                      const Eigen::Vector3f& up,
-                                      float vfov,
-                                      float aspect,
-                                      float tnear,
-                                      float tfar)
-    : RasCamera(position, focus, up, tnear, tfar)
-{
-    _vfov = vfov * boost::math::float_constants::degree;
-    _aspect = aspect;
-}
-
-inline PerspRasCamera::PerspRasCamera(const Eigen::Vector3f& position,
-                                      const Eigen::Vector3f& focus,
-                                      const Eigen::Vector3f& up,
-                                      float vfov,
-                                      unsigned width,
-                                      unsigned height,
-                                      float tnear,
-                                      float tfar)
-    : RasCamera(position, focus, up, tnear, tfar)
-{
-    _vfov = vfov * boost::math::float_constants::degree;
-    _aspect = static_cast<float>(width) / height;
-}
-
-inline PerspRasCamera::~PerspRasCamera() = default;
-
-inline void PerspRasCamera::set_aspect(float aspect)
-{
-    _aspect = aspect;
-}
-
-inline void PerspRasCamera::set_aspect(unsigned width, unsigned height)
-{
-    _aspect = static_cast<float>(width) / height;
-}
-
-inline void PerspRasCamera::set_fov(float vfov)
-{
-    _vfov = vfov * boost::math::float_constants::degree;
-}
-
-inline Eigen::Matrix4f PerspRasCamera::projection() const
-{
-    auto yscale = std::tan(0.5f * _vfov);
-    auto xscale = yscale * _aspect;
-    auto d = 1.0f / (this->tfar - this->tnear);
-
-    Eigen::Matrix4f proj_mat;
-    proj_mat.setZero();
-    proj_mat(0, 0) = 1.0f / xscale;
-    proj_mat(1, 1) = -1.0f / yscale;  // invert y
-    proj_mat(2, 2) = -this->tfar * d; // map z to [0, 1]
-    proj_mat(2, 3) = -this->tfar * this->tnear * d;
-    proj_mat(3, 2) = -1.0f;
-
-    return proj_mat;
-}
-
-inline OrthoRasCamera::OrthoRasCamera(const Eigen::Vector3f& position,
-                                      const Eigen::Vector3f& focus,
-                                      const Eigen::Vector3f& up,
-                                      float xextent,
-                                      float yextent,
-                                      float tnear,
-                                      float tfar)
-    : RasCamera(position, focus, up, tnear, tfar), _xextent(xextent),
-      _yextent(yextent)
-{}
-
-inline OrthoRasCamera::~OrthoRasCamera() = default;
-
-inline void OrthoRasCamera::set_extent(float xextent, float yextent)
-{
-    _xextent = xextent;
-    _yextent = yextent;
-}
-
-inline Eigen::Matrix4f OrthoRasCamera::projection() const
-{
-    Eigen::Matrix4f proj_mat;
-    proj_mat.setZero();
-    proj_mat(0, 0) = 2.0f / _xextent;
-    proj_mat(1, 1) = -2.0f / _yextent;
-    proj_mat(2, 2) = -1.0f / (this->tfar - this->tnear); // invert y
-    proj_mat(2, 3) =
-        -this->tnear / (this->tfar - this->tnear); // map z to [0, 1]
-    proj_mat(3, 3) = 1.0f;
-
-    return proj_mat;
-}
-
 /************************ Rsterizer *************************/
 
-inline const Material Rasterizer::_default_material{ { 0.1f, 0.1f, 0.1f },
-                                                     { 0.7f, 0.7f, 0.7f } };
-
-inline const Light Rasterizer::_default_light{ { 1.0f, 1.0f, 1.0f },
-                                               { 1.0f, 1.0f, 1.0f },
-                                               1.0f };
-
 inline Rasterizer::Rasterizer(uint32_t width,
                               uint32_t height,
                               SampleCount samples)
@@ -1861,4 +1734,24 @@ inline void Rasterizer::_update_ubo(const VkDescriptorBufferInfo& info,
     vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
 }
 
+inline std::unique_ptr<RasterizerBase> make_rasterizer(
+    RasterBackend backend,
+    uint32_t width,
+    uint32_t height,
+    RasterizerBase::SampleCount samples)
+{
+    if (backend == RasterBackend::software) {
+        return std::make_unique<SoftRasterizer>(width, height, samples);
+    }
+    if (backend == RasterBackend::vulkan) {
+        return std::make_unique<Rasterizer>(width, height, samples);
+    }
+    try {
+        return std::make_unique<Rasterizer>(width, height, samples);
+    }
+    catch (const std::runtime_error&) {
+        return std::make_unique<SoftRasterizer>(width, height, samples);
+    }
+}
+
 } // namespace Euclid
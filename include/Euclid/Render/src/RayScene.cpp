@@ -0,0 +1,249 @@
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include <Euclid/Util/Assert.h>
+
+namespace Euclid
+{
+
+namespace _impl
+{
+
+/** Embree devices of the process, indexed by number of threads.*/
+class DeviceRegistry
+{
+public:
+    ~DeviceRegistry()
+    {
+        for (auto& [threads, device] : _devices) {
+            (void)threads;
+            rtcReleaseDevice(device);
+        }
+    }
+
+    RTCDevice get(int threads)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _devices.find(threads);
+        if (it != _devices.end()) { return it->second; }
+
+        std::string cfg("threads=");
+        cfg.append(std::to_string(threads));
+        auto device = rtcNewDevice(cfg.c_str());
+        if (!device) {
+            auto err = rtcGetDeviceError(device);
+            std::string err_str("Embree device creation error: ");
+            err_str.append(std::to_string(err));
+            throw std::runtime_error(err_str);
+        }
+        _devices.emplace(threads, device);
+        return device;
+    }
+
+private:
+    std::mutex _mutex;
+    std::map<int, RTCDevice> _devices;
+};
+
+} // namespace _impl
+
+inline RTCDevice shared_device(int threads)
+{
+    static _impl::DeviceRegistry registry;
+    return registry.get(threads);
+}
+
+inline RayScene::RayScene(int threads)
+{
+    _device = shared_device(threads);
+    rtcRetainDevice(_device);
+
+    _scene = rtcNewScene(_device);
+    if (!_scene) {
+        auto err = rtcGetDeviceError(_device);
+        std::string err_str("Embree scene creation error: ");
+        err_str.append(std::to_string(err));
+        throw std::runtime_error(err_str);
+    }
+    _apply_build_quality();
+}
+
+inline RayScene::RayScene(const std::vector<float>& positions,
+                          const std::vector<unsigned>& indices,
+                          int threads)
+    : RayScene(threads)
+{
+    attach_geometry_buffers(positions, indices);
+}
+
+inline RayScene::~RayScene()
+{
+    release_buffers();
+    rtcReleaseScene(_scene);
+    rtcReleaseDevice(_device);
+}
+
+// TODO: add generic type support
+inline void RayScene::attach_geometry_buffers(
+    const std::vector<float>& positions,
+    const std::vector<unsigned>& indices)
+{
+    if (positions.empty() || indices.empty()) {
+        EWARNING("Input geometry is empty.");
+        return;
+    }
+    if (positions.size() % 3 != 1) {
+        throw std::invalid_argument("The last element of the positions buffer "
+                                    "is not padded to 16 bytes. Add "
+                                    "one more 0.0f to your positions buffer.");
+    }
+    if (indices.size() % 3 != 0) {
+        throw std::invalid_argument("Size of input indices is not divisible by "
+                                    "3, thus not a valid triangle mesh.");
+    }
+
+    release_buffers();
+
+    _geometry = rtcNewGeometry(_device, RTC_GEOMETRY_TYPE_TRIANGLE);
+    _apply_build_quality();
+    rtcSetSharedGeometryBuffer(_geometry,
+                               RTC_BUFFER_TYPE_VERTEX,
+                               0,
+                               RTC_FORMAT_FLOAT3,
+                               positions.data(),
+                               0,
+                               3 * sizeof(float),
+                               positions.size() / 3);
+    rtcSetSharedGeometryBuffer(_geometry,
+                               RTC_BUFFER_TYPE_INDEX,
+                               0,
+                               RTC_FORMAT_UINT3,
+                               indices.data(),
+                               0,
+                               3 * sizeof(unsigned),
+                               indices.size() / 3);
+    rtcCommitGeometry(_geometry);
+    _geom_id = rtcAttachGeometry(_scene, _geometry);
+    rtcCommitScene(_scene);
+    _positions = &positions;
+    _indices = &indices;
+}
+
+inline void RayScene::update_positions(const std::vector<float>& positions)
+{
+    if (empty()) {
+        throw std::runtime_error("No geometry is attached to the scene.");
+    }
+    if (positions.size() != _positions->size()) {
+        throw std::invalid_argument("The number of positions has changed.");
+    }
+
+    if (&positions != _positions) {
+        rtcSetSharedGeometryBuffer(_geometry,
+                                   RTC_BUFFER_TYPE_VERTEX,
+                                   0,
+                                   RTC_FORMAT_FLOAT3,
+                                   positions.data(),
+                                   0,
+                                   3 * sizeof(float),
+                                   positions.size() / 3);
+        _positions = &positions;
+    }
+    rtcUpdateGeometryBuffer(_geometry, RTC_BUFFER_TYPE_VERTEX, 0);
+    rtcCommitGeometry(_geometry);
+    rtcCommitScene(_scene);
+}
+
+inline void RayScene::release_buffers()
+{
+    if (_geom_id != RTC_INVALID_GEOMETRY_ID) {
+        rtcDetachGeometry(_scene, _geom_id);
+        rtcReleaseGeometry(_geometry);
+        rtcCommitScene(_scene);
+        _geom_id = RTC_INVALID_GEOMETRY_ID;
+        _geometry = nullptr;
+        _positions = nullptr;
+        _indices = nullptr;
+    }
+}
+
+inline void RayScene::set_build_quality(BuildQuality quality, bool compact)
+{
+    _quality = quality;
+    _compact = compact;
+    _apply_build_quality();
+    if (!empty()) {
+        rtcCommitGeometry(_geometry);
+        rtcCommitScene(_scene);
+    }
+}
+
+inline BuildQuality RayScene::build_quality() const
+{
+    return _quality;
+}
+
+inline bool RayScene::compact() const
+{
+    return _compact;
+}
+
+inline bool RayScene::empty() const
+{
+    return _geom_id == RTC_INVALID_GEOMETRY_ID;
+}
+
+inline RTCDevice RayScene::device() const
+{
+    return _device;
+}
+
+inline RTCScene RayScene::scene() const
+{
+    return _scene;
+}
+
+inline const std::vector<float>* RayScene::positions() const
+{
+    return _positions;
+}
+
+inline const std::vector<unsigned>* RayScene::indices() const
+{
+    return _indices;
+}
+
+inline void RayScene::_apply_build_quality()
+{
+    // Face masks are applied per ray tracer through the intersect context
+    auto flags = RTC_SCENE_FLAG_CONTEXT_FILTER_FUNCTION;
+    if (_compact) { flags = flags | RTC_SCENE_FLAG_COMPACT; }
+
+    auto scene_quality = RTC_BUILD_QUALITY_MEDIUM;
+    auto geometry_quality = RTC_BUILD_QUALITY_MEDIUM;
+    switch (_quality) {
+    case BuildQuality::low:
+        scene_quality = RTC_BUILD_QUALITY_LOW;
+        geometry_quality = RTC_BUILD_QUALITY_LOW;
+        break;
+    case BuildQuality::medium:
+        break;
+    case BuildQuality::high:
+        scene_quality = RTC_BUILD_QUALITY_HIGH;
+        geometry_quality = RTC_BUILD_QUALITY_HIGH;
+        break;
+    case BuildQuality::refit:
+        flags = flags | RTC_SCENE_FLAG_DYNAMIC;
+        scene_quality = RTC_BUILD_QUALITY_LOW;
+        geometry_quality = RTC_BUILD_QUALITY_REFIT;
+        break;
+    }
+
+    rtcSetSceneFlags(_scene, flags);
+    rtcSetSceneBuildQuality(_scene, scene_quality);
+    if (_geometry) { rtcSetGeometryBuildQuality(_geometry, geometry_quality); }
+}
+
+} // namespace Euclid
@@ -1,7 +1,10 @@
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <string>
-#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 
 #include <boost/math/constants/constants.hpp>
 #include <Euclid/Util/Assert.h>
@@ -12,14 +15,130 @@ namespace Euclid
 namespace _impl
 {
 
-inline void mask_filter(const RTCFilterFunctionNArguments* args)
+/** Width of a ray packet in pixels.*/
+constexpr const int packet_width = 4;
+
+/** Height of a ray packet in pixels.*/
+constexpr const int packet_height = 2;
+
+/** Number of rays in a packet.*/
+constexpr const int packet_size = packet_width * packet_height;
+
+/** Size of the square image tiles scheduled among threads, in pixels.*/
+constexpr const int tile_size = 16;
+
+/** Minimum number of samples per pixel before adaptive sampling stops.*/
+constexpr const int min_adaptive_samples = 4;
+
+/** Generators of the R2 low discrepancy sequence, i.e. 1/g and 1/g^2 where g
+ *  is the plastic number.
+ */
+constexpr const float r2_alpha_x = 0.754877666f;
+constexpr const float r2_alpha_y = 0.569840291f;
+
+/** A counter-based integer hash with low bias.*/
+inline uint32_t hash(uint32_t x)
 {
-    EASSERT(args->N == 1);
-    auto mask = reinterpret_cast<uint8_t*>(args->geometryUserPtr);
-    EASSERT(mask != nullptr);
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+/** A uniform random number in [0, 1) for a pixel and a dimension.*/
+inline float random_float(uint32_t pixel, uint32_t dim)
+{
+    auto h = hash(pixel ^ hash(dim + 0x9e3779b9U));
+    return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+/** Generate a packet of primary rays.
+ *
+ *  The packet covers packet_width x packet_height pixels starting from pixel
+ *  (x, y), lanes falling outside of the image are marked as invalid. The
+ *  optional jitter stores the sub-pixel offsets [dx..., dy...] of each lane.
+ */
+inline void gen_ray_packet(const RayCamera& camera,
+                           int x,
+                           int y,
+                           int width,
+                           int height,
+                           const float* jitter,
+                           int* valid,
+                           RTCRayHit8& rayhit)
+{
+    for (int i = 0; i < packet_size; ++i) {
+        auto px = x + i % packet_width;
+        auto py = y + i / packet_width;
+        valid[i] = (px < width && py < height) ? -1 : 0;
+        auto dx = jitter ? jitter[i] : 0.0f;
+        auto dy = jitter ? jitter[packet_size + i] : 0.0f;
+        auto ray = camera.gen_ray((px + dx) / width, (py + dy) / height);
+        rayhit.ray.org_x[i] = ray.ray.org_x;
+        rayhit.ray.org_y[i] = ray.ray.org_y;
+        rayhit.ray.org_z[i] = ray.ray.org_z;
+        rayhit.ray.dir_x[i] = ray.ray.dir_x;
+        rayhit.ray.dir_y[i] = ray.ray.dir_y;
+        rayhit.ray.dir_z[i] = ray.ray.dir_z;
+        rayhit.ray.tnear[i] = ray.ray.tnear;
+        rayhit.ray.tfar[i] = ray.ray.tfar;
+        rayhit.ray.time[i] = 0.0f;
+        rayhit.ray.mask[i] = 0xFFFFFFFF;
+        rayhit.ray.id[i] = i;
+        rayhit.ray.flags[i] = 0;
+        rayhit.hit.Ng_x[i] = 0.0f;
+        rayhit.hit.Ng_y[i] = 0.0f;
+        rayhit.hit.Ng_z[i] = 0.0f;
+        rayhit.hit.geomID[i] = RTC_INVALID_GEOMETRY_ID;
+        rayhit.hit.instID[0][i] = RTC_INVALID_GEOMETRY_ID;
+    }
+}
+
+/** The pixel index of a packet lane, images are stored bottom up.*/
+inline int lane_pixel(int x, int y, int lane, int width, int height)
+{
+    auto px = x + lane % packet_width;
+    auto py = y + lane / packet_width;
+    return (height - py - 1) * width + px;
+}
+
+/** Call kernel(x, y) with the first pixel of each packet in a tile.*/
+template<typename Kernel>
+void for_each_tile_packet(int tile, int width, int height, Kernel&& kernel)
+{
+    const int tiles_x = (width + tile_size - 1) / tile_size;
+    auto x0 = (tile % tiles_x) * tile_size;
+    auto y0 = (tile / tiles_x) * tile_size;
+    auto x1 = std::min(x0 + tile_size, width);
+    auto y1 = std::min(y0 + tile_size, height);
+    for (int y = y0; y < y1; y += packet_height) {
+        for (int x = x0; x < x1; x += packet_width) {
+            kernel(x, y);
+        }
+    }
+}
 
-    auto primid = RTCHitN_primID(args->hit, 1, 0);
-    if (mask[primid] != 1) { args->valid[0] = 0; }
+/** Clamp and write a packet of colors stored as [r..., g..., b...].*/
+inline void write_color_packet(uint8_t* pixels,
+                               const float* colors,
+                               const int* valid,
+                               int x,
+                               int y,
+                               int width,
+                               int height,
+                               bool interleaved)
+{
+    for (int i = 0; i < packet_size; ++i) {
+        if (valid[i] == 0) { continue; }
+        auto idx = lane_pixel(x, y, i, width, height);
+        for (int c = 0; c < 3; ++c) {
+            auto value = std::min(colors[c * packet_size + i], 1.0f) * 255;
+            auto offset = interleaved ? 3 * idx + c : c * width * height + idx;
+            pixels[offset] = static_cast<uint8_t>(value);
+        }
+    }
 }
 
 } // namespace _impl
@@ -144,77 +263,30 @@ inline RTCRayHit OrthoRayCamera::gen_ray(float s, float t) const
 }
 
 inline RayTracer::RayTracer(int threads)
+    : _scene(std::make_shared<RayScene>(threads)), _threads(threads)
 {
-    std::string cfg("threads=");
-    cfg.append(std::to_string(threads));
-    _device = rtcNewDevice(cfg.c_str());
-    if (!_device) {
-        auto err = rtcGetDeviceError(_device);
-        std::string err_str("Embree device creation error: ");
-        err_str.append(std::to_string(err));
-        throw std::runtime_error(err_str);
-    }
-
-    _scene = rtcNewScene(_device);
-    if (!_scene) {
-        auto err = rtcGetDeviceError(_device);
-        std::string err_str("Embree scene creation error: ");
-        err_str.append(std::to_string(err));
-        throw std::runtime_error(err_str);
-    }
-
     _material.ambient << 0.1f, 0.1f, 0.1f;
     _material.diffuse << 0.7f, 0.7f, 0.7f;
 }
 
-inline RayTracer::~RayTracer()
+inline RayTracer::RayTracer(std::shared_ptr<RayScene> scene)
+    : _scene(std::move(scene)), _threads(0)
 {
-    release_buffers();
-    rtcReleaseScene(_scene);
-    rtcReleaseDevice(_device);
+    if (!_scene) { throw std::invalid_argument("The scene is null."); }
+    _material.ambient << 0.1f, 0.1f, 0.1f;
+    _material.diffuse << 0.7f, 0.7f, 0.7f;
 }
 
-// TODO: add generic type support
+inline RayTracer::~RayTracer() = default;
+
 inline void RayTracer::attach_geometry_buffers(
     const std::vector<float>& positions,
     const std::vector<unsigned>& indices)
 {
-    if (positions.empty() || indices.empty()) {
-        EWARNING("Input geometry is empty.");
-        return;
-    }
-    if (positions.size() % 3 != 1) {
-        throw std::invalid_argument("The last element of the positions buffer "
-                                    "is not padded to 16 bytes. Add "
-                                    "one more 0.0f to your positions buffer.");
-    }
-    if (indices.size() % 3 != 0) {
-        throw std::invalid_argument("Size of input indices is not divisible by "
-                                    "3, thus not a valid triangle mesh.");
-    }
-
-    release_buffers();
-
-    _geometry = rtcNewGeometry(_device, RTC_GEOMETRY_TYPE_TRIANGLE);
-    rtcSetSharedGeometryBuffer(_geometry,
-                               RTC_BUFFER_TYPE_VERTEX,
-                               0,
-                               RTC_FORMAT_FLOAT3,
-                               positions.data(),
-                               0,
-                               3 * sizeof(float),
-                               positions.size() / 3);
-    rtcSetSharedGeometryBuffer(_geometry,
-                               RTC_BUFFER_TYPE_INDEX,
-                               0,
-                               RTC_FORMAT_UINT3,
-                               indices.data(),
-                               0,
-                               3 * sizeof(unsigned),
-                               indices.size() / 3);
-    rtcCommitGeometry(_geometry);
-    _geom_id = rtcAttachGeometry(_scene, _geometry);
-    rtcCommitScene(_scene);
+    _unshare_scene();
+    _colors = nullptr;
+    _face_mask = nullptr;
+    _scene->attach_geometry_buffers(positions, indices);
 }
 
 inline void RayTracer::attach_color_buffer(const std::vector<float>* colors,
@@ -224,74 +296,44 @@ inline void RayTracer::attach_color_buffer(const std::vector<float>* colors,
         EWARNING("Input geometry is empty.");
         return;
     }
-    if (colors && vertex_color && colors->size() % 3 != 1) {
-        throw std::invalid_argument("The last element of the colors buffer "
-                                    "is not padded to 16 bytes. Add "
-                                    "one more 0.0f to your colors buffer.");
-    }
-
-    // ! vertex color -> vertex color
-    if (!(_colors && _vertex_color) && (colors && vertex_color)) {
-        rtcSetGeometryVertexAttributeCount(_geometry, 1);
-        rtcSetSharedGeometryBuffer(_geometry,
-                                   RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE,
-                                   0,
-                                   RTC_FORMAT_FLOAT3,
-                                   colors->data(),
-                                   0,
-                                   3 * sizeof(float),
-                                   colors->size() / 3);
-        rtcCommitGeometry(_geometry);
-    }
-    // vertex color -> ! vertex color
-    else if ((_colors && _vertex_color) && !(colors && vertex_color)) {
-        rtcSetGeometryVertexAttributeCount(_geometry, 0);
-        rtcCommitGeometry(_geometry);
-    }
-    // vertex color -> vertex color
-    else if ((_colors && _vertex_color) && (colors && vertex_color)) {
-        rtcSetSharedGeometryBuffer(_geometry,
-                                   RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE,
-                                   0,
-                                   RTC_FORMAT_FLOAT3,
-                                   colors->data(),
-                                   0,
-                                   3 * sizeof(float),
-                                   colors->size() / 3);
-        rtcCommitGeometry(_geometry);
-    }
-
     _colors = colors;
     _vertex_color = vertex_color;
 }
 
 inline void RayTracer::attach_face_mask_buffer(const std::vector<uint8_t>* mask)
 {
-    // no mask -> mask
-    if (!_face_mask && mask) {
-        rtcSetGeometryIntersectFilterFunction(_geometry, _impl::mask_filter);
-    }
-    // mask -> no mask
-    else if (_face_mask && !mask) {
-        rtcSetGeometryIntersectFilterFunction(_geometry, nullptr);
-    }
-
-    uint8_t* buffer = nullptr;
-    if (mask) { buffer = const_cast<uint8_t*>(mask->data()); }
-    rtcSetGeometryUserData(_geometry, buffer);
-    rtcCommitGeometry(_geometry);
     _face_mask = mask;
 }
 
+inline void RayTracer::update_positions(const std::vector<float>& positions)
+{
+    _scene->update_positions(positions);
+}
+
+inline void RayTracer::set_build_quality(BuildQuality quality, bool compact)
+{
+    _scene->set_build_quality(quality, compact);
+}
+
+inline void RayTracer::attach_scene(std::shared_ptr<RayScene> scene)
+{
+    if (!scene) { throw std::invalid_argument("The scene is null."); }
+    _scene = std::move(scene);
+    _colors = nullptr;
+    _face_mask = nullptr;
+}
+
+inline std::shared_ptr<RayScene> RayTracer::scene() const
+{
+    return _scene;
+}
+
 inline void RayTracer::release_buffers()
 {
-    if (_geom_id != -1) {
-        rtcDetachGeometry(_scene, _geom_id);
-        _geom_id = -1;
-        _colors = nullptr;
-        _face_mask = nullptr;
-        rtcReleaseGeometry(_geometry);
-    }
+    _unshare_scene();
+    _scene->release_buffers();
+    _colors = nullptr;
+    _face_mask = nullptr;
 }
 
 inline void RayTracer::set_material(const Material& material)
@@ -322,59 +364,14 @@ inline void RayTracer::render_shaded(std::vector<uint8_t>& pixels,
                                      bool interleaved)
 {
     pixels.resize(3 * width * height);
-    auto diffuse_color = _select_diffuse_color();
-
-    RTCIntersectContext context;
-    rtcInitIntersectContext(&context);
-
-#pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            Eigen::Array3f color(0.0f, 0.0f, 0.0f);
-            auto u = static_cast<float>(x) / width;
-            auto v = static_cast<float>(y) / height;
-            auto rayhit = camera.gen_ray(u, v);
-            rtcIntersect1(_scene, &context, &rayhit);
-
-            if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID) {
-                Eigen::Array3f ambient = _material.ambient;
-                Eigen::Array3f diffuse = diffuse_color(rayhit.hit);
-                if (_lighting) {
-                    Eigen::Vector3f normal = Eigen::Vector3f(rayhit.hit.Ng_x,
-                                                             rayhit.hit.Ng_y,
-                                                             rayhit.hit.Ng_z)
-                                                 .normalized();
-                    // // Point light at the view position
-                    Eigen::Vector3f lightdir = Eigen::Vector3f(rayhit.ray.dir_x,
-                                                               rayhit.ray.dir_y,
-                                                               rayhit.ray.dir_z)
-                                                   .normalized();
-                    diffuse *= std::abs(normal.dot(-lightdir));
-                }
-                color += ambient + diffuse;
-            }
-            else {
-                color += _background;
-            }
-            color(0) = std::min(color(0), 1.0f);
-            color(1) = std::min(color(1), 1.0f);
-            color(2) = std::min(color(2), 1.0f);
-            color *= 255;
-            auto r = static_cast<uint8_t>(color(0));
-            auto g = static_cast<uint8_t>(color(1));
-            auto b = static_cast<uint8_t>(color(2));
-            if (interleaved) {
-                pixels[3 * ((height - y - 1) * width + x) + 0] = r;
-                pixels[3 * ((height - y - 1) * width + x) + 1] = g;
-                pixels[3 * ((height - y - 1) * width + x) + 2] = b;
-            }
-            else {
-                pixels[(height - y - 1) * width + x] = r;
-                pixels[width * height + (height - y - 1) * width + x] = g;
-                pixels[2 * width * height + (height - y - 1) * width + x] = b;
-            }
-        }
-    }
+    const RayCamera* cameras[] = { &camera };
+    _render_views(pixels.data(),
+                  cameras,
+                  1,
+                  width,
+                  height,
+                  RenderMode::shaded,
+                  interleaved);
 }
 
 inline void RayTracer::render_shaded(std::vector<uint8_t>& pixels,
@@ -382,71 +379,99 @@ inline void RayTracer::render_shaded(std::vector<uint8_t>& pixels,
                                      int width,
                                      int height,
                                      int samples,
-                                     bool interleaved)
+                                     bool interleaved,
+                                     float tolerance)
 {
+    if (samples < 1) {
+        throw std::invalid_argument("Number of samples must be positive.");
+    }
+    constexpr const int n = _impl::packet_size;
     pixels.resize(3 * width * height);
     auto diffuse_color = _select_diffuse_color();
 
-    RTCIntersectContext context;
-    rtcInitIntersectContext(&context);
-    std::random_device rd;
-    std::minstd_rand rd_gen(rd());
-    std::uniform_real_distribution<> rd_number(0.0f, 1.0f);
-    const float rcpr_samples = 1.0f / samples;
+    Context context;
+    _init_context(context, false);
+    const auto min_samples = std::min(samples, _impl::min_adaptive_samples);
+    const auto tolerance2 = tolerance * tolerance;
 
-#pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            Eigen::Array3f color(0.0f, 0.0f, 0.0f);
-            for (int s = 0; s < samples; ++s) {
-                auto u = static_cast<float>(x + rd_number(rd_gen)) / width;
-                auto v = static_cast<float>(y + rd_number(rd_gen)) / height;
-                auto rayhit = camera.gen_ray(u, v);
-                rtcIntersect1(_scene, &context, &rayhit);
-
-                if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID) {
-                    Eigen::Array3f ambient = _material.ambient;
-                    Eigen::Array3f diffuse = diffuse_color(rayhit.hit);
-                    if (_lighting) {
-                        Eigen::Vector3f normal =
-                            Eigen::Vector3f(rayhit.hit.Ng_x,
-                                            rayhit.hit.Ng_y,
-                                            rayhit.hit.Ng_z)
-                                .normalized();
-                        // // Point light at the view position
-                        Eigen::Vector3f lightdir =
-                            Eigen::Vector3f(rayhit.ray.dir_x,
-                                            rayhit.ray.dir_y,
-                                            rayhit.ray.dir_z)
-                                .normalized();
-                        diffuse *= std::abs(normal.dot(-lightdir));
-                    }
-                    color += ambient + diffuse;
-                }
-                else {
-                    color += _background;
-                }
+    _for_each_packet(1, width, height, [&](int, int x, int y) {
+        alignas(32) int inside[n];
+        alignas(32) int valid[n];
+        alignas(32) float colors[3 * n];
+        alignas(32) float sum[3 * n] = {};
+        alignas(32) float jitter[2 * n];
+        alignas(32) float shift[2 * n];
+        float intensity_sum[n] = {};
+        float intensity_sum2[n] = {};
+        int counts[n] = {};
+        bool active[n];
+        RTCRayHit8 rayhit;
+
+        // per pixel random shifts of the sample sequence
+        for (int i = 0; i < n; ++i) {
+            auto pixel = static_cast<uint32_t>(
+                (y + i / _impl::packet_width) * width + x +
+                i % _impl::packet_width);
+            shift[i] = _impl::random_float(pixel, 0);
+            shift[n + i] = _impl::random_float(pixel, 1);
+            active[i] = true;
+        }
+
+        for (int s = 0; s < samples; ++s) {
+            for (int i = 0; i < n; ++i) {
+                auto dx = shift[i] + s * _impl::r2_alpha_x;
+                auto dy = shift[n + i] + s * _impl::r2_alpha_y;
+                jitter[i] = dx - std::floor(dx);
+                jitter[n + i] = dy - std::floor(dy);
             }
-            color *= rcpr_samples;
-            color(0) = std::min(color(0), 1.0f);
-            color(1) = std::min(color(1), 1.0f);
-            color(2) = std::min(color(2), 1.0f);
-            color *= 255;
-            auto r = static_cast<uint8_t>(color(0));
-            auto g = static_cast<uint8_t>(color(1));
-            auto b = static_cast<uint8_t>(color(2));
-            if (interleaved) {
-                pixels[3 * ((height - y - 1) * width + x) + 0] = r;
-                pixels[3 * ((height - y - 1) * width + x) + 1] = g;
-                pixels[3 * ((height - y - 1) * width + x) + 2] = b;
+            _impl::gen_ray_packet(
+                camera, x, y, width, height, jitter, valid, rayhit);
+            if (s == 0) { std::copy(valid, valid + n, inside); }
+
+            bool any = false;
+            for (int i = 0; i < n; ++i) {
+                if (!active[i]) { valid[i] = 0; }
+                any = any || valid[i] != 0;
             }
-            else {
-                pixels[(height - y - 1) * width + x] = r;
-                pixels[width * height + (height - y - 1) * width + x] = g;
-                pixels[2 * width * height + (height - y - 1) * width + x] = b;
+            if (!any) { break; }
+
+            rtcIntersect8(valid, _scene->scene(), &context.context, &rayhit);
+            _shade_packet(rayhit, diffuse_color, colors);
+            for (int i = 0; i < n; ++i) {
+                if (valid[i] == 0) { continue; }
+                auto r = std::min(colors[i], 1.0f);
+                auto g = std::min(colors[n + i], 1.0f);
+                auto b = std::min(colors[2 * n + i], 1.0f);
+                auto intensity = (r + g + b) / 3.0f;
+                sum[i] += colors[i];
+                sum[n + i] += colors[n + i];
+                sum[2 * n + i] += colors[2 * n + i];
+                intensity_sum[i] += intensity;
+                intensity_sum2[i] += intensity * intensity;
+                ++counts[i];
+            }
+
+            // the squared standard error of the mean is var / count
+            if (tolerance > 0.0f && s + 1 >= min_samples) {
+                for (int i = 0; i < n; ++i) {
+                    if (!active[i] || counts[i] < 2) { continue; }
+                    auto mean = intensity_sum[i] / counts[i];
+                    auto var = (intensity_sum2[i] - counts[i] * mean * mean) /
+                               (counts[i] - 1);
+                    if (var <= tolerance2 * counts[i]) { active[i] = false; }
+                }
             }
         }
-    }
+
+        for (int i = 0; i < n; ++i) {
+            auto rcpr_samples = counts[i] > 0 ? 1.0f / counts[i] : 0.0f;
+            sum[i] *= rcpr_samples;
+            sum[n + i] *= rcpr_samples;
+            sum[2 * n + i] *= rcpr_samples;
+        }
+        _impl::write_color_packet(
+            pixels.data(), sum, inside, x, y, width, height, interleaved);
+    });
 }
 
 inline void RayTracer::render_depth(std::vector<uint8_t>& pixels,
@@ -455,28 +480,35 @@ inline void RayTracer::render_depth(std::vector<uint8_t>& pixels,
                                     int height)
 {
     pixels.resize(width * height);
-    std::vector<float> depths(width * height, -1.0f);
-    float min_depth = std::numeric_limits<float>::max();
-    float max_depth = -1.0f;
-    RTCIntersectContext context;
-    rtcInitIntersectContext(&context);
+    std::vector<float> depths;
+    render_depth(depths, camera, width, height);
+
+    // min/max of each chunk, then of all the chunks
+    constexpr const int chunks = 64;
+    const int n = static_cast<int>(depths.size());
+    std::vector<float> min_depths(chunks, std::numeric_limits<float>::max());
+    std::vector<float> max_depths(chunks, -1.0f);
 #pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            auto u = static_cast<float>(x) / width;
-            auto v = static_cast<float>(y) / height;
-            auto rayhit = camera.gen_ray(u, v);
-            rtcIntersect1(_scene, &context, &rayhit);
-            if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID) {
-                auto depth = rayhit.ray.tfar * camera.dir.norm();
-                depths[(height - y - 1) * width + x] = depth;
-                if (depth < min_depth) min_depth = depth;
-                if (depth > max_depth) max_depth = depth;
-            }
+    for (int c = 0; c < chunks; ++c) {
+        auto begin = static_cast<size_t>(n) * c / chunks;
+        auto end = static_cast<size_t>(n) * (c + 1) / chunks;
+        auto min_depth = std::numeric_limits<float>::max();
+        auto max_depth = -1.0f;
+        for (auto i = begin; i < end; ++i) {
+            auto depth = depths[i];
+            if (depth == -1.0f) { continue; }
+            if (depth < min_depth) min_depth = depth;
+            if (depth > max_depth) max_depth = depth;
         }
+        min_depths[c] = min_depth;
+        max_depths[c] = max_depth;
     }
+    float min_depth = *std::min_element(min_depths.begin(), min_depths.end());
+    float max_depth = *std::max_element(max_depths.begin(), max_depths.end());
+
     float denom = 1.0f / (max_depth - min_depth);
-    for (size_t i = 0; i < depths.size(); ++i) {
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i = 0; i < n; ++i) {
         if (depths[i] == -1.0f) { pixels[i] = 0; }
         else {
             pixels[i] =
@@ -491,24 +523,9 @@ inline void RayTracer::render_depth(std::vector<float>& values,
                                     int height)
 {
     values.resize(width * height);
-    RTCIntersectContext context;
-    rtcInitIntersectContext(&context);
-#pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            auto u = static_cast<float>(x) / width;
-            auto v = static_cast<float>(y) / height;
-            auto rayhit = camera.gen_ray(u, v);
-            rtcIntersect1(_scene, &context, &rayhit);
-            if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID) {
-                auto depth = rayhit.ray.tfar * camera.dir.norm();
-                values[(height - y - 1) * width + x] = depth;
-            }
-            else {
-                values[(height - y - 1) * width + x] = -1.0f;
-            }
-        }
-    }
+    const RayCamera* cameras[] = { &camera };
+    _render_views(
+        values.data(), cameras, 1, width, height, RenderMode::depth, true);
 }
 
 inline void RayTracer::render_silhouette(std::vector<uint8_t>& pixels,
@@ -517,23 +534,9 @@ inline void RayTracer::render_silhouette(std::vector<uint8_t>& pixels,
                                          int height)
 {
     pixels.resize(width * height);
-    RTCIntersectContext context;
-    rtcInitIntersectContext(&context);
-#pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            auto u = static_cast<float>(x) / width;
-            auto v = static_cast<float>(y) / height;
-            auto rayhit = camera.gen_ray(u, v);
-            rtcOccluded1(_scene, &context, &(rayhit.ray));
-            if (rayhit.ray.tfar <= 0.0f) {
-                pixels[(height - y - 1) * width + x] = 255;
-            }
-            else {
-                pixels[(height - y - 1) * width + x] = 0;
-            }
-        }
-    }
+    const RayCamera* cameras[] = { &camera };
+    _render_views(
+        pixels.data(), cameras, 1, width, height, RenderMode::silhouette, true);
 }
 
 inline void RayTracer::render_index(std::vector<uint8_t>& pixels,
@@ -543,119 +546,529 @@ inline void RayTracer::render_index(std::vector<uint8_t>& pixels,
                                     bool interleaved)
 {
     pixels.resize(3 * width * height);
-    RTCIntersectContext context;
-    rtcInitIntersectContext(&context);
-#pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            auto u = static_cast<float>(x) / width;
-            auto v = static_cast<float>(y) / height;
-            auto rayhit = camera.gen_ray(u, v);
-            rtcIntersect1(_scene, &context, &rayhit);
-            uint32_t index;
-            if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID) {
-                index = rayhit.hit.primID + 1;
+    const RayCamera* cameras[] = { &camera };
+    _render_views(pixels.data(),
+                  cameras,
+                  1,
+                  width,
+                  height,
+                  RenderMode::index,
+                  interleaved);
+}
+
+inline void RayTracer::render_index(std::vector<uint32_t>& indices,
+                                    const RayCamera& camera,
+                                    int width,
+                                    int height)
+{
+    indices.resize(width * height);
+    const RayCamera* cameras[] = { &camera };
+    _render_views(
+        indices.data(), cameras, 1, width, height, RenderMode::index, true);
+}
+
+inline void RayTracer::render_histogram(std::vector<uint32_t>& counts,
+                                        const RayCamera& camera,
+                                        int width,
+                                        int height)
+{
+    const auto indices = _scene->indices();
+    counts.resize((indices ? indices->size() / 3 : 0) + 1);
+    const RayCamera* cameras[] = { &camera };
+    _render_histograms(counts.data(), cameras, 1, width, height);
+}
+
+inline void RayTracer::render_gbuffer(const GBuffer& gbuffer,
+                                      const RayCamera& camera,
+                                      int width,
+                                      int height)
+{
+    const int size = width * height;
+    const auto scale = camera.dir.norm();
+    DiffuseColor diffuse_color;
+    if (gbuffer.color) {
+        diffuse_color = _select_diffuse_color();
+    }
+
+    Context context;
+    _init_context(context, true);
+
+    _for_each_packet(1, width, height, [&](int, int x, int y) {
+        alignas(32) int valid[_impl::packet_size];
+        alignas(32) float colors[3 * _impl::packet_size];
+        RTCRayHit8 rayhit;
+        _impl::gen_ray_packet(
+            camera, x, y, width, height, nullptr, valid, rayhit);
+        rtcIntersect8(valid, _scene->scene(), &context.context, &rayhit);
+        if (gbuffer.color) {
+            _shade_packet(rayhit, diffuse_color, colors);
+        }
+
+        for (int i = 0; i < _impl::packet_size; ++i) {
+            if (valid[i] == 0) { continue; }
+            auto idx = _impl::lane_pixel(x, y, i, width, height);
+            auto hit = rayhit.hit.geomID[i] != RTC_INVALID_GEOMETRY_ID;
+            if (gbuffer.depth) {
+                gbuffer.depth[idx] = hit ? rayhit.ray.tfar[i] * scale : -1.0f;
+            }
+            if (gbuffer.face) {
+                gbuffer.face[idx] = hit ? rayhit.hit.primID[i] + 1 : 0;
             }
-            else {
-                index = 0;
+            if (gbuffer.barycentric) {
+                gbuffer.barycentric[idx] = hit ? rayhit.hit.u[i] : 0.0f;
+                gbuffer.barycentric[size + idx] = hit ? rayhit.hit.v[i] : 0.0f;
             }
-            uint8_t r = index & 0x000000FF;
-            uint8_t g = (index >> 8) & 0x000000FF;
-            uint8_t b = (index >> 16) & 0x000000FF;
-            if (interleaved) {
-                pixels[3 * ((height - y - 1) * width + x) + 0] = r;
-                pixels[3 * ((height - y - 1) * width + x) + 1] = g;
-                pixels[3 * ((height - y - 1) * width + x) + 2] = b;
+            if (gbuffer.normal) {
+                Eigen::Vector3f normal = Eigen::Vector3f::Zero();
+                if (hit) {
+                    normal << rayhit.hit.Ng_x[i], rayhit.hit.Ng_y[i],
+                        rayhit.hit.Ng_z[i];
+                    normal.normalize();
+                }
+                gbuffer.normal[idx] = normal(0);
+                gbuffer.normal[size + idx] = normal(1);
+                gbuffer.normal[2 * size + idx] = normal(2);
+            }
+            if (gbuffer.color) {
+                for (int c = 0; c < 3; ++c) {
+                    auto value = colors[c * _impl::packet_size + i];
+                    gbuffer.color[c * size + idx] = std::min(value, 1.0f);
+                }
             }
-            else {
-                pixels[(height - y - 1) * width + x] = r;
-                pixels[width * height + (height - y - 1) * width + x] = g;
-                pixels[2 * width * height + (height - y - 1) * width + x] = b;
+            if (gbuffer.mask) {
+                gbuffer.mask[idx] = hit ? 255 : 0;
             }
         }
+    });
+}
+
+inline void
+RayTracer::render_batch(uint8_t* pixels,
+                        const std::vector<const RayCamera*>& cameras,
+                        int width,
+                        int height,
+                        RenderMode mode)
+{
+    if (mode == RenderMode::depth) {
+        throw std::invalid_argument("Depth should be rendered as float.");
+    }
+    if (mode == RenderMode::histogram) {
+        throw std::invalid_argument("Histograms should be stored as uint32.");
     }
+    _render_views(pixels,
+                  cameras.data(),
+                  static_cast<int>(cameras.size()),
+                  width,
+                  height,
+                  mode,
+                  true);
 }
 
-inline void RayTracer::render_index(std::vector<uint32_t>& indices,
-                                    const RayCamera& camera,
-                                    int width,
-                                    int height)
+inline void
+RayTracer::render_batch(uint32_t* indices,
+                        const std::vector<const RayCamera*>& cameras,
+                        int width,
+                        int height,
+                        RenderMode mode)
 {
-    indices.resize(width * height);
-    RTCIntersectContext context;
-    rtcInitIntersectContext(&context);
+    if (mode == RenderMode::histogram) {
+        _render_histograms(indices,
+                           cameras.data(),
+                           static_cast<int>(cameras.size()),
+                           width,
+                           height);
+        return;
+    }
+    if (mode != RenderMode::index) {
+        throw std::invalid_argument(
+            "Only face indices and histograms are stored as uint32.");
+    }
+    _render_views(indices,
+                  cameras.data(),
+                  static_cast<int>(cameras.size()),
+                  width,
+                  height,
+                  mode,
+                  true);
+}
+
+inline void
+RayTracer::render_batch(float* values,
+                        const std::vector<const RayCamera*>& cameras,
+                        int width,
+                        int height,
+                        RenderMode mode)
+{
+    if (mode != RenderMode::depth) {
+        throw std::invalid_argument("Only depth is stored as float.");
+    }
+    _render_views(values,
+                  cameras.data(),
+                  static_cast<int>(cameras.size()),
+                  width,
+                  height,
+                  mode,
+                  true);
+}
+
+template<typename Pixel>
+void RayTracer::_render_views(Pixel* buffer,
+                              const RayCamera* const* cameras,
+                              int views,
+                              int width,
+                              int height,
+                              RenderMode mode,
+                              bool interleaved)
+{
+    const bool rgb = mode == RenderMode::shaded ||
+                     (mode == RenderMode::index && sizeof(Pixel) == 1);
+    const size_t stride = static_cast<size_t>(rgb ? 3 : 1) * width * height;
+    DiffuseColor diffuse_color;
+    if (mode == RenderMode::shaded) {
+        diffuse_color = _select_diffuse_color();
+    }
+
+    Context context;
+    _init_context(context, true);
+
+    _for_each_packet(views, width, height, [&](int view, int x, int y) {
+        alignas(32) int valid[_impl::packet_size];
+        RTCRayHit8 rayhit;
+        const auto& camera = *cameras[view];
+        _impl::gen_ray_packet(
+            camera, x, y, width, height, nullptr, valid, rayhit);
+        if (mode == RenderMode::silhouette) {
+            rtcOccluded8(valid, _scene->scene(), &context.context, &rayhit.ray);
+        }
+        else {
+            rtcIntersect8(valid, _scene->scene(), &context.context, &rayhit);
+        }
+
+        Packet target{ x, y, width, height, interleaved };
+        _write_packet(buffer + view * stride,
+                      target,
+                      mode,
+                      camera,
+                      rayhit,
+                      valid,
+                      diffuse_color);
+    });
+}
+
+inline void RayTracer::_render_histograms(uint32_t* counts,
+                                          const RayCamera* const* cameras,
+                                          int views,
+                                          int width,
+                                          int height)
+{
+    const auto indices = _scene->indices();
+    const size_t bins = (indices ? indices->size() / 3 : 0) + 1;
+    const int tiles_x = (width + _impl::tile_size - 1) / _impl::tile_size;
+    const int tiles_y = (height + _impl::tile_size - 1) / _impl::tile_size;
+    const int tiles = tiles_x * tiles_y;
+    if (views == 0 || tiles == 0) { return; }
+
+    // Split each view into interleaved groups of tiles so that there are
+    // about as many jobs as threads, each job counting into its own histogram
+    int threads = _threads;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+        threads = std::max(threads, 1);
+    }
+    const int groups = std::min(tiles, std::max(1, threads / views));
+    std::vector<uint32_t> partial(groups > 1 ? views * groups * bins : 0);
+
+    Context context;
+    _init_context(context, true);
+
 #pragma omp parallel for schedule(dynamic)
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            auto u = static_cast<float>(x) / width;
-            auto v = static_cast<float>(y) / height;
-            auto rayhit = camera.gen_ray(u, v);
-            rtcIntersect1(_scene, &context, &rayhit);
-            uint32_t index;
-            if (rayhit.hit.geomID != RTC_INVALID_GEOMETRY_ID) {
-                index = rayhit.hit.primID + 1;
-            }
-            else {
-                index = 0;
+    for (int job = 0; job < views * groups; ++job) {
+        const auto& camera = *cameras[job / groups];
+        auto histogram = groups > 1 ? partial.data() + job * bins
+                                    : counts + job * bins;
+        std::fill(histogram, histogram + bins, 0);
+        for (int tile = job % groups; tile < tiles; tile += groups) {
+            _impl::for_each_tile_packet(tile, width, height, [&](int x, int y) {
+                alignas(32) int valid[_impl::packet_size];
+                RTCRayHit8 rayhit;
+                _impl::gen_ray_packet(
+                    camera, x, y, width, height, nullptr, valid, rayhit);
+                rtcIntersect8(
+                    valid, _scene->scene(), &context.context, &rayhit);
+                for (int i = 0; i < _impl::packet_size; ++i) {
+                    if (valid[i] == 0) { continue; }
+                    auto hit = rayhit.hit.geomID[i] != RTC_INVALID_GEOMETRY_ID;
+                    ++histogram[hit ? rayhit.hit.primID[i] + 1 : 0];
+                }
+            });
+        }
+    }
+    if (groups == 1) { return; }
+
+    // Sum up the partial histograms of each view
+    constexpr const size_t chunk = 4096;
+    const int chunks = static_cast<int>((bins + chunk - 1) / chunk);
+#pragma omp parallel for schedule(dynamic)
+    for (int job = 0; job < views * chunks; ++job) {
+        auto view = job / chunks;
+        auto begin = (job % chunks) * chunk;
+        auto end = std::min(begin + chunk, bins);
+        auto first = partial.data() + view * groups * bins;
+        for (auto b = begin; b < end; ++b) {
+            uint32_t sum = 0;
+            for (int g = 0; g < groups; ++g) {
+                sum += first[g * bins + b];
             }
-            indices[(height - y - 1) * width + x] = index;
+            counts[view * bins + b] = sum;
+        }
+    }
+}
+
+template<typename Kernel>
+void RayTracer::_for_each_packet(int views,
+                                 int width,
+                                 int height,
+                                 Kernel&& kernel)
+{
+    const int tiles_x = (width + _impl::tile_size - 1) / _impl::tile_size;
+    const int tiles_y = (height + _impl::tile_size - 1) / _impl::tile_size;
+    const int tiles = tiles_x * tiles_y;
+
+#pragma omp parallel for schedule(dynamic)
+    for (int job = 0; job < views * tiles; ++job) {
+        auto view = job / tiles;
+        _impl::for_each_tile_packet(
+            job % tiles, width, height, [&](int x, int y) {
+                kernel(view, x, y);
+            });
+    }
+}
+
+inline void RayTracer::_write_packet(uint8_t* pixels,
+                                     const Packet& target,
+                                     RenderMode mode,
+                                     const RayCamera& camera,
+                                     const RTCRayHit8& rayhit,
+                                     const int* valid,
+                                     const DiffuseColor& diffuse_color)
+{
+    (void)camera;
+    const auto x = target.x;
+    const auto y = target.y;
+    const auto width = target.width;
+    const auto height = target.height;
+
+    if (mode == RenderMode::shaded) {
+        alignas(32) float colors[3 * _impl::packet_size];
+        _shade_packet(rayhit, diffuse_color, colors);
+        _impl::write_color_packet(
+            pixels, colors, valid, x, y, width, height, target.interleaved);
+        return;
+    }
+
+    for (int i = 0; i < _impl::packet_size; ++i) {
+        if (valid[i] == 0) { continue; }
+        auto idx = _impl::lane_pixel(x, y, i, width, height);
+        if (mode == RenderMode::silhouette) {
+            pixels[idx] = rayhit.ray.tfar[i] <= 0.0f ? 255 : 0;
+            continue;
+        }
+
+        uint32_t index = 0;
+        if (rayhit.hit.geomID[i] != RTC_INVALID_GEOMETRY_ID) {
+            index = rayhit.hit.primID[i] + 1;
+        }
+        uint8_t r = index & 0x000000FF;
+        uint8_t g = (index >> 8) & 0x000000FF;
+        uint8_t b = (index >> 16) & 0x000000FF;
+        if (target.interleaved) {
+            pixels[3 * idx + 0] = r;
+            pixels[3 * idx + 1] = g;
+            pixels[3 * idx + 2] = b;
+        }
+        else {
+            pixels[idx] = r;
+            pixels[width * height + idx] = g;
+            pixels[2 * width * height + idx] = b;
+        }
+    }
+}
+
+inline void RayTracer::_write_packet(uint32_t* indices,
+                                     const Packet& target,
+                                     RenderMode mode,
+                                     const RayCamera& camera,
+                                     const RTCRayHit8& rayhit,
+                                     const int* valid,
+                                     const DiffuseColor& diffuse_color)
+{
+    (void)mode;
+    (void)camera;
+    (void)diffuse_color;
+    for (int i = 0; i < _impl::packet_size; ++i) {
+        if (valid[i] == 0) { continue; }
+        uint32_t index = 0;
+        if (rayhit.hit.geomID[i] != RTC_INVALID_GEOMETRY_ID) {
+            index = rayhit.hit.primID[i] + 1;
+        }
+        auto idx = _impl::lane_pixel(
+            target.x, target.y, i, target.width, target.height);
+        indices[idx] = index;
+    }
+}
+
+inline void RayTracer::_write_packet(float* values,
+                                     const Packet& target,
+                                     RenderMode mode,
+                                     const RayCamera& camera,
+                                     const RTCRayHit8& rayhit,
+                                     const int* valid,
+                                     const DiffuseColor& diffuse_color)
+{
+    (void)mode;
+    (void)diffuse_color;
+    const auto scale = camera.dir.norm();
+    for (int i = 0; i < _impl::packet_size; ++i) {
+        if (valid[i] == 0) { continue; }
+        auto idx = _impl::lane_pixel(
+            target.x, target.y, i, target.width, target.height);
+        if (rayhit.hit.geomID[i] != RTC_INVALID_GEOMETRY_ID) {
+            values[idx] = rayhit.ray.tfar[i] * scale;
+        }
+        else {
+            values[idx] = -1.0f;
         }
     }
 }
 
-inline std::function<Eigen::Array3f(const RTCHit&)>
-RayTracer::_select_diffuse_color()
+inline void RayTracer::_shade_packet(const RTCRayHit8& rayhit,
+                                     const DiffuseColor& diffuse_color,
+                                     float* colors)
 {
+    constexpr const int n = _impl::packet_size;
+
+    // Lambertian term with a point light at the view position
+    alignas(32) float cosine[n];
+    for (int i = 0; i < n; ++i) {
+        auto nx = rayhit.hit.Ng_x[i];
+        auto ny = rayhit.hit.Ng_y[i];
+        auto nz = rayhit.hit.Ng_z[i];
+        auto dx = rayhit.ray.dir_x[i];
+        auto dy = rayhit.ray.dir_y[i];
+        auto dz = rayhit.ray.dir_z[i];
+        auto nn = nx * nx + ny * ny + nz * nz;
+        auto dd = dx * dx + dy * dy + dz * dz;
+        auto nd = nx * dx + ny * dy + nz * dz;
+        cosine[i] = nn > 0.0f ? std::abs(nd) / std::sqrt(nn * dd) : 0.0f;
+    }
+    if (!_lighting) {
+        std::fill(cosine, cosine + n, 1.0f);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        Eigen::Array3f color;
+        if (rayhit.hit.geomID[i] != RTC_INVALID_GEOMETRY_ID) {
+            auto diffuse = diffuse_color(
+                rayhit.hit.primID[i], rayhit.hit.u[i], rayhit.hit.v[i]);
+            color = _material.ambient + diffuse * cosine[i];
+        }
+        else {
+            color = _background;
+        }
+        colors[i] = color(0);
+        colors[n + i] = color(1);
+        colors[2 * n + i] = color(2);
+    }
+}
+
+inline void RayTracer::_unshare_scene()
+{
+    if (_scene.use_count() != 1) {
+        auto scene = std::make_shared<RayScene>(_threads);
+        scene->set_build_quality(_scene->build_quality(), _scene->compact());
+        _scene = std::move(scene);
+    }
+}
+
+inline void RayTracer::_init_context(Context& context, bool coherent) const
+{
+    rtcInitIntersectContext(&context.context);
+    if (coherent) {
+        context.context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+    }
+    context.mask = nullptr;
+    if (_face_mask) {
+        context.context.filter = _mask_filter;
+        context.mask = _face_mask->data();
+    }
+}
+
+inline void RayTracer::_mask_filter(const RTCFilterFunctionNArguments* args)
+{
+    auto mask = reinterpret_cast<const Context*>(args->context)->mask;
+    EASSERT(mask != nullptr);
+
+    for (unsigned i = 0; i < args->N; ++i) {
+        if (args->valid[i] == 0) { continue; }
+        auto primid = RTCHitN_primID(args->hit, args->N, i);
+        if (mask[primid] != 1) { args->valid[i] = 0; }
+    }
+}
+
+inline RayTracer::DiffuseColor RayTracer::_select_diffuse_color()
+{
+    using namespace std::placeholders;
     if (_colors && _vertex_color) {
-        return std::bind(
-            &RayTracer::_diffuse_vertex_color, this, std::placeholders::_1);
+        return std::bind(&RayTracer::_diffuse_vertex_color, this, _1, _2, _3);
     }
     else if (_colors && !_vertex_color) {
-        return std::bind(
-            &RayTracer::_diffuse_face_color, this, std::placeholders::_1);
+        return std::bind(&RayTracer::_diffuse_face_color, this, _1, _2, _3);
     }
     else {
-        return std::bind(
-            &RayTracer::_diffuse_material, this, std::placeholders::_1);
+        return std::bind(&RayTracer::_diffuse_material, this, _1, _2, _3);
     }
 }
 
-inline Eigen::Array3f RayTracer::_diffuse_material(const RTCHit& hit)
+inline Eigen::Array3f RayTracer::_diffuse_material(unsigned primid,
+                                                   float u,
+                                                   float v)
 {
-    (void)hit;
+    (void)primid;
+    (void)u;
+    (void)v;
     return _material.diffuse;
 }
 
-inline Eigen::Array3f RayTracer::_diffuse_face_color(const RTCHit& hit)
+inline Eigen::Array3f RayTracer::_diffuse_face_color(unsigned primid,
+                                                     float u,
+                                                     float v)
 {
+    (void)u;
+    (void)v;
     Eigen::Array3f diffuse;
-    diffuse << (*_colors)[3 * hit.primID], (*_colors)[3 * hit.primID + 1],
-        (*_colors)[3 * hit.primID + 2];
+    diffuse << (*_colors)[3 * primid], (*_colors)[3 * primid + 1],
+        (*_colors)[3 * primid + 2];
     return diffuse;
 }
 
-inline Eigen::Array3f RayTracer::_diffuse_vertex_color(const RTCHit& hit)
-{
-    float buffer[4];
-    RTCInterpolateArguments args;
-    args.geometry = _geometry;
-    args.primID = hit.primID;
-    args.u = hit.u;
-    args.v = hit.v;
-    args.bufferType = RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE;
-    args.bufferSlot = 0;
-    args.valueCount = 3;
-    args.P = buffer;
-    args.dPdu = nullptr;
-    args.dPdv = nullptr;
-    args.ddPdudu = nullptr;
-    args.ddPdvdv = nullptr;
-    args.ddPdudv = nullptr;
-    rtcInterpolate(&args);
+inline Eigen::Array3f RayTracer::_diffuse_vertex_color(unsigned primid,
+                                                       float u,
+                                                       float v)
+{
+    const auto& indices = *_scene->indices();
+    const auto& colors = *_colors;
+    auto i0 = 3 * indices[3 * primid];
+    auto i1 = 3 * indices[3 * primid + 1];
+    auto i2 = 3 * indices[3 * primid + 2];
+    auto w = 1.0f - u - v;
 
     Eigen::Array3f diffuse;
-    diffuse << buffer[0], buffer[1], buffer[2];
+    for (int i = 0; i < 3; ++i) {
+        diffuse(i) =
+            w * colors[i0 + i] + u * colors[i1 + i] + v * colors[i2 + i];
+    }
     return diffuse;
 }
 
 } // namespace Euclid
+
@@ -0,0 +1,716 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Euclid
+{
+
+namespace _impl
+{
+
+/** Screen tiles processed by one thread, must be a multiple of the block.*/
+constexpr int raster_tile_size = 32;
+
+/** Blocks of pixels sharing one coarse depth value.*/
+constexpr int raster_block_size = 8;
+
+/** Vertices are snapped to 1/256 pixels.*/
+constexpr int raster_subpixel_bits = 8;
+constexpr int raster_subpixel_scale = 1 << raster_subpixel_bits;
+
+/** Triangles set up and binned by one thread.*/
+constexpr int raster_chunk_size = 4096;
+
+/** Triangles are only clipped against the guard band in x and y, which keeps
+ *  the fixed point edge functions from overflowing.
+ */
+constexpr float raster_guard_band = 2.0f;
+
+constexpr uint32_t raster_no_face = 0xffffffff;
+
+/** Standard Vulkan sample locations, in 1/16 pixels, as [x,y,x,y...].*/
+inline const int* raster_sample_locations(int samples)
+{
+    static const int one[] = { 8, 8 };
+    static const int two[] = { 12, 12, 4, 4 };
+    static const int four[] = { 6, 2, 14, 6, 2, 10, 10, 14 };
+    static const int eight[] = { 9, 5,  7,  11, 13, 9, 5,  3,
+                                 3, 13, 1,  7,  11, 15, 15, 1 };
+    switch (samples) {
+    case 2: return two;
+    case 4: return four;
+    case 8: return eight;
+    default: return one;
+    }
+}
+
+inline int raster_floor(int32_t value)
+{
+    return value >= 0 ? value / raster_subpixel_scale
+                      : -((-value + raster_subpixel_scale - 1) /
+                          raster_subpixel_scale);
+}
+
+/** Clip a polygon against the half space dot(plane, v) >= 0.
+ *
+ *  Return the number of output vertices.
+ */
+inline int clip_polygon(const Eigen::Vector4f* in,
+                        int n,
+                        const Eigen::Vector4f& plane,
+                        Eigen::Vector4f* out)
+{
+    int m = 0;
+    for (int i = 0; i < n; ++i) {
+        const auto& a = in[i];
+        const auto& b = in[(i + 1) % n];
+        auto da = plane.dot(a);
+        auto db = plane.dot(b);
+        if (da >= 0.0f) { out[m++] = a; }
+        if ((da >= 0.0f) != (db >= 0.0f)) {
+            out[m++] = a + (b - a) * (da / (da - db));
+        }
+    }
+    return m;
+}
+
+} // namespace _impl
+
+inline SoftRasterizer::SoftRasterizer(uint32_t width,
+                                      uint32_t height,
+                                      SampleCount samples)
+    : _material(_default_material), _light(_default_light)
+{
+    set_image(width, height, samples);
+}
+
+inline SoftRasterizer::~SoftRasterizer() = default;
+
+inline void SoftRasterizer::attach_position_buffer(const float* positions,
+                                                   size_t size)
+{
+    if (positions != nullptr) {
+        _positions.assign(positions, positions + size);
+    }
+    else {
+        _positions.clear();
+    }
+}
+
+inline void SoftRasterizer::attach_normal_buffer(const float* normals,
+                                                 size_t size)
+{
+    if (normals != nullptr) { _normals.assign(normals, normals + size); }
+    else {
+        _normals.clear();
+    }
+}
+
+inline void SoftRasterizer::attach_color_buffer(const float* colors,
+                                                size_t size)
+{
+    if (colors != nullptr) { _colors.assign(colors, colors + size); }
+    else {
+        _colors.clear();
+    }
+}
+
+inline void SoftRasterizer::attach_index_buffer(const unsigned* indices,
+                                                size_t size)
+{
+    if (indices != nullptr) { _indices.assign(indices, indices + size); }
+    else {
+        _indices.clear();
+    }
+}
+
+inline void SoftRasterizer::release_buffers()
+{
+    _positions.clear();
+    _normals.clear();
+    _colors.clear();
+    _indices.clear();
+}
+
+inline void SoftRasterizer::set_material(const Material& material)
+{
+    _material = material;
+}
+
+inline void SoftRasterizer::set_light(const Light& light)
+{
+    _light = light;
+}
+
+inline void SoftRasterizer::set_background(const Eigen::Array3f& color)
+{
+    _background = color;
+}
+
+inline void SoftRasterizer::set_background(float r, float g, float b)
+{
+    _background << r, g, b;
+}
+
+inline void SoftRasterizer::set_image(uint32_t width,
+                                      uint32_t height,
+                                      SampleCount samples)
+{
+    _width = width;
+    _height = height;
+    _samples = samples;
+    _tiles_x = (width + _impl::raster_tile_size - 1) / _impl::raster_tile_size;
+    _tiles_y =
+        (height + _impl::raster_tile_size - 1) / _impl::raster_tile_size;
+    const size_t size = static_cast<size_t>(width) * height;
+    _depth.resize(size * samples);
+    _faces.resize(size * samples);
+    const size_t blocks_x =
+        (width + _impl::raster_block_size - 1) / _impl::raster_block_size;
+    const size_t blocks_y =
+        (height + _impl::raster_block_size - 1) / _impl::raster_block_size;
+    _block_depth.resize(blocks_x * blocks_y);
+}
+
+inline void SoftRasterizer::render_shaded(const Eigen::Matrix4f& model,
+                                          const RasCamera& camera,
+                                          std::vector<uint8_t>& pixels,
+                                          bool interleaved)
+{
+    pixels.resize(3 * _width * _height);
+    _render(model, camera, [&](int x0, int y0, int x1, int y1) {
+        _resolve_color(true, interleaved, pixels.data(), x0, y0, x1, y1);
+    });
+}
+
+inline void SoftRasterizer::render_unlit(const Eigen::Matrix4f& model,
+                                         const RasCamera& camera,
+                                         std::vector<uint8_t>& pixels,
+                                         bool interleaved)
+{
+    pixels.resize(3 * _width * _height);
+    _render(model, camera, [&](int x0, int y0, int x1, int y1) {
+        _resolve_color(false, interleaved, pixels.data(), x0, y0, x1, y1);
+    });
+}
+
+inline void SoftRasterizer::render_depth(const Eigen::Matrix4f& model,
+                                         const RasCamera& camera,
+                                         std::vector<uint8_t>& pixels,
+                                         bool interleaved,
+                                         bool linear)
+{
+    const int size = _width * _height;
+    pixels.resize(3 * size);
+    auto linearize_depth = [&camera](float d) {
+        return camera.tnear * camera.tfar /
+               (camera.tfar + d * (camera.tnear - camera.tfar));
+    };
+
+    _render(model, camera, [&](int x0, int y0, int x1, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                auto d = _resolve_depth(x, y);
+                uint8_t color = 0;
+                if (linear) {
+                    color = 255 * linearize_depth(d) / camera.tfar;
+                }
+                else {
+                    color = 255 * d;
+                }
+                auto idx = y * _width + x;
+                if (interleaved) {
+                    pixels[3 * idx + 0] = color;
+                    pixels[3 * idx + 1] = color;
+                    pixels[3 * idx + 2] = color;
+                }
+                else {
+                    pixels[idx] = color;
+                    pixels[size + idx] = color;
+                    pixels[2 * size + idx] = color;
+                }
+            }
+        }
+    });
+}
+
+inline void SoftRasterizer::render_depth(const Eigen::Matrix4f& model,
+                                         const RasCamera& camera,
+                                         std::vector<float>& values,
+                                         bool linear)
+{
+    values.resize(_width * _height);
+    auto linearize_depth = [&camera](float d) {
+        return camera.tnear * camera.tfar /
+               (camera.tfar + d * (camera.tnear - camera.tfar));
+    };
+
+    _render(model, camera, [&](int x0, int y0, int x1, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                auto d = _resolve_depth(x, y);
+                values[y * _width + x] = linear ? linearize_depth(d) : d;
+            }
+        }
+    });
+}
+
+template<typename Resolve>
+inline void SoftRasterizer::_render(const Eigen::Matrix4f& model,
+                                    const RasCamera& camera,
+                                    Resolve resolve)
+{
+    _transform = Transform(model, camera.view(), camera.projection());
+
+    // Set up and bin the triangles, in chunks so that each tile could still
+    // draw them in submission order
+    const int faces = static_cast<int>(
+        _indices.empty() ? _positions.size() / 9 : _indices.size() / 3);
+    const int chunks =
+        (faces + _impl::raster_chunk_size - 1) / _impl::raster_chunk_size;
+    const int tiles = _tiles_x * _tiles_y;
+    _triangles.resize(chunks);
+    _bins.resize(static_cast<size_t>(chunks) * tiles);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < chunks; ++c) {
+        auto& triangles = _triangles[c];
+        auto bins = _bins.data() + static_cast<size_t>(c) * tiles;
+        triangles.clear();
+        for (int t = 0; t < tiles; ++t) {
+            bins[t].clear();
+        }
+        auto begin = c * _impl::raster_chunk_size;
+        auto end = std::min(begin + _impl::raster_chunk_size, faces);
+        for (int f = begin; f < end; ++f) {
+            _setup_triangle(f, triangles, bins);
+        }
+    }
+
+    // Each tile is cleared, rasterized and resolved by one thread
+#pragma omp parallel for schedule(dynamic)
+    for (int t = 0; t < tiles; ++t) {
+        const int x0 = (t % _tiles_x) * _impl::raster_tile_size;
+        const int y0 = (t / _tiles_x) * _impl::raster_tile_size;
+        const int x1 =
+            std::min(x0 + _impl::raster_tile_size, static_cast<int>(_width));
+        const int y1 =
+            std::min(y0 + _impl::raster_tile_size, static_cast<int>(_height));
+        _clear_tile(x0, y0, x1, y1);
+        for (int c = 0; c < chunks; ++c) {
+            const auto& triangles = _triangles[c];
+            for (auto i : _bins[static_cast<size_t>(c) * tiles + t]) {
+                _rasterize(triangles[i], x0, y0, x1, y1);
+            }
+        }
+        resolve(x0, y0, x1, y1);
+    }
+}
+
+inline void SoftRasterizer::_setup_triangle(uint32_t prim,
+                                            std::vector<Triangle>& triangles,
+                                            std::vector<uint32_t>* bins)
+{
+    Eigen::Vector4f v[3];
+    for (int k = 0; k < 3; ++k) {
+        auto i = _vertex(prim, k);
+        Eigen::Vector4f p(_positions[3 * i + 0],
+                          _positions[3 * i + 1],
+                          _positions[3 * i + 2],
+                          1.0f);
+        v[k] = _transform.mvp * p;
+    }
+
+    // Reject triangles outside of the view frustum
+    for (int axis = 0; axis < 3; ++axis) {
+        auto low = axis == 2 ? 0.0f : -1.0f;
+        int below = 0;
+        int above = 0;
+        for (int k = 0; k < 3; ++k) {
+            below += v[k](axis) < low * v[k](3);
+            above += v[k](axis) > v[k](3);
+        }
+        if (below == 3 || above == 3) { return; }
+    }
+
+    const auto g = _impl::raster_guard_band;
+    const Eigen::Vector4f planes[] = { { 0.0f, 0.0f, 1.0f, 0.0f },
+                                       { 0.0f, 0.0f, -1.0f, 1.0f },
+                                       { 1.0f, 0.0f, 0.0f, g },
+                                       { -1.0f, 0.0f, 0.0f, g },
+                                       { 0.0f, 1.0f, 0.0f, g },
+                                       { 0.0f, -1.0f, 0.0f, g } };
+    bool inside = true;
+    for (const auto& plane : planes) {
+        for (int k = 0; k < 3; ++k) {
+            inside = inside && plane.dot(v[k]) >= 0.0f;
+        }
+    }
+    if (inside) {
+        _emit_triangle(v[0], v[1], v[2], prim, triangles, bins);
+        return;
+    }
+
+    // Clip against the near and far planes and the guard band, then emit the
+    // resulting polygon as a fan
+    Eigen::Vector4f polygon[2][16];
+    std::copy(v, v + 3, polygon[0]);
+    int n = 3;
+    int current = 0;
+    for (const auto& plane : planes) {
+        n = _impl::clip_polygon(
+            polygon[current], n, plane, polygon[1 - current]);
+        current = 1 - current;
+        if (n < 3) { return; }
+    }
+    for (int k = 1; k + 1 < n; ++k) {
+        _emit_triangle(polygon[current][0],
+                       polygon[current][k],
+                       polygon[current][k + 1],
+                       prim,
+                       triangles,
+                       bins);
+    }
+}
+
+inline void SoftRasterizer::_emit_triangle(const Eigen::Vector4f& v0,
+                                           const Eigen::Vector4f& v1,
+                                           const Eigen::Vector4f& v2,
+                                           uint32_t prim,
+                                           std::vector<Triangle>& triangles,
+                                           std::vector<uint32_t>* bins)
+{
+    const Eigen::Vector4f* v[] = { &v0, &v1, &v2 };
+    Triangle triangle;
+    float z[3];
+    for (int k = 0; k < 3; ++k) {
+        auto inv_w = 1.0f / (*v[k])(3);
+        auto sx = ((*v[k])(0) * inv_w * 0.5f + 0.5f) * _width;
+        auto sy = ((*v[k])(1) * inv_w * 0.5f + 0.5f) * _height;
+        triangle.x[k] = static_cast<int32_t>(
+            std::lround(sx * _impl::raster_subpixel_scale));
+        triangle.y[k] = static_cast<int32_t>(
+            std::lround(sy * _impl::raster_subpixel_scale));
+        z[k] = std::min(std::max((*v[k])(2) * inv_w, 0.0f), 1.0f);
+    }
+
+    // Counter clockwise triangles are front facing, as in the Vulkan
+    // pipeline, and they have negative area in the y-down framebuffer
+    int64_t area =
+        static_cast<int64_t>(triangle.x[1] - triangle.x[0]) *
+            (triangle.y[2] - triangle.y[0]) -
+        static_cast<int64_t>(triangle.x[2] - triangle.x[0]) *
+            (triangle.y[1] - triangle.y[0]);
+    if (area >= 0) { return; }
+    std::swap(triangle.x[1], triangle.x[2]);
+    std::swap(triangle.y[1], triangle.y[2]);
+    std::swap(z[1], z[2]);
+
+    auto xmin = std::min({ triangle.x[0], triangle.x[1], triangle.x[2] });
+    auto xmax = std::max({ triangle.x[0], triangle.x[1], triangle.x[2] });
+    auto ymin = std::min({ triangle.y[0], triangle.y[1], triangle.y[2] });
+    auto ymax = std::max({ triangle.y[0], triangle.y[1], triangle.y[2] });
+    triangle.xmin = std::max(_impl::raster_floor(xmin), 0);
+    triangle.ymin = std::max(_impl::raster_floor(ymin), 0);
+    triangle.xmax =
+        std::min(_impl::raster_floor(xmax), static_cast<int>(_width) - 1);
+    triangle.ymax =
+        std::min(_impl::raster_floor(ymax), static_cast<int>(_height) - 1);
+    if (triangle.xmin > triangle.xmax || triangle.ymin > triangle.ymax) {
+        return;
+    }
+
+    // Depth is affine in screen space
+    const auto scale = 1.0f / _impl::raster_subpixel_scale;
+    float x[3], y[3];
+    for (int k = 0; k < 3; ++k) {
+        x[k] = triangle.x[k] * scale;
+        y[k] = triangle.y[k] * scale;
+    }
+    auto denom = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    triangle.xa = x[0];
+    triangle.ya = y[0];
+    triangle.za = z[0];
+    triangle.dzdx =
+        ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) /
+        denom;
+    triangle.dzdy =
+        ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) /
+        denom;
+    triangle.zmin = std::min({ z[0], z[1], z[2] });
+    triangle.prim = prim;
+
+    const auto index = static_cast<uint32_t>(triangles.size());
+    triangles.push_back(triangle);
+    const auto tx0 = triangle.xmin / _impl::raster_tile_size;
+    const auto tx1 = triangle.xmax / _impl::raster_tile_size;
+    const auto ty0 = triangle.ymin / _impl::raster_tile_size;
+    const auto ty1 = triangle.ymax / _impl::raster_tile_size;
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        for (int tx = tx0; tx <= tx1; ++tx) {
+            bins[ty * _tiles_x + tx].push_back(index);
+        }
+    }
+}
+
+inline void SoftRasterizer::_rasterize(const Triangle& triangle,
+                                       int x0,
+                                       int y0,
+                                       int x1,
+                                       int y1)
+{
+    const int xmin = std::max(triangle.xmin, x0);
+    const int xmax = std::min(triangle.xmax, x1 - 1);
+    const int ymin = std::max(triangle.ymin, y0);
+    const int ymax = std::min(triangle.ymax, y1 - 1);
+    if (xmin > xmax || ymin > ymax) { return; }
+
+    // Edge functions a * x + b * y + c, positive inside the triangle. Samples
+    // exactly on an edge only belong to the triangle if it's a top or left
+    // edge, so that shared edges are drawn once.
+    int64_t a[3], b[3], c[3];
+    for (int k = 0; k < 3; ++k) {
+        auto i = k;
+        auto j = (k + 1) % 3;
+        int64_t dx = triangle.x[j] - triangle.x[i];
+        int64_t dy = triangle.y[j] - triangle.y[i];
+        a[k] = -dy;
+        b[k] = dx;
+        c[k] = -(a[k] * triangle.x[i] + b[k] * triangle.y[i]);
+        bool top_left = (dy == 0 && dx > 0) || dy < 0;
+        if (!top_left) { c[k] -= 1; }
+    }
+
+    const int size = _width * _height;
+    const int samples = _samples;
+    const int* locations = _impl::raster_sample_locations(samples);
+    const int blocks_x =
+        (_width + _impl::raster_block_size - 1) / _impl::raster_block_size;
+    const int64_t one = _impl::raster_subpixel_scale;
+    const auto prim = triangle.prim;
+
+    const int bx0 = xmin / _impl::raster_block_size;
+    const int bx1 = xmax / _impl::raster_block_size;
+    const int by0 = ymin / _impl::raster_block_size;
+    const int by1 = ymax / _impl::raster_block_size;
+    for (int by = by0; by <= by1; ++by) {
+        for (int bx = bx0; bx <= bx1; ++bx) {
+            auto& block_depth = _block_depth[by * blocks_x + bx];
+            if (triangle.zmin > block_depth) { continue; }
+
+            const int cx0 = std::max(bx * _impl::raster_block_size, xmin);
+            const int cx1 =
+                std::min((bx + 1) * _impl::raster_block_size, xmax + 1);
+            const int cy0 = std::max(by * _impl::raster_block_size, ymin);
+            const int cy1 =
+                std::min((by + 1) * _impl::raster_block_size, ymax + 1);
+
+            // Skip the block if it's entirely outside of an edge
+            bool outside = false;
+            for (int k = 0; k < 3; ++k) {
+                auto ex = a[k] > 0 ? cx1 * one : cx0 * one;
+                auto ey = b[k] > 0 ? cy1 * one : cy0 * one;
+                outside = outside || a[k] * ex + b[k] * ey + c[k] < 0;
+            }
+            if (outside) { continue; }
+
+            bool covered = false;
+            for (int y = cy0; y < cy1; ++y) {
+                for (int s = 0; s < samples; ++s) {
+                    const int64_t px = cx0 * one + locations[2 * s] * 16;
+                    const int64_t py = y * one + locations[2 * s + 1] * 16;
+                    int64_t e0 = a[0] * px + b[0] * py + c[0];
+                    int64_t e1 = a[1] * px + b[1] * py + c[1];
+                    int64_t e2 = a[2] * px + b[2] * py + c[2];
+                    float z = triangle.za +
+                              triangle.dzdx *
+                                  (px * (1.0f / one) - triangle.xa) +
+                              triangle.dzdy * (py * (1.0f / one) - triangle.ya);
+                    auto depth = _depth.data() + s * size + y * _width;
+                    auto faces = _faces.data() + s * size + y * _width;
+                    for (int x = cx0; x < cx1; ++x) {
+                        auto zc = std::min(std::max(z, 0.0f), 1.0f);
+                        bool pass = ((e0 | e1 | e2) >= 0) & (zc <= depth[x]);
+                        depth[x] = pass ? zc : depth[x];
+                        faces[x] = pass ? prim : faces[x];
+                        covered |= pass;
+                        e0 += a[0] * one;
+                        e1 += a[1] * one;
+                        e2 += a[2] * one;
+                        z += triangle.dzdx;
+                    }
+                }
+            }
+
+            // Refresh the farthest depth of the block
+            if (covered) {
+                const int rx0 = bx * _impl::raster_block_size;
+                const int ry0 = by * _impl::raster_block_size;
+                const int rx1 = std::min(rx0 + _impl::raster_block_size,
+                                         static_cast<int>(_width));
+                const int ry1 = std::min(ry0 + _impl::raster_block_size,
+                                         static_cast<int>(_height));
+                float zmax = 0.0f;
+                for (int s = 0; s < samples; ++s) {
+                    for (int y = ry0; y < ry1; ++y) {
+                        auto depth = _depth.data() + s * size + y * _width;
+                        for (int x = rx0; x < rx1; ++x) {
+                            zmax = std::max(zmax, depth[x]);
+                        }
+                    }
+                }
+                block_depth = zmax;
+            }
+        }
+    }
+}
+
+inline void SoftRasterizer::_clear_tile(int x0, int y0, int x1, int y1)
+{
+    const int size = _width * _height;
+    for (int s = 0; s < _samples; ++s) {
+        for (int y = y0; y < y1; ++y) {
+            auto offset = s * size + y * _width;
+            std::fill(_depth.data() + offset + x0,
+                      _depth.data() + offset + x1,
+                      1.0f);
+            std::fill(_faces.data() + offset + x0,
+                      _faces.data() + offset + x1,
+                      _impl::raster_no_face);
+        }
+    }
+    const int blocks_x =
+        (_width + _impl::raster_block_size - 1) / _impl::raster_block_size;
+    for (int y = y0; y < y1; y += _impl::raster_block_size) {
+        for (int x = x0; x < x1; x += _impl::raster_block_size) {
+            _block_depth[y / _impl::raster_block_size * blocks_x +
+                         x / _impl::raster_block_size] = 1.0f;
+        }
+    }
+}
+
+inline Eigen::Array3f SoftRasterizer::_shade(uint32_t prim,
+                                             int x,
+                                             int y,
+                                             bool lit) const
+{
+    uint32_t v[3];
+    Eigen::Vector3f p[3];
+    Eigen::Vector3f ex, ey;
+    const auto nx = 2.0f * (x + 0.5f) / _width - 1.0f;
+    const auto ny = 2.0f * (y + 0.5f) / _height - 1.0f;
+    for (int k = 0; k < 3; ++k) {
+        v[k] = _vertex(prim, k);
+        p[k] = Eigen::Vector3f::Map(_positions.data() + 3 * v[k]);
+        Eigen::Vector4f clip = _transform.mvp * p[k].homogeneous();
+        ex(k) = clip(0) - nx * clip(3);
+        ey(k) = clip(1) - ny * clip(3);
+    }
+
+    // Perspective correct barycentric coordinates at the pixel center, which
+    // might lie outside of the triangle when multisampling
+    Eigen::Vector3f bary = ex.cross(ey);
+    auto sum = bary.sum();
+    if (sum != 0.0f) { bary /= sum; }
+    else {
+        bary.setConstant(1.0f / 3.0f);
+    }
+
+    Eigen::Array3f diffuse = _material.diffuse;
+    if (!_colors.empty()) {
+        diffuse.setZero();
+        for (int k = 0; k < 3; ++k) {
+            diffuse += bary(k) * Eigen::Array3f::Map(_colors.data() + 3 * v[k]);
+        }
+    }
+    if (!lit) { return _colors.empty() ? _material.ambient : diffuse; }
+
+    Eigen::Vector3f position = bary(0) * p[0] + bary(1) * p[1] + bary(2) * p[2];
+    Eigen::Vector3f normal;
+    if (!_normals.empty()) {
+        normal.setZero();
+        for (int k = 0; k < 3; ++k) {
+            normal +=
+                bary(k) * Eigen::Vector3f::Map(_normals.data() + 3 * v[k]);
+        }
+    }
+    else {
+        normal = (p[1] - p[0]).cross(p[2] - p[0]).normalized();
+    }
+
+    // Same as the Vulkan shaders, which transform by the upper 3x3 matrices
+    Eigen::Vector3f world_position =
+        _transform.model_matrix.topLeftCorner<3, 3>() * position;
+    Eigen::Vector3f world_normal =
+        _transform.normal_matrix.topLeftCorner<3, 3>() * normal;
+    Eigen::Vector3f light_dir =
+        (_light.position.matrix() - world_position).normalized();
+    auto diff = std::max(world_normal.dot(light_dir), 0.0f);
+    return (_material.ambient + diffuse * diff) * _light.color *
+           _light.intensity;
+}
+
+inline void SoftRasterizer::_resolve_color(bool lit,
+                                           bool interleaved,
+                                           uint8_t* pixels,
+                                           int x0,
+                                           int y0,
+                                           int x1,
+                                           int y1) const
+{
+    const int size = _width * _height;
+    const int samples = _samples;
+    const Eigen::Array3f background = _background.min(1.0f).max(0.0f);
+    uint32_t faces[8];
+    Eigen::Array3f colors[8];
+
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            const int idx = y * _width + x;
+            Eigen::Array3f color = Eigen::Array3f::Zero();
+            for (int s = 0; s < samples; ++s) {
+                faces[s] = _faces[s * size + idx];
+                int j = 0;
+                while (j < s && faces[j] != faces[s]) {
+                    ++j;
+                }
+                if (j < s) { colors[s] = colors[j]; }
+                else if (faces[s] == _impl::raster_no_face) {
+                    colors[s] = background;
+                }
+                else {
+                    colors[s] =
+                        _shade(faces[s], x, y, lit).min(1.0f).max(0.0f);
+                }
+                color += colors[s];
+            }
+            color *= 255.0f / samples;
+
+            for (int c = 0; c < 3; ++c) {
+                auto value = static_cast<uint8_t>(color(c) + 0.5f);
+                if (interleaved) { pixels[3 * idx + c] = value; }
+                else {
+                    pixels[c * size + idx] = value;
+                }
+            }
+        }
+    }
+}
+
+inline float SoftRasterizer::_resolve_depth(int x, int y) const
+{
+    const int size = _width * _height;
+    const int idx = y * _width + x;
+    float depth = 0.0f;
+    for (int s = 0; s < _samples; ++s) {
+        depth += _depth[s * size + idx];
+    }
+    return depth / _samples;
+}
+
+inline uint32_t SoftRasterizer::_vertex(uint32_t prim, int corner) const
+{
+    return _indices.empty() ? 3 * prim + corner : _indices[3 * prim + corner];
+}
+
+} // namespace Euclid
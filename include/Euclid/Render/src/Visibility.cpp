@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <boost/math/constants/constants.hpp>
+#include <Eigen/Core>
+#include <Euclid/Render/RayTracer.h>
+
+namespace Euclid
+{
+
+namespace _impl
+{
+
+/** Number of elements in a chunk scheduled among threads.*/
+constexpr const int bake_chunk_size = 64;
+
+/** Compute the ray origins and unit normals of the elements to bake.
+ *
+ *  Origins are lifted off the surface along the normals by a small offset, to
+ *  avoid hitting the element itself.
+ */
+inline void bake_samples(const RayScene& scene,
+                         BakeElement element,
+                         Eigen::Matrix3Xf& origins,
+                         Eigen::Matrix3Xf& normals)
+{
+    if (scene.empty()) {
+        throw std::invalid_argument("No geometry is attached to the scene.");
+    }
+    const auto& positions = *scene.positions();
+    const auto& indices = *scene.indices();
+    const auto nv = static_cast<int>(positions.size() / 3);
+    const auto nf = static_cast<int>(indices.size() / 3);
+    Eigen::Map<const Eigen::Matrix3Xf> vertices(positions.data(), 3, nv);
+
+    Eigen::Vector3f lower = vertices.rowwise().minCoeff();
+    Eigen::Vector3f upper = vertices.rowwise().maxCoeff();
+    const auto offset = 1e-4f * (upper - lower).norm();
+
+    // area weighted face normals
+    Eigen::Matrix3Xf face_normals(3, nf);
+    for (int f = 0; f < nf; ++f) {
+        Eigen::Vector3f v0 = vertices.col(indices[3 * f]);
+        Eigen::Vector3f v1 = vertices.col(indices[3 * f + 1]);
+        Eigen::Vector3f v2 = vertices.col(indices[3 * f + 2]);
+        face_normals.col(f) = (v1 - v0).cross(v2 - v0);
+    }
+
+    if (element == BakeElement::face) {
+        origins.resize(3, nf);
+        normals = face_normals;
+        for (int f = 0; f < nf; ++f) {
+            origins.col(f) = (vertices.col(indices[3 * f]) +
+                              vertices.col(indices[3 * f + 1]) +
+                              vertices.col(indices[3 * f + 2])) /
+                             3.0f;
+        }
+    }
+    else {
+        origins = vertices;
+        normals.setZero(3, nv);
+        for (int f = 0; f < nf; ++f) {
+            for (int i = 0; i < 3; ++i) {
+                normals.col(indices[3 * f + i]) += face_normals.col(f);
+            }
+        }
+    }
+
+    for (int i = 0; i < normals.cols(); ++i) {
+        auto norm = normals.col(i).norm();
+        if (norm > 0.0f) { normals.col(i) /= norm; }
+    }
+    origins += offset * normals;
+}
+
+/** Build an orthonormal basis (t, b, n) from a unit vector n.
+ *
+ *  **Reference**
+ *
+ *  Duff T, Burgess J, Christensen P, et al.
+ *  Building an Orthonormal Basis, Revisited.
+ *  Journal of Computer Graphics Techniques, 2017.
+ */
+inline void make_frame(const Eigen::Vector3f& n,
+                       Eigen::Vector3f& t,
+                       Eigen::Vector3f& b)
+{
+    auto sign = std::copysign(1.0f, n(2));
+    auto a = -1.0f / (sign + n(2));
+    auto c = n(0) * n(1) * a;
+    t << 1.0f + sign * n(0) * n(0) * a, sign * c, -sign * n(0);
+    b << c, sign + n(1) * n(1) * a, -n(1);
+}
+
+/** Fill an occlusion ray.*/
+inline void make_ray(const Eigen::Vector3f& origin,
+                     const Eigen::Vector3f& direction,
+                     float tfar,
+                     RTCRay& ray)
+{
+    ray.org_x = origin(0);
+    ray.org_y = origin(1);
+    ray.org_z = origin(2);
+    ray.dir_x = direction(0);
+    ray.dir_y = direction(1);
+    ray.dir_z = direction(2);
+    ray.tnear = 0.0f;
+    ray.tfar = tfar;
+    ray.time = 0.0f;
+    ray.mask = 0xFFFFFFFF;
+    ray.id = 0;
+    ray.flags = 0;
+}
+
+/** Trace a stream of occlusion rays and count the unoccluded ones.*/
+inline int count_unoccluded(const RayScene& scene,
+                            std::vector<RTCRay>& rays,
+                            int count)
+{
+    if (count == 0) { return 0; }
+    RTCIntersectContext context;
+    rtcInitIntersectContext(&context);
+    rtcOccluded1M(scene.scene(), &context, rays.data(), count, sizeof(RTCRay));
+
+    int unoccluded = 0;
+    for (int i = 0; i < count; ++i) {
+        if (rays[i].tfar >= 0.0f) { ++unoccluded; }
+    }
+    return unoccluded;
+}
+
+} // namespace _impl
+
+template<typename T>
+void ambient_occlusion(const RayScene& scene,
+                       std::vector<T>& occlusion,
+                       BakeElement element,
+                       int samples,
+                       float max_distance)
+{
+    if (samples < 1) {
+        throw std::invalid_argument("Number of samples must be positive.");
+    }
+    Eigen::Matrix3Xf origins;
+    Eigen::Matrix3Xf normals;
+    _impl::bake_samples(scene, element, origins, normals);
+    const auto n = static_cast<int>(origins.cols());
+    const auto chunks =
+        (n + _impl::bake_chunk_size - 1) / _impl::bake_chunk_size;
+    const auto two_pi = boost::math::float_constants::two_pi;
+    occlusion.assign(n, static_cast<T>(0));
+
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < chunks; ++c) {
+        std::vector<RTCRay> rays(samples);
+        auto end = std::min(n, (c + 1) * _impl::bake_chunk_size);
+        for (int e = c * _impl::bake_chunk_size; e < end; ++e) {
+            Eigen::Vector3f normal = normals.col(e);
+            if (normal.isZero()) { continue; }
+            Eigen::Vector3f t, b;
+            _impl::make_frame(normal, t, b);
+
+            // cosine weighted directions from a shifted R2 sequence
+            auto shift_x = _impl::random_float(e, 0);
+            auto shift_y = _impl::random_float(e, 1);
+            for (int s = 0; s < samples; ++s) {
+                auto u1 = shift_x + s * _impl::r2_alpha_x;
+                auto u2 = shift_y + s * _impl::r2_alpha_y;
+                u1 -= std::floor(u1);
+                u2 -= std::floor(u2);
+                auto r = std::sqrt(u1);
+                auto phi = two_pi * u2;
+                Eigen::Vector3f dir = r * std::cos(phi) * t +
+                                      r * std::sin(phi) * b +
+                                      std::sqrt(1.0f - u1) * normal;
+                _impl::make_ray(origins.col(e), dir, max_distance, rays[s]);
+            }
+
+            auto unoccluded = _impl::count_unoccluded(scene, rays, samples);
+            occlusion[e] =
+                static_cast<T>(1.0 - unoccluded / static_cast<double>(samples));
+        }
+    }
+}
+
+template<typename T>
+void view_visibility(const RayScene& scene,
+                     std::vector<T>& visibility,
+                     BakeElement element,
+                     int samples)
+{
+    if (samples < 1) {
+        throw std::invalid_argument("Number of samples must be positive.");
+    }
+    Eigen::Matrix3Xf origins;
+    Eigen::Matrix3Xf normals;
+    _impl::bake_samples(scene, element, origins, normals);
+    const auto n = static_cast<int>(origins.cols());
+    const auto chunks =
+        (n + _impl::bake_chunk_size - 1) / _impl::bake_chunk_size;
+    visibility.assign(n, static_cast<T>(0));
+
+    // uniform view directions on a Fibonacci sphere
+    const auto golden_angle =
+        boost::math::float_constants::pi * (3.0f - std::sqrt(5.0f));
+    Eigen::Matrix3Xf views(3, samples);
+    for (int s = 0; s < samples; ++s) {
+        auto z = 1.0f - (2.0f * s + 1.0f) / samples;
+        auto r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+        auto phi = golden_angle * s;
+        views.col(s) << r * std::cos(phi), r * std::sin(phi), z;
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < chunks; ++c) {
+        std::vector<RTCRay> rays(samples);
+        auto end = std::min(n, (c + 1) * _impl::bake_chunk_size);
+        for (int e = c * _impl::bake_chunk_size; e < end; ++e) {
+            int count = 0;
+            for (int s = 0; s < samples; ++s) {
+                if (normals.col(e).dot(views.col(s)) <= 0.0f) { continue; }
+                _impl::make_ray(origins.col(e),
+                                views.col(s),
+                                std::numeric_limits<float>::infinity(),
+                                rays[count++]);
+            }
+
+            auto unoccluded = _impl::count_unoccluded(scene, rays, count);
+            visibility[e] =
+                static_cast<T>(unoccluded / static_cast<double>(samples));
+        }
+    }
+}
+
+} // namespace Euclid
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <CGAL/boost/graph/properties.h>
+#include <Euclid/Render/RayScene.h>
 #include <Euclid/ViewSelection/ViewSphere.h>
 
 namespace Euclid
@@ -18,6 +20,8 @@ namespace Euclid
  *  @param view_scores The corresponding view scores.
  *  @param weight The weighting of the projected area term, (1 - weight) is the
  *  weighting for the visible ratio term.
+ *  @param scene An optional ray tracing scene of the mesh, which could be
+ *  shared with other algorithms to avoid building it again.
  *
  *  **Reference**
  *
@@ -29,7 +33,8 @@ template<typename Mesh, typename T>
 void proxy_view(const Mesh& mesh,
                 const ViewSphere<Mesh>& view_sphere,
                 std::vector<T>& view_scores,
-                float weight = 0.5f);
+                float weight = 0.5f,
+                std::shared_ptr<RayScene> scene = nullptr);
 
 /** @}*/
 } // namespace Euclid
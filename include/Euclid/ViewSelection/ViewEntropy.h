@@ -1,7 +1,9 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <CGAL/boost/graph/properties.h>
+#include <Euclid/Render/RayScene.h>
 #include <Euclid/ViewSelection/ViewSphere.h>
 
 namespace Euclid
@@ -14,9 +16,21 @@ namespace Euclid
  *  visibility and computes entropy based on it. It encourages all faces to have
  *  the same projected area.
  *
+ *  Views are rendered as face histograms in batches, which are traced
+ *  concurrently and reuse the same buffers. If candidates is positive, all
+ *  views are first scored at a quarter of the resolution, and only the
+ *  candidates best views are scored again at the full resolution, while the
+ *  others are given a score of 0, since entropies at different resolutions
+ *  are not comparable.
+ *
  *  @param mesh The target mesh model.
  *  @param view_sphere The viewing sphere.
- *  @param view_scores The corresponding view scores.
+ *  @param view_scores The corresponding view scores, appended to the vector.
+ *  @param scene An optional ray tracing scene of the mesh, which could be
+ *  shared with other algorithms to avoid building it again.
+ *  @param resolution Width and height of the rendered views.
+ *  @param candidates Number of views to refine after the coarse pass, 0 to
+ *  score all views at the full resolution directly.
  *
  *  **Reference**
  *
@@ -27,7 +41,42 @@ namespace Euclid
 template<typename Mesh, typename T>
 void view_entropy(const Mesh& mesh,
                   const ViewSphere<Mesh>& view_sphere,
-                  std::vector<T>& view_scores);
+                  std::vector<T>& view_scores,
+                  std::shared_ptr<RayScene> scene = nullptr,
+                  int resolution = 256,
+                  size_t candidates = 0);
+
+/** Adaptive view selection using view entropy.
+ *
+ *  Instead of scoring every view of a dense view sphere, the search starts
+ *  from the vertices of a coarse view sphere, e.g. one made by
+ *  ViewSphere::make_subdiv with one iteration. In each round, the triangles
+ *  around the best views are split into four, and only the new views are
+ *  scored, until the edges around the best views are shorter than the given
+ *  angular precision. Only the region near the best views is refined, so far
+ *  fewer views are rendered than with a uniform sphere of the same precision.
+ *
+ *  @param mesh The target mesh model.
+ *  @param view_sphere The coarse viewing sphere to start from.
+ *  @param views The best views found, from the best to the worst.
+ *  @param view_scores The corresponding view scores.
+ *  @param best The number of best views to refine and return.
+ *  @param precision The angular precision in degrees.
+ *  @param scene An optional ray tracing scene of the mesh, which could be
+ *  shared with other algorithms to avoid building it again.
+ *  @param resolution Width and height of the rendered views.
+ *
+ *  @sa view_entropy
+ */
+template<typename Mesh, typename T>
+void view_entropy_adaptive(const Mesh& mesh,
+                           const ViewSphere<Mesh>& view_sphere,
+                           std::vector<Point_3_t<Mesh>>& views,
+                           std::vector<T>& view_scores,
+                           int best = 4,
+                           T precision = 4.0,
+                           std::shared_ptr<RayScene> scene = nullptr,
+                           int resolution = 256);
 
 /** @}*/
 } // namespace Euclid
@@ -16,7 +16,8 @@ template<typename Mesh, typename T>
 void proxy_view(const Mesh& mesh,
                 const ViewSphere<Mesh>& view_sphere,
                 std::vector<T>& view_scores,
-                float weight)
+                float weight,
+                std::shared_ptr<RayScene> scene)
 {
     using Point_3 = typename boost::property_traits<
         typename boost::property_map<Mesh,
@@ -38,14 +39,17 @@ void proxy_view(const Mesh& mesh,
     // Compute projected area
     std::vector<float> positions;
     std::vector<unsigned> indices;
-    extract_mesh<3>(mesh, positions, indices);
-    positions.push_back(0.0f); // Embree alignment
-    RayTracer raytracer;
-    raytracer.attach_geometry_buffers(positions, indices);
+    if (!scene) {
+        extract_mesh<3>(mesh, positions, indices);
+        positions.push_back(0.0f); // Embree alignment
+        scene = std::make_shared<RayScene>(positions, indices);
+    }
+    RayTracer raytracer(scene);
 
-    std::vector<float> projected_areas(proxies);
-    for (size_t i = 0; i < projected_areas.size(); ++i) {
-        OrthoRayCamera cam;
+    std::vector<OrthoRayCamera> cams(proxies);
+    std::vector<const RayCamera*> cam_ptrs;
+    for (size_t i = 0; i < cams.size(); ++i) {
+        auto& cam = cams[i];
         auto view_dir = view_sphere.radius * obb.axis(i % 3);
         if (i >= 3) {
             view_dir = -view_dir;
@@ -56,16 +60,20 @@ void proxy_view(const Mesh& mesh,
         cgal_to_eigen(obb.axis((i + 1) % 3), up);
         cam.lookat(pos, focus, up);
         cam.set_extent(view_sphere.radius * 2.0f, view_sphere.radius * 2.0f);
+        cam_ptrs.push_back(&cam);
+    }
 
-        std::vector<uint8_t> pixels(width * height, 0);
-        raytracer.render_silhouette(pixels, cam, width, height);
-        auto proj = 0;
-        for (size_t j = 0; j < pixels.size(); ++j) {
-            if (pixels[j] != 0) {
-                ++proj;
-            }
-        }
-        projected_areas[i] = static_cast<float>(proj) / pixels.size();
+    const int size = width * height;
+    std::vector<uint8_t> pixels(proxies * size, 0);
+    raytracer.render_batch(
+        pixels.data(), cam_ptrs, width, height, RenderMode::silhouette);
+
+    std::vector<float> projected_areas(proxies);
+    for (size_t i = 0; i < projected_areas.size(); ++i) {
+        auto proj = std::count_if(pixels.begin() + i * size,
+                                  pixels.begin() + (i + 1) * size,
+                                  [](uint8_t p) { return p != 0; });
+        projected_areas[i] = static_cast<float>(proj) / size;
     }
     auto max_proj_area =
         *std::max_element(projected_areas.begin(), projected_areas.end());
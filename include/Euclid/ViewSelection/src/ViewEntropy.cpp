@@ -1,6 +1,13 @@
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
+#include <boost/math/constants/constants.hpp>
 #include <CGAL/Min_sphere_of_spheres_d.h>
 #include <CGAL/Plane_3.h>
 #include <Euclid/MeshUtil/CGALMesh.h>
@@ -10,65 +17,296 @@
 namespace Euclid
 {
 
+namespace _impl
+{
+
+/** The orthographic camera looking at the center from a view point.*/
+template<typename Mesh>
+OrthoRayCamera entropy_camera(const Point_3_t<Mesh>& view,
+                              const ViewSphere<Mesh>& view_sphere)
+{
+    using Kernel = Kernel_t<Mesh>;
+
+    Eigen::Vector3f position, center, up;
+    cgal_to_eigen(view, position);
+    cgal_to_eigen(view_sphere.center, center);
+    CGAL::Plane_3<Kernel> tangent_plane(view, view - view_sphere.center);
+    cgal_to_eigen(tangent_plane.base1(), up);
+    float extent = 1.5f * view_sphere.radius;
+    // this algorithm only works with orthogonal projection
+    return OrthoRayCamera(position,
+                          center,
+                          up,
+                          extent,
+                          extent,
+                          0.001f,
+                          view_sphere.radius * 2.0f);
+}
+
+/** Score views by their view entropy.
+ *
+ *  The buffers are reused across calls.
+ */
+template<typename T>
+class EntropyScorer
+{
+public:
+    explicit EntropyScorer(std::shared_ptr<RayScene> scene)
+        : _raytracer(scene)
+    {
+        if (scene->indices() == nullptr) {
+            throw std::invalid_argument("The scene has no geometry.");
+        }
+        // count the pixels of each face, including background, in batches of
+        // views to bound the memory usage
+        _bins = scene->indices()->size() / 3 + 1;
+        _proj_areas.resize(batch * _bins);
+        _batch_cameras.reserve(batch);
+    }
+
+    void score(const std::vector<OrthoRayCamera>& cameras,
+               const std::vector<size_t>& views,
+               int size,
+               std::vector<T>& scores)
+    {
+        const T pixels = static_cast<T>(size) * size;
+        for (size_t first = 0; first < views.size(); first += batch) {
+            auto last = std::min(first + batch, views.size());
+            _batch_cameras.clear();
+            for (auto i = first; i < last; ++i) {
+                _batch_cameras.push_back(&cameras[views[i]]);
+            }
+            _raytracer.render_batch(_proj_areas.data(),
+                                    _batch_cameras,
+                                    size,
+                                    size,
+                                    RenderMode::histogram);
+
+            // computing view entropy
+            const auto n = static_cast<int>(last - first);
+#pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < n; ++i) {
+                auto entropy = static_cast<T>(0.0);
+                const auto areas = _proj_areas.data() + i * _bins;
+                for (size_t j = 0; j < _bins; ++j) {
+                    if (areas[j] != 0) {
+                        auto p = static_cast<T>(areas[j]) / pixels;
+                        entropy += -p * std::log(p);
+                    }
+                }
+                scores[views[first + i]] = entropy;
+            }
+        }
+    }
+
+private:
+    static constexpr const size_t batch = 16;
+
+    RayTracer _raytracer;
+    size_t _bins;
+    std::vector<uint32_t> _proj_areas;
+    std::vector<const RayCamera*> _batch_cameras;
+};
+
+template<typename Mesh>
+std::shared_ptr<RayScene> entropy_scene(const Mesh& mesh,
+                                        std::shared_ptr<RayScene> scene)
+{
+    if (!scene) {
+        std::vector<float> positions;
+        std::vector<unsigned> indices;
+        extract_mesh<3>(mesh, positions, indices);
+        positions.push_back(0.0f); // Embree alignment
+        scene = std::make_shared<RayScene>(positions, indices);
+    }
+    return scene;
+}
+
+} // namespace _impl
+
 template<typename Mesh, typename T>
 void view_entropy(const Mesh& mesh,
                   const ViewSphere<Mesh>& view_sphere,
-                  std::vector<T>& view_scores)
+                  std::vector<T>& view_scores,
+                  std::shared_ptr<RayScene> scene,
+                  int resolution,
+                  size_t candidates)
 {
-    using VPMap =
-        typename boost::property_map<Mesh, boost::vertex_point_t>::type;
-    using Point_3 = typename boost::property_traits<VPMap>::value_type;
-    using Kernel = typename CGAL::Kernel_traits<Point_3>::Kernel;
+    constexpr const int coarse_factor = 4;
 
-    constexpr const int width = 256;
-    constexpr const int height = 256;
-    constexpr const int size = width * height;
+    if (resolution <= 0) {
+        throw std::invalid_argument("Resolution must be positive.");
+    }
 
     auto vs_vpmap = get(boost::vertex_point, view_sphere.mesh);
-    Eigen::Vector3f center;
-    cgal_to_eigen(view_sphere.center, center);
-    float extent = 1.5f * view_sphere.radius;
+    std::vector<OrthoRayCamera> cameras;
+    for (const auto& v : vertices(view_sphere.mesh)) {
+        cameras.push_back(
+            _impl::entropy_camera(get(vs_vpmap, v), view_sphere));
+    }
+    _impl::EntropyScorer<T> scorer(_impl::entropy_scene(mesh, scene));
+
+    std::vector<size_t> views(cameras.size());
+    std::iota(views.begin(), views.end(), 0);
+    std::vector<T> scores(cameras.size(), static_cast<T>(0.0));
+    const auto coarse = resolution / coarse_factor;
+    if (candidates == 0 || candidates >= views.size() || coarse == 0) {
+        scorer.score(cameras, views, resolution, scores);
+    }
+    else {
+        // score all views coarsely, then refine the best candidates, coarse
+        // scores are not comparable with refined ones so they are dropped
+        scorer.score(cameras, views, coarse, scores);
+        std::partial_sort(views.begin(),
+                          views.begin() + candidates,
+                          views.end(),
+                          [&scores](size_t lhs, size_t rhs) {
+                              return scores[lhs] > scores[rhs];
+                          });
+        std::fill(scores.begin(), scores.end(), static_cast<T>(0.0));
+        views.resize(candidates);
+        scorer.score(cameras, views, resolution, scores);
+    }
+    view_scores.insert(view_scores.end(), scores.begin(), scores.end());
+}
+
+template<typename Mesh, typename T>
+void view_entropy_adaptive(const Mesh& mesh,
+                           const ViewSphere<Mesh>& view_sphere,
+                           std::vector<Point_3_t<Mesh>>& views,
+                           std::vector<T>& view_scores,
+                           int best,
+                           T precision,
+                           std::shared_ptr<RayScene> scene,
+                           int resolution)
+{
+    using Edge = std::pair<uint32_t, uint32_t>;
+    using Triangle = std::array<uint32_t, 3>;
+
+    if (best <= 0) {
+        throw std::invalid_argument("Number of best views must be positive.");
+    }
+    if (precision <= 0) {
+        throw std::invalid_argument("Precision must be positive.");
+    }
+    if (resolution <= 0) {
+        throw std::invalid_argument("Resolution must be positive.");
+    }
 
+    // work on unit directions around the center
     std::vector<float> positions;
     std::vector<unsigned> indices;
-    extract_mesh<3>(mesh, positions, indices);
-    positions.push_back(0.0f); // Embree alignment
-    RayTracer raytracer;
-    raytracer.attach_geometry_buffers(positions, indices);
+    extract_mesh<3>(view_sphere.mesh, positions, indices);
+    Eigen::Vector3f center;
+    cgal_to_eigen(view_sphere.center, center);
+    std::vector<Eigen::Vector3f> dirs;
+    for (size_t i = 0; i < positions.size(); i += 3) {
+        Eigen::Vector3f p(positions[i], positions[i + 1], positions[i + 2]);
+        dirs.push_back((p - center).normalized());
+    }
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+    }
 
-    for (const auto& v : vertices(view_sphere.mesh)) {
-        std::vector<uint32_t> findices(size);
-        Eigen::Vector3f view;
-        cgal_to_eigen(get(vs_vpmap, v), view);
-        CGAL::Plane_3<Kernel> tangent_plane(
-            get(vs_vpmap, v), get(vs_vpmap, v) - view_sphere.center);
-        Eigen::Vector3f up;
-        cgal_to_eigen(tangent_plane.base1(), up);
-        // this algorithm only works with orthogonal projection
-        OrthoRayCamera camera(view,
-                              center,
-                              up,
-                              extent,
-                              extent,
-                              0.001f,
-                              view_sphere.radius * 2.0f);
-        raytracer.render_index(findices, camera, width, height);
-
-        // counting pixels belonging to each face, including background
-        std::vector<int> proj_areas(num_faces(mesh) + 1, 0);
-        for (auto i : findices) {
-            ++proj_areas[i];
+    auto to_point = [&view_sphere](const Eigen::Vector3f& dir) {
+        return view_sphere.center +
+               view_sphere.radius *
+                   typename Kernel_t<Mesh>::Vector_3(dir(0), dir(1), dir(2));
+    };
+    std::vector<OrthoRayCamera> cameras;
+    for (const auto& dir : dirs) {
+        cameras.push_back(_impl::entropy_camera(to_point(dir), view_sphere));
+    }
+
+    _impl::EntropyScorer<T> scorer(_impl::entropy_scene(mesh, scene));
+    std::vector<T> scores(dirs.size());
+    std::vector<size_t> new_views(dirs.size());
+    std::iota(new_views.begin(), new_views.end(), 0);
+    scorer.score(cameras, new_views, resolution, scores);
+
+    const auto min_cos = std::cos(
+        static_cast<float>(precision) * boost::math::float_constants::degree);
+    std::map<Edge, uint32_t> midpoints;
+    auto midpoint = [&](uint32_t i, uint32_t j) {
+        Edge edge = std::minmax(i, j);
+        auto iter = midpoints.find(edge);
+        if (iter != midpoints.end()) {
+            return iter->second;
+        }
+        auto m = static_cast<uint32_t>(dirs.size());
+        dirs.push_back((dirs[i] + dirs[j]).normalized());
+        cameras.push_back(
+            _impl::entropy_camera(to_point(dirs.back()), view_sphere));
+        new_views.push_back(m);
+        midpoints.emplace(edge, m);
+        return m;
+    };
+
+    std::vector<size_t> order;
+    std::vector<bool> is_best;
+    std::vector<Triangle> refined;
+    while (true) {
+        // the best views found so far
+        order.resize(scores.size());
+        std::iota(order.begin(), order.end(), 0);
+        auto n = std::min(static_cast<size_t>(best), order.size());
+        std::partial_sort(order.begin(),
+                          order.begin() + n,
+                          order.end(),
+                          [&scores](size_t lhs, size_t rhs) {
+                              return scores[lhs] > scores[rhs];
+                          });
+        is_best.assign(scores.size(), false);
+        for (size_t i = 0; i < n; ++i) {
+            is_best[order[i]] = true;
         }
 
-        // computing view entropy
-        auto entropy = static_cast<T>(0.0);
-        for (auto a : proj_areas) {
-            if (a != 0) {
-                auto p = static_cast<T>(a) / size;
-                entropy += -p * std::log(p);
+        // split the coarse triangles touching a best view, either by a
+        // corner or by the midpoint of an edge split by a neighbour
+        bool split = false;
+        refined.clear();
+        new_views.clear();
+        for (const auto& t : triangles) {
+            bool touched = false;
+            bool coarse = false;
+            for (int k = 0; k < 3; ++k) {
+                auto i = t[k];
+                auto j = t[(k + 1) % 3];
+                touched = touched || is_best[i];
+                coarse = coarse || dirs[i].dot(dirs[j]) < min_cos;
+                auto iter = midpoints.find(std::minmax(i, j));
+                if (iter != midpoints.end()) {
+                    touched = touched || is_best[iter->second];
+                }
+            }
+            if (!touched || !coarse) {
+                refined.push_back(t);
+                continue;
             }
+            split = true;
+            auto m0 = midpoint(t[0], t[1]);
+            auto m1 = midpoint(t[1], t[2]);
+            auto m2 = midpoint(t[2], t[0]);
+            refined.push_back({ t[0], m0, m2 });
+            refined.push_back({ t[1], m1, m0 });
+            refined.push_back({ t[2], m2, m1 });
+            refined.push_back({ m0, m1, m2 });
         }
-        view_scores.push_back(entropy);
+        if (!split) {
+            break;
+        }
+        std::swap(triangles, refined);
+        scores.resize(dirs.size());
+        scorer.score(cameras, new_views, resolution, scores);
+    }
+
+    views.clear();
+    view_scores.clear();
+    auto n = std::min(static_cast<size_t>(best), order.size());
+    for (size_t i = 0; i < n; ++i) {
+        views.push_back(to_point(dirs[order[i]]));
+        view_scores.push_back(scores[order[i]]);
     }
 }
 
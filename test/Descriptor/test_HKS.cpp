@@ -1,11 +1,15 @@
 #include <catch2/catch.hpp>
 #include <Euclid/Descriptor/HKS.h>
 
+#include <stdexcept>
 #include <vector>
 #include <CGAL/Simple_cartesian.h>
 #include <CGAL/Surface_mesh.h>
 #include <Euclid/MeshUtil/CGALMesh.h>
+#include <Eigen/Eigenvalues>
 #include <Euclid/Geometry/Spectral.h>
+#include <Euclid/Geometry/TriMeshGeometry.h>
+#include <Euclid/IO/OffIO.h>
 #include <Euclid/IO/PlyIO.h>
 #include <Euclid/Descriptor/Histogram.h>
 #include <Euclid/Util/Color.h>
@@ -135,3 +139,57 @@ TEST_CASE("Descriptor,HKS", "[descriptor][hks]")
             "hks3.ply", positions, indices, distances);
     }
 }
+
+TEST_CASE("Descriptor, matrix free HKS", "[descriptor][hks]")
+{
+    std::string fin(DATA_DIR);
+    fin.append("bumpy.off");
+    std::vector<double> positions;
+    std::vector<int> indices;
+    Euclid::read_off<3>(fin, positions, nullptr, &indices, nullptr);
+    Mesh mesh;
+    Euclid::make_mesh<3>(mesh, positions, indices);
+
+    // Reference solution from a full dense eigen decomposition
+    Eigen::MatrixXd cot_mat(Euclid::cotangent_matrix(mesh));
+    Eigen::MatrixXd mass_mat(Euclid::mass_matrix(mesh));
+    Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> solver(
+        cot_mat, mass_mat);
+    Eigen::VectorXd eigenvalues = solver.eigenvalues();
+    Eigen::MatrixXd eigenfunctions = solver.eigenvectors();
+
+    // Short time scales, where the probing variance is small
+    auto tmin = static_cast<float>(1.0 / eigenvalues.maxCoeff());
+    auto tmax = 4.0f * tmin;
+    Euclid::HKS<Mesh> hks;
+    hks.build(mesh, &eigenvalues, &eigenfunctions);
+    Eigen::ArrayXXd expected;
+    hks.compute(expected, 10, tmin, tmax);
+
+    SECTION("compare with eigen decomposition")
+    {
+        Eigen::ArrayXXd hks_all;
+        Euclid::matrix_free_hks(mesh, hks_all, 10, tmin, tmax, 100, 256);
+        REQUIRE(hks_all.rows() == 10);
+        REQUIRE(hks_all.cols() == eigenvalues.size());
+        for (int i = 0; i < hks_all.rows(); ++i) {
+            REQUIRE(hks_all.row(i).sum() == Approx(1.0));
+            auto error = (hks_all.row(i) - expected.row(i)).matrix().norm() /
+                         expected.row(i).matrix().norm();
+            REQUIRE(error < 0.1);
+        }
+    }
+
+    SECTION("invalid time range")
+    {
+        Eigen::ArrayXXd hks_all;
+        REQUIRE_THROWS_AS(Euclid::matrix_free_hks(mesh, hks_all, 10, 0, tmax),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(
+            Euclid::matrix_free_hks(mesh, hks_all, 10, -tmin, tmax),
+            std::invalid_argument);
+        REQUIRE_THROWS_AS(
+            Euclid::matrix_free_hks(mesh, hks_all, 10, tmax, tmin),
+            std::invalid_argument);
+    }
+}
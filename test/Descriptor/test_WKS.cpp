@@ -1,11 +1,15 @@
 #include <catch2/catch.hpp>
 #include <Euclid/Descriptor/WKS.h>
 
+#include <stdexcept>
 #include <vector>
 #include <CGAL/Simple_cartesian.h>
 #include <CGAL/Surface_mesh.h>
 #include <Euclid/MeshUtil/CGALMesh.h>
+#include <Eigen/Eigenvalues>
 #include <Euclid/Geometry/Spectral.h>
+#include <Euclid/Geometry/TriMeshGeometry.h>
+#include <Euclid/IO/OffIO.h>
 #include <Euclid/IO/PlyIO.h>
 #include <Euclid/Descriptor/Histogram.h>
 #include <Euclid/Util/Color.h>
@@ -149,3 +153,62 @@ TEST_CASE("Descriptor, WKS", "[descriptor][wks]")
             "wks3.ply", positions, indices, distances);
     }
 }
+
+TEST_CASE("Descriptor, matrix free WKS", "[descriptor][wks]")
+{
+    std::string fin(DATA_DIR);
+    fin.append("bumpy.off");
+    std::vector<double> positions;
+    std::vector<int> indices;
+    Euclid::read_off<3>(fin, positions, nullptr, &indices, nullptr);
+    Mesh mesh;
+    Euclid::make_mesh<3>(mesh, positions, indices);
+
+    // Reference solution from a full dense eigen decomposition
+    Eigen::MatrixXd cot_mat(Euclid::cotangent_matrix(mesh));
+    Eigen::MatrixXd mass_mat(Euclid::mass_matrix(mesh));
+    Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> solver(
+        cot_mat, mass_mat);
+    Eigen::VectorXd eigenvalues = solver.eigenvalues();
+    Eigen::MatrixXd eigenfunctions = solver.eigenvectors();
+    Eigen::VectorXd areas = mass_mat.diagonal();
+
+    // High energy bands, where the probing variance is small
+    auto emax = static_cast<float>(std::log(eigenvalues.maxCoeff()));
+    auto emin = emax - 1.0f;
+    auto sigma = 1.0f;
+    Euclid::WKS<Mesh> wks;
+    wks.build(mesh, &eigenvalues, &eigenfunctions);
+    Eigen::ArrayXXd expected;
+    wks.compute(expected, 10, emin, emax, sigma);
+
+    SECTION("compare with eigen decomposition")
+    {
+        Eigen::ArrayXXd wks_all;
+        Euclid::matrix_free_wks(
+            mesh, wks_all, 10, emin, emax, sigma, 100, 256);
+        REQUIRE(wks_all.rows() == 10);
+        REQUIRE(wks_all.cols() == eigenvalues.size());
+        for (int i = 0; i < wks_all.rows(); ++i) {
+            // normalized by the trace, i.e. unit integral over the surface
+            REQUIRE(wks_all.row(i).matrix().dot(areas) == Approx(1.0));
+            auto error = (wks_all.row(i) - expected.row(i)).matrix().norm() /
+                         expected.row(i).matrix().norm();
+            REQUIRE(error < 0.1);
+        }
+    }
+
+    SECTION("invalid energy range")
+    {
+        Eigen::ArrayXXd wks_all;
+        REQUIRE_THROWS_AS(
+            Euclid::matrix_free_wks(mesh, wks_all, 10, emax, emin, sigma),
+            std::invalid_argument);
+        REQUIRE_THROWS_AS(
+            Euclid::matrix_free_wks(mesh, wks_all, 10, emin, emin, sigma),
+            std::invalid_argument);
+        REQUIRE_THROWS_AS(
+            Euclid::matrix_free_wks(mesh, wks_all, 10, emin, emax, 0.0f),
+            std::invalid_argument);
+    }
+}
@@ -53,3 +53,61 @@ TEST_CASE("Distance, Biharmonic distance", "[distance][biharmonicdistance]")
     fout.append("kitten_biharmonic_distance.ply");
     Euclid::write_ply<3>(fout, positions, nullptr, nullptr, &indices, &colors);
 }
+
+TEST_CASE("Distance, Exact biharmonic distance",
+          "[distance][biharmonicdistance]")
+{
+    std::vector<float> positions;
+    std::vector<unsigned> indices;
+    std::string fin(DATA_DIR);
+    fin.append("kitten.off");
+    Euclid::read_off<3>(fin, positions, nullptr, &indices, nullptr);
+    Mesh mesh;
+    Euclid::make_mesh<3>(mesh, positions, indices);
+
+    constexpr const int v1 = 2438;
+    constexpr const int v2 = 1482;
+    constexpr const int v3 = 946;
+    constexpr const int k = 200;
+
+    Euclid::ExactBiharmonicDistance<Mesh> biharmonic;
+    biharmonic.build(mesh);
+
+    // Pairwise distances
+    Mesh::Vertex_index s1(v1), s2(v2), s3(v3);
+    auto d1 = biharmonic.compute(s1, s2);
+    auto d2 = biharmonic.compute(s1, s3);
+    REQUIRE(d1 < d2);
+
+    // Distance fields agree with the pairwise distances
+    std::vector<double> distances;
+    biharmonic.compute(s1, distances);
+    REQUIRE(distances[v1] == 0.0);
+    REQUIRE(distances[v2] == Approx(d1));
+    REQUIRE(distances[v3] == Approx(d2));
+
+    Eigen::MatrixXd fields;
+    biharmonic.compute({ s1, s2 }, fields);
+    REQUIRE(fields.rows() == static_cast<int>(mesh.num_vertices()));
+    REQUIRE(fields.cols() == 2);
+    REQUIRE(fields(v2, 0) == Approx(d1));
+    REQUIRE(fields(v1, 1) == Approx(d1));
+
+    // The truncated spectral distance converges to the exact one
+    Eigen::VectorXd lambdas;
+    Eigen::MatrixXd phis;
+    Euclid::spectrum(mesh, k, lambdas, phis);
+    Eigen::VectorXd tail_lambdas = lambdas.tail(k - 1);
+    Eigen::MatrixXd tail_phis = phis.rightCols(k - 1);
+    REQUIRE(Euclid::biharmonic_distance(tail_lambdas, tail_phis, v1, v2) ==
+            Approx(d1).epsilon(0.1));
+    REQUIRE(Euclid::biharmonic_distance(tail_lambdas, tail_phis, v1, v3) ==
+            Approx(d2).epsilon(0.1));
+
+    // Colormap
+    std::vector<unsigned char> colors;
+    Euclid::colormap(igl::COLOR_MAP_TYPE_PARULA, distances, colors, true, true);
+    std::string fout(TMP_DIR);
+    fout.append("kitten_exact_biharmonic_distance.ply");
+    Euclid::write_ply<3>(fout, positions, nullptr, nullptr, &indices, &colors);
+}
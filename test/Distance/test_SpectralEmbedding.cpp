@@ -0,0 +1,116 @@
+#include <catch2/catch.hpp>
+#include <Euclid/Distance/SpectralEmbedding.h>
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Surface_mesh.h>
+#include <Euclid/Distance/BiharmonicDistance.h>
+#include <Euclid/Distance/CommuteTimeDistance.h>
+#include <Euclid/Distance/DiffusionDistance.h>
+#include <Euclid/Geometry/Spectral.h>
+#include <Euclid/MeshUtil/CGALMesh.h>
+#include <Euclid/IO/OffIO.h>
+
+#include <config.h>
+
+using Kernel = CGAL::Simple_cartesian<double>;
+using Point_3 = Kernel::Point_3;
+using Mesh = CGAL::Surface_mesh<Point_3>;
+
+TEST_CASE("Distance, Spectral embedding", "[distance][spectralembedding]")
+{
+    std::vector<float> positions;
+    std::vector<unsigned> indices;
+    std::string fin(DATA_DIR);
+    fin.append("kitten.off");
+    Euclid::read_off<3>(fin, positions, nullptr, &indices, nullptr);
+    Mesh mesh;
+    Euclid::make_mesh<3>(mesh, positions, indices);
+
+    constexpr const int v1 = 2438;
+    constexpr const int v2 = 1482;
+    constexpr const int v3 = 946;
+    constexpr const double t = 0.1;
+    constexpr const int k = 200;
+    const int nv = static_cast<int>(mesh.num_vertices());
+
+    // Compute spectral decomposition
+    Eigen::VectorXd lambdas;
+    Eigen::MatrixXd phis;
+    Euclid::spectrum(mesh, k, lambdas, phis);
+
+    // The embedding drops the constant eigenfunction
+    Eigen::VectorXd tail_lambdas = lambdas.tail(k - 1);
+    Eigen::MatrixXd tail_phis = phis.rightCols(k - 1);
+
+    SECTION("biharmonic distance")
+    {
+        Euclid::SpectralEmbedding<double> embedding;
+        embedding.build(lambdas, phis, Euclid::SpectralDistance::biharmonic);
+        REQUIRE(embedding.size() == nv);
+        REQUIRE(embedding.embedding.rows() == k - 1);
+
+        Eigen::VectorXd distances;
+        embedding.distances(v1, distances);
+        REQUIRE(distances(v1) == 0);
+        for (int i = 0; i < nv; i += 97) {
+            auto d = Euclid::biharmonic_distance(
+                tail_lambdas, tail_phis, v1, i);
+            REQUIRE(distances(i) == Approx(d).margin(1e-6));
+            REQUIRE(embedding.distance(v1, i) == Approx(d).margin(1e-6));
+        }
+    }
+
+    SECTION("diffusion distance")
+    {
+        Euclid::SpectralEmbedding<double> embedding;
+        embedding.build(lambdas, phis, Euclid::SpectralDistance::diffusion, t);
+
+        Eigen::VectorXd distances;
+        embedding.distances(v2, distances);
+        for (int i = 0; i < nv; i += 97) {
+            auto d = Euclid::diffusion_distance(
+                tail_lambdas, tail_phis, v2, i, t);
+            REQUIRE(distances(i) == Approx(d).margin(1e-6));
+        }
+    }
+
+    SECTION("all pairs and tiles")
+    {
+        Euclid::SpectralEmbedding<double> embedding;
+        embedding.build(
+            lambdas, phis, Euclid::SpectralDistance::commute_time);
+
+        Eigen::MatrixXd block;
+        embedding.distances(v2, 100, v3, 50, block);
+        REQUIRE(block.rows() == 100);
+        REQUIRE(block.cols() == 50);
+        for (int i = 0; i < 100; i += 9) {
+            for (int j = 0; j < 50; j += 7) {
+                auto d = Euclid::commute_time_distance(
+                    tail_lambdas, tail_phis, v2 + i, v3 + j);
+                REQUIRE(block(i, j) == Approx(d).margin(1e-6));
+            }
+        }
+
+        Eigen::MatrixXd all;
+        embedding.distances(all);
+        REQUIRE(all.rows() == nv);
+        REQUIRE(all.cols() == nv);
+        REQUIRE(all.diagonal().isZero());
+        REQUIRE(all.isApprox(all.transpose()));
+
+        int covered = 0;
+        double error = 0.0;
+        embedding.for_each_tile(
+            1000, [&](int row, int col, const Eigen::MatrixXd& tile) {
+                covered += static_cast<int>(tile.size());
+                auto ref = all.block(row, col, tile.rows(), tile.cols());
+                error = std::max(error, (tile - ref).cwiseAbs().maxCoeff());
+            });
+        REQUIRE(covered == nv * nv);
+        REQUIRE(error < 1e-8);
+    }
+}
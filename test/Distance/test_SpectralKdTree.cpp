@@ -0,0 +1,88 @@
+#include <catch2/catch.hpp>
+#include <Euclid/Distance/SpectralKdTree.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Surface_mesh.h>
+#include <Euclid/Geometry/Spectral.h>
+#include <Euclid/MeshUtil/CGALMesh.h>
+#include <Euclid/IO/OffIO.h>
+
+#include <config.h>
+
+using Kernel = CGAL::Simple_cartesian<double>;
+using Point_3 = Kernel::Point_3;
+using Mesh = CGAL::Surface_mesh<Point_3>;
+
+TEST_CASE("Distance, Spectral kd-tree", "[distance][spectralkdtree]")
+{
+    std::vector<float> positions;
+    std::vector<unsigned> indices;
+    std::string fin(DATA_DIR);
+    fin.append("kitten.off");
+    Euclid::read_off<3>(fin, positions, nullptr, &indices, nullptr);
+    Mesh mesh;
+    Euclid::make_mesh<3>(mesh, positions, indices);
+
+    constexpr const int k = 100;
+    constexpr const int nn = 20;
+    const int nv = static_cast<int>(mesh.num_vertices());
+
+    Eigen::VectorXd lambdas;
+    Eigen::MatrixXd phis;
+    Euclid::spectrum(mesh, k, lambdas, phis);
+
+    // An embedding without any dimension cannot be split
+    {
+        Euclid::SpectralEmbedding<double> embedding;
+        embedding.embedding.resize(0, nv);
+        Euclid::SpectralKdTree<double> tree;
+        REQUIRE_THROWS_AS(tree.build(embedding), std::invalid_argument);
+    }
+
+    for (auto type : { Euclid::SpectralDistance::biharmonic,
+                       Euclid::SpectralDistance::diffusion,
+                       Euclid::SpectralDistance::commute_time }) {
+        Euclid::SpectralEmbedding<double> embedding;
+        embedding.build(lambdas, phis, type);
+        Euclid::SpectralKdTree<double> tree;
+        tree.build(embedding);
+
+        for (int x = 0; x < nv; x += 250) {
+            // Brute force reference
+            Eigen::VectorXd field;
+            embedding.distances(x, field);
+            std::vector<int> order(nv);
+            std::iota(order.begin(), order.end(), 0);
+            std::partial_sort(order.begin(),
+                              order.begin() + nn,
+                              order.end(),
+                              [&field](int a, int b) {
+                                  return field(a) < field(b);
+                              });
+
+            std::vector<int> knn;
+            std::vector<double> knn_dists;
+            tree.knn(x, nn, knn, knn_dists);
+            REQUIRE(knn.size() == nn);
+            REQUIRE(knn[0] == x);
+            for (int i = 0; i < nn; ++i) {
+                REQUIRE(knn_dists[i] == Approx(field(order[i])).margin(1e-8));
+                REQUIRE(knn_dists[i] ==
+                        Approx(embedding.distance(x, knn[i])).margin(1e-8));
+            }
+
+            // Radius strictly between two neighbors to avoid ties
+            auto radius = 0.5 * (knn_dists[nn - 2] + knn_dists[nn - 1]);
+            std::vector<int> ball;
+            std::vector<double> ball_dists;
+            tree.radius(x, radius, ball, ball_dists);
+            REQUIRE(ball.size() == nn - 1);
+            REQUIRE(std::is_sorted(ball_dists.begin(), ball_dists.end()));
+        }
+    }
+}
@@ -71,3 +71,40 @@ TEST_CASE("Geometry, Spectral", "[geometry][spectral]")
     REQUIRE(
         Euclid::eq_abs_err(phis2.col(1).norm(), phis2.col(10).norm(), 1e-14));
 }
+
+TEST_CASE("Geometry, Approximate spectrum", "[geometry][spectral]")
+{
+    std::string fin(DATA_DIR);
+    fin.append("bumpy.off");
+    std::vector<double> positions;
+    std::vector<int> indices;
+    Euclid::read_off<3>(fin, positions, nullptr, &indices, nullptr);
+    Mesh mesh;
+    Euclid::make_mesh<3>(mesh, positions, indices);
+
+    int nv = positions.size() / 3;
+    unsigned k = 20;
+    Eigen::VectorXd lambdas, approx_lambdas, errors;
+    Eigen::MatrixXd phis, approx_phis;
+    Euclid::spectrum(mesh, k, lambdas, phis);
+    auto n = Euclid::approximate_spectrum(
+        mesh, k, approx_lambdas, approx_phis, errors);
+
+    REQUIRE(n == k);
+    REQUIRE(approx_lambdas.size() == k);
+    REQUIRE(approx_phis.rows() == nv);
+    REQUIRE(approx_phis.cols() == k);
+    REQUIRE(errors.size() == k);
+    REQUIRE(errors.minCoeff() >= 0.0);
+
+    // the leading eigenvalues converge first
+    REQUIRE(Euclid::eq_abs_err(approx_lambdas(0), 0.0, 1e-8));
+    for (int i = 1; i < 10; ++i) {
+        REQUIRE(approx_lambdas(i) == Approx(lambdas(i)).epsilon(1e-2));
+    }
+
+    // eigenvectors are orthonormal wrt mass weighted inner product
+    auto D = Euclid::mass_matrix(mesh);
+    Eigen::MatrixXd gram = approx_phis.transpose() * D * approx_phis;
+    REQUIRE(gram.isIdentity(1e-8));
+}
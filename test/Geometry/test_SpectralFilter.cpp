@@ -0,0 +1,99 @@
+#include <catch2/catch.hpp>
+#include <Euclid/Geometry/SpectralFilter.h>
+
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/Surface_mesh.h>
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+#include <Euclid/Geometry/TriMeshGeometry.h>
+#include <Euclid/IO/OffIO.h>
+#include <Euclid/MeshUtil/CGALMesh.h>
+
+#include <config.h>
+
+using Kernel = CGAL::Simple_cartesian<double>;
+using Point_3 = typename Kernel::Point_3;
+using Mesh = CGAL::Surface_mesh<Point_3>;
+
+TEST_CASE("Geometry, SpectralFilter", "[geometry][spectralfilter]")
+{
+    std::string fin(DATA_DIR);
+    fin.append("bumpy.off");
+    std::vector<double> positions;
+    std::vector<int> indices;
+    Euclid::read_off<3>(fin, positions, nullptr, &indices, nullptr);
+    Mesh mesh;
+    Euclid::make_mesh<3>(mesh, positions, indices);
+
+    Eigen::SparseMatrix<double> cot_mat = Euclid::cotangent_matrix(mesh);
+    Eigen::SparseMatrix<double> mass_mat = Euclid::mass_matrix(mesh);
+
+    // Reference solution from a full dense eigen decomposition
+    Eigen::MatrixXd dense_cot_mat(cot_mat);
+    Eigen::MatrixXd dense_mass_mat(mass_mat);
+    Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> solver(
+        dense_cot_mat, dense_mass_mat);
+    Eigen::VectorXd eigenvalues = solver.eigenvalues();
+    Eigen::MatrixXd eigenfunctions = solver.eigenvectors();
+
+    SECTION("eigenvalue bound")
+    {
+        auto bound = Euclid::max_eigenvalue_bound(cot_mat, mass_mat);
+        REQUIRE(bound >= eigenvalues.maxCoeff());
+    }
+
+    SECTION("chebyshev coefficients")
+    {
+        std::function<double(double)> filter = [](double x) {
+            return std::exp(-x);
+        };
+        Eigen::VectorXd c;
+        Euclid::chebyshev_coefficients(filter, 30, 4.0, c);
+        REQUIRE(c.size() == 31);
+        for (auto x : { 0.0, 0.5, 1.7, 3.2, 4.0 }) {
+            auto y = x / 2.0 - 1.0;
+            double value = 0.0;
+            for (int k = 0; k < c.size(); ++k) {
+                value += c(k) * std::cos(k * std::acos(y));
+            }
+            REQUIRE(value == Approx(filter(x)).epsilon(1e-8));
+        }
+    }
+
+    SECTION("filtered diagonals")
+    {
+        auto bound = Euclid::max_eigenvalue_bound(cot_mat, mass_mat);
+        auto t1 = 1.0 / bound;
+        auto t2 = 2.0 / bound;
+        auto e = std::log(0.25 * bound);
+        std::vector<std::function<double(double)>> filters{
+            [t1](double x) { return std::exp(-t1 * x); },
+            [t2](double x) { return std::exp(-t2 * x); },
+            [e](double x) {
+                return x <= 0 ? 0.0
+                              : std::exp(-std::pow(e - std::log(x), 2) * 2);
+            }
+        };
+
+        Eigen::MatrixXd diagonals;
+        Eigen::VectorXd traces;
+        Euclid::filter_diagonals(
+            cot_mat, mass_mat, filters, diagonals, traces, 100, 256);
+        REQUIRE(diagonals.rows() == eigenvalues.size());
+        REQUIRE(diagonals.cols() == 3);
+        REQUIRE(traces.size() == 3);
+
+        for (size_t i = 0; i < filters.size(); ++i) {
+            Eigen::VectorXd g = eigenvalues.unaryExpr(filters[i]);
+            Eigen::VectorXd expected = eigenfunctions.cwiseAbs2() * g;
+            auto error = (diagonals.col(i) - expected).norm() / expected.norm();
+            REQUIRE(error < 0.1);
+            REQUIRE(traces(i) == Approx(g.sum()).epsilon(0.05));
+        }
+    }
+}
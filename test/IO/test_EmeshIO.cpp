@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+#include <Euclid/IO/EmeshIO.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <Euclid/IO/PlyIO.h>
+
+#include <config.h>
+
+TEST_CASE("IO, EmeshIO", "[io][emeshio]")
+{
+    std::string file(DATA_DIR);
+    file.append("dragon.ply");
+    std::vector<float> positions;
+    std::vector<float> normals;
+    std::vector<unsigned> indices;
+    Euclid::read_ply<3>(file, positions, &normals, nullptr, &indices, nullptr);
+    std::vector<unsigned char> colors(positions.size() / 3 * 4);
+    for (size_t i = 0; i < colors.size(); ++i) {
+        colors[i] = static_cast<unsigned char>(i * 37);
+    }
+
+    SECTION("raw blocks")
+    {
+        std::string fout(TMP_DIR);
+        fout.append("dragon.emesh");
+        Euclid::write_emesh<3>(
+            fout, positions, indices, &normals, nullptr, &colors);
+
+        std::vector<double> new_positions;
+        std::vector<int> new_indices;
+        std::vector<double> new_normals;
+        std::vector<double> texcoords{ 1.0 };
+        std::vector<unsigned char> new_colors;
+        Euclid::read_emesh<3>(fout,
+                              new_positions,
+                              new_indices,
+                              &new_normals,
+                              &texcoords,
+                              &new_colors);
+        REQUIRE(new_positions ==
+                std::vector<double>(positions.begin(), positions.end()));
+        REQUIRE(new_indices ==
+                std::vector<int>(indices.begin(), indices.end()));
+        REQUIRE(new_normals ==
+                std::vector<double>(normals.begin(), normals.end()));
+        REQUIRE(texcoords.empty());
+        REQUIRE(new_colors == colors);
+        REQUIRE_THROWS(Euclid::read_emesh<4>(fout, new_positions, new_indices));
+
+        // blocks are used in place
+        Euclid::MappedEmesh emesh(fout);
+        REQUIRE(emesh.blocks().size() == 4);
+        auto V = emesh.matrix<float>("positions");
+        auto F = emesh.matrix<unsigned>("indices");
+        REQUIRE(V.rows() * 3 == static_cast<long>(positions.size()));
+        REQUIRE(V.cols() == 3);
+        REQUIRE(F.rows() * 3 == static_cast<long>(indices.size()));
+        REQUIRE(reinterpret_cast<uintptr_t>(V.data()) % 64 == 0);
+        REQUIRE(reinterpret_cast<uintptr_t>(F.data()) % 64 == 0);
+        REQUIRE(V(5, 2) == positions[17]);
+        REQUIRE(F(7, 1) == indices[22]);
+        REQUIRE_THROWS(emesh.matrix<double>("positions"));
+        REQUIRE_THROWS(emesh.matrix<float>("texcoords"));
+        REQUIRE(emesh.find("texcoords") == nullptr);
+    }
+
+    SECTION("compressed blocks")
+    {
+        std::string fout(TMP_DIR);
+        fout.append("dragon_compressed.emesh");
+        Euclid::write_emesh<3>(
+            fout, positions, indices, &normals, nullptr, nullptr, true);
+
+        std::vector<float> new_positions;
+        std::vector<unsigned> new_indices;
+        std::vector<float> new_normals;
+        Euclid::read_emesh<3>(fout, new_positions, new_indices, &new_normals);
+        REQUIRE(new_indices == indices);
+        REQUIRE(new_positions.size() == positions.size());
+        REQUIRE(new_normals.size() == normals.size());
+
+        // within half a quantization step of the bounding box
+        Euclid::MappedEmesh emesh(fout);
+        REQUIRE(emesh.find("positions")->encoding ==
+                Euclid::EmeshEncoding::quantized);
+        REQUIRE_THROWS(emesh.matrix<float>("positions"));
+        float lo = positions[0];
+        float hi = positions[0];
+        for (auto p : positions) {
+            lo = std::min(lo, p);
+            hi = std::max(hi, p);
+        }
+        float error = 0.0f;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            error = std::max(error, std::abs(new_positions[i] - positions[i]));
+        }
+        REQUIRE(error <= (hi - lo) / 65535.0f);
+    }
+
+    SECTION("fields and operators")
+    {
+        std::vector<double> field{ 0.5, -1.0, 2.0, 3.5, 4.0, -6.0 };
+        std::vector<int> labels{ -3, 7, 7, 1000000, -1000000, 0 };
+        Eigen::SparseMatrix<double> L(4, 3);
+        L.insert(0, 0) = 1.0;
+        L.insert(3, 0) = -2.0;
+        L.insert(1, 2) = 3.5;
+        Eigen::SparseMatrix<float, Eigen::RowMajor> M(2, 2);
+        M.insert(1, 0) = 4.0f;
+
+        std::string fout(TMP_DIR);
+        fout.append("fields.emesh");
+        Euclid::EmeshWriter writer;
+        writer.add("field", field, 2);
+        writer.add("labels", labels, 1, Euclid::EmeshEncoding::delta);
+        writer.add("L", L);
+        writer.add("M", M);
+        REQUIRE_THROWS(writer.add("field", field, 2));
+        REQUIRE_THROWS(
+            writer.add("bad", labels, 1, Euclid::EmeshEncoding::quantized));
+        writer.write(fout);
+
+        Euclid::MappedEmesh emesh(fout);
+        auto F = emesh.matrix<double>("field");
+        REQUIRE(F.rows() == 3);
+        REQUIRE(F(1, 0) == 2.0);
+        std::vector<int> new_labels;
+        emesh.decode("labels", new_labels);
+        REQUIRE(new_labels == labels);
+
+        auto new_L = emesh.sparse<double>("L");
+        REQUIRE(new_L.rows() == 4);
+        REQUIRE(new_L.cols() == 3);
+        REQUIRE(new_L.nonZeros() == 3);
+        REQUIRE(Eigen::MatrixXd(new_L) == Eigen::MatrixXd(L));
+        auto new_M = emesh.sparse<float, Eigen::RowMajor>("M");
+        REQUIRE(Eigen::MatrixXf(new_M) == Eigen::MatrixXf(M));
+        REQUIRE_THROWS(emesh.sparse<float>("M"));
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <array>
+#include <numeric>
 #include <vector>
 #include <Euclid/Util/Assert.h>
 #include <Euclid/IO/OffIO.h>
@@ -204,6 +205,76 @@ TEST_CASE("IO, InputFixer", "[io][inputfixer]")
             sick_tri_pos, sick_tri_idx, fixed_tri_pos, fixed_tri_idx));
     }
 
+    SECTION("vertex welding")
+    {
+        // each point has a copy nearby, except the last one
+        std::vector<double> positions{ 0.0,  0.0,  0.0,  1.0,   0.0,   0.0,
+                                       0.0,  1e-4, 0.0,  1.0,   -1e-4, 0.0,
+                                       2.0,  0.0,  0.0,  1e-4,  1e-4,  1e-4,
+                                       0.0,  1.0,  0.0,  2.0,   1e-4,  0.0,
+                                       3e-3, 0.0,  0.0,  -3e-3, 0.0,   0.0 };
+        std::vector<int> indices{ 0, 1, 6, 2, 3, 6, 4, 7, 8, 5, 9, 1 };
+        const std::vector<double> fixed_pos{ 0.0, 0.0, 0.0, 1.0,   0.0, 0.0,
+                                             0.0, 1.0, 0.0, -3e-3, 0.0, 0.0,
+                                             2.0, 0.0, 0.0, 3e-3,  0.0, 0.0 };
+        const std::vector<int> fixed_idx{ 0, 1, 2, 0, 1, 2,
+                                          4, 4, 5, 0, 3, 1 };
+
+        auto copy = positions;
+        REQUIRE(Euclid::remove_duplicate_vertices(copy) == 0);
+        REQUIRE(Euclid::remove_duplicate_vertices<3>(
+                    positions, indices, 1e-3) == 4);
+        REQUIRE(positions == fixed_pos);
+        REQUIRE(indices == fixed_idx);
+        REQUIRE_THROWS(Euclid::remove_duplicate_vertices(positions, -1.0));
+    }
+
+    SECTION("vertex welding with many duplicates")
+    {
+        // a grid copied many times, the copies jittered within epsilon
+        const int copies = 48;
+        std::vector<double> positions;
+        for (int c = 0; c < copies; ++c) {
+            const auto jitter = 1e-4 * (c % 3 - 1) * (c > 0);
+            for (int i = 0; i < 400; ++i) {
+                positions.push_back(0.01 * (i % 10) + jitter);
+                positions.push_back(0.01 * (i / 10 % 10) - jitter);
+                positions.push_back(0.01 * (i / 100));
+            }
+        }
+        std::vector<int> indices(positions.size() / 3);
+        std::iota(indices.begin(), indices.end(), 0);
+        const std::vector<double> grid(positions.begin(),
+                                       positions.begin() + 1200);
+
+        REQUIRE(Euclid::remove_duplicate_vertices<3>(
+                    positions, indices, 1e-3) == 400 * (copies - 1));
+        REQUIRE(positions == grid);
+        bool welded = true;
+        for (size_t i = 0; i < indices.size(); ++i) {
+            welded = welded && indices[i] == static_cast<int>(i % 400);
+        }
+        REQUIRE(welded);
+    }
+
+    SECTION("vertex welding with huge coordinates")
+    {
+        // the coordinates are far beyond 64 bit grid cells of size epsilon
+        std::vector<double> positions{ 1e300, 0.0,  0.0,  -1e300, 1e300, 0.0,
+                                       0.0,   0.0,  0.0,  1e300,  0.0,   0.0,
+                                       1e-4,  1e-4, 0.0,  -1e300, 1e300, 0.0 };
+        std::vector<int> indices{ 0, 1, 2, 3, 4, 5 };
+        const std::vector<double> fixed_pos{ 1e300, 0.0, 0.0,  -1e300,
+                                             1e300, 0.0, 0.0,  0.0,
+                                             0.0 };
+        const std::vector<int> fixed_idx{ 0, 1, 2, 0, 2, 1 };
+
+        REQUIRE(Euclid::remove_duplicate_vertices<3>(
+                    positions, indices, 1e-3) == 3);
+        REQUIRE(positions == fixed_pos);
+        REQUIRE(indices == fixed_idx);
+    }
+
     SECTION("face duplication")
     {
         const std::vector<unsigned> fixed_tri_idx{ 3, 1, 2, 3, 3, 3, 3, 2, 1 };
@@ -276,6 +347,23 @@ TEST_CASE("IO, InputFixer", "[io][inputfixer]")
         REQUIRE(_idx_eq<4>(sick_quad_idx, fixed_quad_idx));
     }
 
+    SECTION("fused fixing")
+    {
+        const std::vector<float> fixed_tri_pos{ 0.0f, 0.0f, 0.0f, 4.0f, 6.0f,
+                                                8.0f, 1.0f, 2.0f, 3.0f };
+        const std::vector<unsigned> fixed_tri_idx{ 1, 0, 2, 1, 2, 0 };
+        auto stats = Euclid::fix_mesh<3>(sick_tri_pos, sick_tri_idx);
+        REQUIRE(stats.duplicate_vertices == 1);
+        REQUIRE(stats.duplicate_faces == 1);
+        REQUIRE(stats.degenerate_faces == 1);
+        REQUIRE(stats.unreferenced_vertices == 0);
+        REQUIRE(_pos_eq<3>(
+            sick_tri_pos, sick_tri_idx, fixed_tri_pos, fixed_tri_idx));
+        REQUIRE(_idx_eq<3>(sick_tri_idx, fixed_tri_idx));
+        REQUIRE(stats.vertex_map.size() == 4);
+        REQUIRE(stats.vertex_map[0] == stats.vertex_map[1]);
+    }
+
     SECTION("real world examples")
     {
         std::string file_name(DATA_DIR);
@@ -293,4 +381,44 @@ TEST_CASE("IO, InputFixer", "[io][inputfixer]")
         out_name.append("chair_fixed.off");
         Euclid::write_off<3>(out_name, positions, nullptr, &indices, nullptr);
     }
+
+    SECTION("fused fixing of real world examples")
+    {
+        std::string file_name(DATA_DIR);
+        file_name.append("chair.off");
+        std::vector<double> positions;
+        std::vector<int> indices;
+        Euclid::read_off<3>(file_name, positions, nullptr, &indices, nullptr);
+        auto fused_positions = positions;
+        auto fused_indices = indices;
+        const auto old_positions = positions;
+
+        auto n_vertices =
+            Euclid::remove_duplicate_vertices<3>(positions, indices);
+        auto n_faces = Euclid::remove_duplicate_faces<3>(indices);
+        auto n_degenerate =
+            Euclid::remove_degenerate_faces<3>(positions, indices);
+        auto n_unreferenced =
+            Euclid::remove_unreferenced_vertices<3>(positions, indices);
+
+        auto stats = Euclid::fix_mesh<3>(fused_positions, fused_indices);
+        REQUIRE(stats.duplicate_vertices == n_vertices);
+        REQUIRE(stats.duplicate_faces == n_faces);
+        REQUIRE(stats.degenerate_faces == n_degenerate);
+        REQUIRE(stats.unreferenced_vertices == n_unreferenced);
+        REQUIRE(fused_positions == positions);
+        REQUIRE(fused_indices == indices);
+        REQUIRE(stats.vertex_map.size() == old_positions.size() / 3);
+        bool mapped = true;
+        for (size_t i = 0; i < stats.vertex_map.size(); ++i) {
+            auto j = stats.vertex_map[i];
+            if (j != Euclid::FixMeshStats::removed) {
+                for (size_t k = 0; k < 3; ++k) {
+                    mapped = mapped &&
+                             positions[j * 3 + k] == old_positions[i * 3 + k];
+                }
+            }
+        }
+        REQUIRE(mapped);
+    }
 }
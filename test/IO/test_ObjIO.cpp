@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 #include <Euclid/IO/ObjIO.h>
 
+#include <fstream>
 #include <string>
 
 #include <config.h>
@@ -106,4 +107,85 @@ TEST_CASE("IO, ObjIO", "[io][objio]")
         REQUIRE(new_tindices[0] == 0);
         REQUIRE(new_nindices[0] == 0);
     }
+
+    SECTION("index formats")
+    {
+        std::string file(TMP_DIR);
+        file.append("index_formats.obj");
+        {
+            // enough lines to be parsed in several chunks
+            std::ofstream stream(file);
+            for (int i = 0; i < 100000; ++i) {
+                stream << "v " << i << " 0.5 -1e-3\n";
+                stream << "vn 0 0 " << i << "\n";
+                stream << "f -1//-1 " << i + 1 << "//1 +1//" << i + 1 << "\n";
+            }
+            stream << "vt 0.25 0.75 0\n";
+            stream << "f 1/-1/1 2/1/2 3/1/3 # comment\n";
+        }
+
+        std::vector<double> positions;
+        std::vector<double> texcoords;
+        std::vector<double> normals;
+        std::vector<int> pindices;
+        std::vector<int> tindices;
+        std::vector<int> nindices;
+        Euclid::read_obj<3>(file,
+                            positions,
+                            pindices,
+                            &texcoords,
+                            &tindices,
+                            &normals,
+                            &nindices);
+
+        REQUIRE(positions.size() == 100000 * 3);
+        REQUIRE(normals.size() == 100000 * 3);
+        REQUIRE(texcoords.size() == 2);
+        REQUIRE(pindices.size() == 100001 * 3);
+        REQUIRE(nindices.size() == pindices.size());
+        REQUIRE(tindices.size() == 3);
+        REQUIRE(positions[3 * 99999] == 99999.0);
+        REQUIRE(positions[3 * 99999 + 2] == -1e-3);
+        REQUIRE(texcoords[1] == 0.75);
+        REQUIRE(tindices[0] == 0);
+        int mismatches = 0;
+        for (int i = 0; i < 100000; ++i) {
+            mismatches += pindices[3 * i] != i;
+            mismatches += pindices[3 * i + 1] != i;
+            mismatches += pindices[3 * i + 2] != 0;
+            mismatches += nindices[3 * i] != i;
+            mismatches += nindices[3 * i + 1] != 0;
+            mismatches += nindices[3 * i + 2] != i;
+        }
+        REQUIRE(mismatches == 0);
+
+        // indices are read without the values they refer to
+        std::vector<double> new_positions;
+        std::vector<int> new_pindices;
+        std::vector<int> new_tindices;
+        std::vector<int> new_nindices;
+        Euclid::read_obj<3, double, int>(file,
+                                         new_positions,
+                                         new_pindices,
+                                         nullptr,
+                                         &new_tindices,
+                                         nullptr,
+                                         &new_nindices);
+        REQUIRE(new_pindices == pindices);
+        REQUIRE(new_tindices == tindices);
+        REQUIRE(new_nindices == nindices);
+
+        // faces of the wrong size
+        std::string quad_file(TMP_DIR);
+        quad_file.append("quad.obj");
+        {
+            std::ofstream stream(quad_file);
+            stream << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n";
+        }
+        REQUIRE_THROWS(Euclid::read_obj<3>(quad_file, positions, pindices));
+        positions.clear();
+        pindices.clear();
+        Euclid::read_obj<4>(quad_file, positions, pindices);
+        REQUIRE(pindices == std::vector<int>{ 0, 1, 2, 3 });
+    }
 }
@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 #include <Euclid/IO/OffIO.h>
 
+#include <fstream>
 #include <vector>
 
 #include <config.h>
@@ -147,4 +148,38 @@ TEST_CASE("IO, OffIO", "[io][offio]")
         REQUIRE(new_fcolors[0] == fcolors[0]);
         REQUIRE(new_indices[0] == indices[0]);
     }
+
+    SECTION("round trip and layout")
+    {
+        // values are written in their shortest exact representation
+        std::vector<double> positions{ 0.1, 1.0 / 3.0, -2e-9, 1e10, 0.0, 7.0 };
+        std::vector<unsigned> indices{ 0, 1, 0 };
+        std::string tmp_file(TMP_DIR);
+        tmp_file.append("exact.off");
+        Euclid::write_off<3>(tmp_file, positions, nullptr, &indices, nullptr);
+        std::vector<double> new_positions;
+        std::vector<unsigned> new_indices;
+        Euclid::read_off<3>(
+            tmp_file, new_positions, nullptr, &new_indices, nullptr);
+        REQUIRE(new_positions == positions);
+        REQUIRE(new_indices == indices);
+
+        // counts on the keyword line, comments and blank lines
+        tmp_file = TMP_DIR;
+        tmp_file.append("layout.off");
+        {
+            std::ofstream stream(tmp_file);
+            stream << "OFF 3 1 0\n# comment\n\n0 0 0\n1\t0 0\r\n0 1 0\n"
+                   << "3 0 1 2 0.5 1 1 1\n";
+        }
+        std::vector<float> layout_positions;
+        std::vector<int> layout_indices;
+        std::vector<int> fcolors;
+        Euclid::read_off<3>(
+            tmp_file, layout_positions, nullptr, &layout_indices, &fcolors);
+        REQUIRE(layout_positions.size() == 9);
+        REQUIRE(layout_positions[3] == 1.0f);
+        REQUIRE(layout_indices == std::vector<int>{ 0, 1, 2 });
+        REQUIRE(fcolors == std::vector<int>{ 0, 1, 1, 1 });
+    }
 }
@@ -1,6 +1,8 @@
 #include <catch2/catch.hpp>
 #include <Euclid/IO/PlyIO.h>
 
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <vector>
 
@@ -386,4 +388,273 @@ TEST_CASE("IO, PlyIO", "[io][plyio]")
             REQUIRE(colors[0] == new_colors[0]);
         }
     }
+
+    SECTION("property types")
+    {
+        // vertices interleave properties of all kinds, and faces carry a
+        // list of varying size
+        const std::string header_str =
+            "element vertex 3\n"
+            "property float x\n"
+            "property int flags\n"
+            "property float y\n"
+            "property short level\n"
+            "property double z\n"
+            "property uchar red\n"
+            "property uchar green\n"
+            "property uchar blue\n"
+            "element face 2\n"
+            "property list uchar int vertex_indices\n"
+            "property list uchar float texcoord\n"
+            "end_header\n";
+        const std::vector<float> expected_positions{ 0.0f, 0.0f, 0.0f, 1.0f,
+                                                     0.0f, 0.0f, 0.0f, 1.0f,
+                                                     1.0f };
+        const std::vector<unsigned> expected_colors{ 255, 0, 0, 0, 255,
+                                                     0,   0, 0, 255 };
+        const std::vector<unsigned> expected_indices{ 0, 1, 2, 2, 1, 0 };
+
+        std::string ascii_file(TMP_DIR);
+        ascii_file.append("property_types_ascii.ply");
+        {
+            std::ofstream stream(ascii_file);
+            stream << "ply\nformat ascii 1.0\n" << header_str;
+            stream << "0 1 0 -1 0 255 0 0\n"
+                   << "1 2 0 -2 0 0 255 0\n"
+                   << "0 3 1 -3 1 0 0 255\n"
+                   << "3 0 1 2 6 0 0 1 0 0 1\n"
+                   << "3 2 1 0 0\n";
+        }
+
+        std::string binary_file(TMP_DIR);
+        binary_file.append("property_types_binary.ply");
+        {
+            std::ofstream stream(binary_file, std::ios::binary);
+            stream << "ply\nformat binary_little_endian 1.0\n" << header_str;
+            auto put = [&stream](auto value) {
+                char bytes[sizeof(value)];
+                std::memcpy(bytes, &value, sizeof(value));
+                stream.write(bytes, sizeof(value));
+            };
+            for (int i = 0; i < 3; ++i) {
+                put(expected_positions[i * 3]);
+                put(static_cast<int32_t>(i + 1));
+                put(expected_positions[i * 3 + 1]);
+                put(static_cast<int16_t>(-i - 1));
+                put(static_cast<double>(expected_positions[i * 3 + 2]));
+                for (int j = 0; j < 3; ++j) {
+                    put(static_cast<uint8_t>(expected_colors[i * 3 + j]));
+                }
+            }
+            for (int i = 0; i < 2; ++i) {
+                put(static_cast<uint8_t>(3));
+                for (int j = 0; j < 3; ++j) {
+                    put(static_cast<int32_t>(expected_indices[i * 3 + j]));
+                }
+                put(static_cast<uint8_t>(i == 0 ? 6 : 0));
+                for (int j = 0; j < (i == 0 ? 6 : 0); ++j) {
+                    put(0.5f);
+                }
+            }
+        }
+
+        for (const auto& file : { ascii_file, binary_file }) {
+            auto header = Euclid::read_ply_header(file);
+            REQUIRE(header.element(0).n_props() == 8);
+            REQUIRE(header.element(0).property(1)->type_str() == "int");
+            REQUIRE(header.element(0).property(3)->type_str() == "short");
+            REQUIRE(header.element(1).n_props() == 2);
+
+            std::vector<float> positions;
+            std::vector<unsigned> indices;
+            std::vector<unsigned> colors;
+            Euclid::read_ply<3>(
+                file, positions, nullptr, nullptr, &indices, &colors);
+            REQUIRE(positions == expected_positions);
+            REQUIRE(colors == expected_colors);
+            REQUIRE(indices == expected_indices);
+        }
+    }
+
+    SECTION("memory mapped file")
+    {
+        std::string file(DATA_DIR);
+        file.append("dragon.ply");
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<unsigned> indices;
+        Euclid::read_ply<3>(
+            file, positions, &normals, nullptr, &indices, nullptr);
+
+        Euclid::MappedPly mapped(file);
+        REQUIRE(mapped.header().n_elems() == 2);
+        auto vertices = mapped.positions<float>();
+        auto vnormals = mapped.normals<float>();
+        auto faces = mapped.indices<3, unsigned>();
+        REQUIRE(vertices.size() * 3 == positions.size());
+        REQUIRE(vnormals.size() * 3 == normals.size());
+        REQUIRE(faces.size() * 3 == indices.size());
+        if (vertices.data() != nullptr) {
+            REQUIRE(vertices.data()[vertices.stride() / 4] == positions[3]);
+        }
+        size_t mismatches = 0;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            for (int j = 0; j < 3; ++j) {
+                mismatches += vertices(i, j) != positions[i * 3 + j];
+                mismatches += vnormals(i, j) != normals[i * 3 + j];
+            }
+        }
+        for (size_t i = 0; i < faces.size(); ++i) {
+            for (int j = 0; j < 3; ++j) {
+                mismatches += faces(i, j) != indices[i * 3 + j];
+            }
+        }
+        REQUIRE(mismatches == 0);
+
+        // the layout or types don't match
+        REQUIRE(mapped.positions<double>().empty());
+        REQUIRE(mapped.indices<4, unsigned>().empty());
+        std::string ascii_file(DATA_DIR);
+        ascii_file.append("cube_ascii.ply");
+        REQUIRE(Euclid::MappedPly(ascii_file).positions<float>().empty());
+
+        // interleaved with values of other sizes
+        std::string cube_file(DATA_DIR);
+        cube_file.append("cube_binary_little_endian.ply");
+        Euclid::MappedPly cube(cube_file);
+        Euclid::read_ply<3>(
+            cube_file, positions, nullptr, nullptr, &indices, nullptr);
+        auto cube_vertices = cube.positions<float>();
+        auto cube_faces = cube.indices<3, unsigned>();
+        REQUIRE(cube_vertices.size() * 3 == positions.size());
+        REQUIRE(cube_vertices.stride() == 35);
+        REQUIRE(cube_vertices(25, 2) == positions[77]);
+        REQUIRE(cube_faces.size() * 3 == indices.size());
+        REQUIRE(cube_faces(11, 1) == indices[34]);
+    }
+
+    SECTION("streaming")
+    {
+        using Reader = Euclid::StreamingPlyReader<3, float, unsigned, int>;
+
+        std::string file(DATA_DIR);
+        file.append("dragon.ply");
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<unsigned> indices;
+        Euclid::read_ply<3>(
+            file, positions, &normals, nullptr, &indices, nullptr);
+
+        // chunks are concatenated back into the whole mesh
+        std::vector<float> chunk_positions;
+        std::vector<float> chunk_normals;
+        std::vector<unsigned> chunk_indices;
+        size_t chunks = 0;
+        Reader reader(
+            [&](const Reader::Chunk& chunk) {
+                REQUIRE(chunk.first * 3 == chunk_positions.size());
+                REQUIRE(chunk.texcoords == nullptr);
+                chunk_positions.insert(chunk_positions.end(),
+                                       chunk.positions->begin(),
+                                       chunk.positions->end());
+                chunk_normals.insert(chunk_normals.end(),
+                                     chunk.normals->begin(),
+                                     chunk.normals->end());
+                ++chunks;
+                return true;
+            },
+            [&](const Reader::Chunk& chunk) {
+                REQUIRE(chunk.positions == nullptr);
+                REQUIRE(chunk.count * 3 == chunk.indices->size());
+                chunk_indices.insert(chunk_indices.end(),
+                                     chunk.indices->begin(),
+                                     chunk.indices->end());
+                return true;
+            },
+            1000,
+            true);
+        Euclid::read_ply(file, reader);
+        REQUIRE(!reader.stopped());
+        REQUIRE(chunks == (positions.size() / 3 + 999) / 1000);
+        REQUIRE(chunk_positions == positions);
+        REQUIRE(chunk_normals == normals);
+        REQUIRE(chunk_indices == indices);
+
+        // stop after the first chunk
+        size_t faces = 0;
+        Reader stopping([](const Reader::Chunk&) { return false; },
+                        [&](const Reader::Chunk&) {
+                            ++faces;
+                            return true;
+                        },
+                        1000);
+        Euclid::read_ply(file, stopping);
+        REQUIRE(stopping.stopped());
+        REQUIRE(faces == 0);
+
+        // skip the vertices of an ascii file
+        std::string ascii_file(DATA_DIR);
+        ascii_file.append("cube_ascii.ply");
+        Euclid::read_ply<3>(
+            ascii_file, positions, nullptr, nullptr, &indices, nullptr);
+        chunk_indices.clear();
+        Reader faces_only(nullptr, [&](const Reader::Chunk& chunk) {
+            chunk_indices.insert(chunk_indices.end(),
+                                 chunk.indices->begin(),
+                                 chunk.indices->end());
+            return true;
+        });
+        Euclid::read_ply(ascii_file, faces_only);
+        REQUIRE(chunk_indices == indices);
+    }
+
+    SECTION("bulk writing")
+    {
+        std::string file(DATA_DIR);
+        file.append("dragon.ply");
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<unsigned> indices;
+        Euclid::read_ply<3>(
+            file, positions, &normals, nullptr, &indices, nullptr);
+        std::vector<float> texcoords(positions.size() / 3 * 2);
+        std::vector<unsigned char> colors(positions.size() / 3 * 4);
+        for (size_t i = 0; i < texcoords.size(); ++i) {
+            texcoords[i] = i * 1e-3f;
+        }
+        for (size_t i = 0; i < colors.size(); ++i) {
+            colors[i] = static_cast<unsigned char>(i * 37);
+        }
+
+        // every format reads back exactly
+        for (auto format : { Euclid::PlyFormat::ascii,
+                             Euclid::PlyFormat::binary_little_endian,
+                             Euclid::PlyFormat::binary_big_endian }) {
+            std::string fout(TMP_DIR);
+            fout.append("dragon_bulk.ply");
+            Euclid::write_ply<3>(fout,
+                                 positions,
+                                 &normals,
+                                 &texcoords,
+                                 &indices,
+                                 &colors,
+                                 format);
+            std::vector<float> new_positions;
+            std::vector<float> new_normals;
+            std::vector<float> new_texcoords;
+            std::vector<unsigned> new_indices;
+            std::vector<unsigned char> new_colors;
+            Euclid::read_ply<3>(fout,
+                                new_positions,
+                                &new_normals,
+                                &new_texcoords,
+                                &new_indices,
+                                &new_colors);
+            REQUIRE(new_positions == positions);
+            REQUIRE(new_normals == normals);
+            REQUIRE(new_texcoords == texcoords);
+            REQUIRE(new_indices == indices);
+            REQUIRE(new_colors == colors);
+        }
+    }
 }
@@ -194,4 +194,30 @@ TEST_CASE("Render, Rasterizer", "[render][rasterizer]")
         std::vector<float> values(3 * width * height);
         rasterizer.render_depth(transform.matrix(), persp, values);
     }
+
+    SECTION("software backend")
+    {
+        auto software = Euclid::make_rasterizer(
+            Euclid::RasterBackend::software, width, height);
+        software->attach_position_buffer(positions.data(), positions.size());
+        software->attach_normal_buffer(normals.data(), normals.size());
+        software->attach_index_buffer(indices.data(), indices.size());
+        software->set_light(l);
+
+        std::vector<uint8_t> pixels(3 * width * height);
+        std::vector<uint8_t> soft_pixels(3 * width * height);
+        rasterizer.render_unlit(transform.matrix(), persp, pixels);
+        software->render_unlit(transform.matrix(), persp, soft_pixels);
+        size_t mismatches = 0;
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            mismatches += pixels[i] != soft_pixels[i];
+        }
+        REQUIRE(mismatches < pixels.size() / 100);
+
+        software->render_shaded(transform.matrix(), persp, soft_pixels);
+        std::string outfile(TMP_DIR);
+        outfile.append("rasterizer_software.png");
+        stbi_write_png(
+            outfile.c_str(), width, height, 3, soft_pixels.data(), width * 3);
+    }
 }
@@ -1,6 +1,10 @@
 #include <catch2/catch.hpp>
 #include <Euclid/Render/RayTracer.h>
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
 #include <string>
 #include <CGAL/Simple_cartesian.h>
 #include <Euclid/IO/OffIO.h>
@@ -76,6 +80,22 @@ TEST_CASE("Render, RayTracer", "[render][raytracer]")
         outfile.append("raytracer_multisample.png");
         stbi_write_png(
             outfile.c_str(), width, height, 3, pixels.data(), width * 3);
+
+        std::vector<uint8_t> again;
+        raytracer.render_shaded(again, cam, width, height, 8);
+        REQUIRE(again == pixels);
+
+        std::vector<uint8_t> adaptive;
+        raytracer.render_shaded(adaptive, cam, width, height, 8, true, 0.01f);
+        double error = 0.0;
+        for (size_t i = 0; i < pixels.size(); ++i) {
+            error += std::abs(adaptive[i] - pixels[i]);
+        }
+        REQUIRE(error / pixels.size() < 2.0);
+
+        REQUIRE_THROWS_AS(
+            raytracer.render_shaded(pixels, cam, width, height, 0),
+            std::invalid_argument);
     }
 
     SECTION("change material")
@@ -248,6 +268,207 @@ TEST_CASE("Render, RayTracer", "[render][raytracer]")
             outfile.c_str(), width, height, 3, pixels.data(), width * 3);
     }
 
+    SECTION("shared scene")
+    {
+        REQUIRE(Euclid::shared_device() == Euclid::shared_device());
+        auto scene = raytracer.scene();
+        REQUIRE(scene->device() == Euclid::shared_device());
+
+        Euclid::RayTracer other(scene);
+        std::vector<uint8_t> mask(indices.size() / 3, 1);
+        for (size_t i = 0; i < mask.size(); i += 2) {
+            mask[i] = 0;
+        }
+        other.attach_face_mask_buffer(&mask);
+
+        // masks only affect the ray tracer they are attached to
+        std::vector<uint32_t> expected;
+        raytracer.render_index(expected, cam, width, height);
+        std::vector<uint32_t> shared;
+        std::vector<uint32_t> masked;
+#pragma omp parallel sections
+        {
+#pragma omp section
+            raytracer.render_index(shared, cam, width, height);
+#pragma omp section
+            other.render_index(masked, cam, width, height);
+        }
+        REQUIRE(shared == expected);
+        for (auto index : masked) {
+            REQUIRE((index == 0 || mask[index - 1] == 1));
+        }
+    }
+
+    SECTION("update positions")
+    {
+        std::vector<uint32_t> expected;
+        raytracer.render_index(expected, cam, width, height);
+
+        raytracer.set_build_quality(Euclid::BuildQuality::refit);
+        std::vector<float> moved(positions);
+        for (size_t i = 0; i + 1 < moved.size(); i += 3) {
+            moved[i] += 10.0f * aabb.xlen();
+        }
+        raytracer.update_positions(moved);
+        std::vector<uint32_t> findices;
+        raytracer.render_index(findices, cam, width, height);
+        REQUIRE(std::all_of(findices.begin(),
+                            findices.end(),
+                            [](uint32_t index) { return index == 0; }));
+
+        raytracer.update_positions(positions);
+        raytracer.render_index(findices, cam, width, height);
+        REQUIRE(findices == expected);
+
+        raytracer.set_build_quality(Euclid::BuildQuality::high, true);
+        raytracer.render_index(findices, cam, width, height);
+        REQUIRE(findices == expected);
+    }
+
+    SECTION("gbuffer")
+    {
+        const int size = width * height;
+        std::vector<float> depths(size);
+        std::vector<uint32_t> faces(size);
+        std::vector<float> colors(3 * size);
+        std::vector<uint8_t> mask(size);
+        Euclid::GBuffer gbuffer;
+        gbuffer.depth = depths.data();
+        gbuffer.face = faces.data();
+        gbuffer.color = colors.data();
+        gbuffer.mask = mask.data();
+        raytracer.render_gbuffer(gbuffer, cam, width, height);
+
+        std::vector<float> expected_depths;
+        raytracer.render_depth(expected_depths, cam, width, height);
+        REQUIRE(depths == expected_depths);
+
+        std::vector<uint32_t> expected_faces;
+        raytracer.render_index(expected_faces, cam, width, height);
+        REQUIRE(faces == expected_faces);
+
+        std::vector<uint8_t> expected_mask;
+        raytracer.render_silhouette(expected_mask, cam, width, height);
+        REQUIRE(mask == expected_mask);
+
+        std::vector<uint8_t> pixels;
+        raytracer.render_shaded(pixels, cam, width, height, false);
+        for (int i = 0; i < 3 * size; ++i) {
+            REQUIRE(static_cast<uint8_t>(colors[i] * 255) == pixels[i]);
+        }
+    }
+
+    SECTION("batch")
+    {
+        const int w = 64;
+        const int h = 48;
+        std::vector<Euclid::PerspRayCamera> cams;
+        for (int i = 0; i < 4; ++i) {
+            Eigen::Vector3f offset(0.2f * i * aabb.xlen(), 0.0f, 0.0f);
+            cams.emplace_back(
+                view + offset, center, up, 60.0f, w, h, near, far);
+        }
+        std::vector<const Euclid::RayCamera*> cam_ptrs;
+        for (const auto& c : cams) {
+            cam_ptrs.push_back(&c);
+        }
+
+        std::vector<uint32_t> batch_indices(cams.size() * w * h);
+        raytracer.render_batch(batch_indices.data(),
+                               cam_ptrs,
+                               w,
+                               h,
+                               Euclid::RenderMode::index);
+        std::vector<float> batch_depths(cams.size() * w * h);
+        raytracer.render_batch(
+            batch_depths.data(), cam_ptrs, w, h, Euclid::RenderMode::depth);
+        std::vector<uint8_t> batch_pixels(3 * cams.size() * w * h);
+        raytracer.render_batch(
+            batch_pixels.data(), cam_ptrs, w, h, Euclid::RenderMode::shaded);
+
+        for (size_t i = 0; i < cams.size(); ++i) {
+            std::vector<uint32_t> indices;
+            raytracer.render_index(indices, cams[i], w, h);
+            REQUIRE(std::equal(indices.begin(),
+                               indices.end(),
+                               batch_indices.begin() + i * w * h));
+
+            std::vector<float> depths;
+            raytracer.render_depth(depths, cams[i], w, h);
+            REQUIRE(std::equal(depths.begin(),
+                               depths.end(),
+                               batch_depths.begin() + i * w * h));
+
+            std::vector<uint8_t> pixels;
+            raytracer.render_shaded(pixels, cams[i], w, h);
+            REQUIRE(std::equal(pixels.begin(),
+                               pixels.end(),
+                               batch_pixels.begin() + 3 * i * w * h));
+        }
+
+        REQUIRE_THROWS_AS(raytracer.render_batch(batch_indices.data(),
+                                                 cam_ptrs,
+                                                 w,
+                                                 h,
+                                                 Euclid::RenderMode::depth),
+                          std::invalid_argument);
+    }
+
+    SECTION("histogram")
+    {
+        const int w = 64;
+        const int h = 48;
+        std::vector<Euclid::PerspRayCamera> cams;
+        for (int i = 0; i < 3; ++i) {
+            Eigen::Vector3f offset(0.2f * i * aabb.xlen(), 0.0f, 0.0f);
+            cams.emplace_back(
+                view + offset, center, up, 60.0f, w, h, near, far);
+        }
+        std::vector<const Euclid::RayCamera*> cam_ptrs;
+        for (const auto& c : cams) {
+            cam_ptrs.push_back(&c);
+        }
+
+        const size_t bins = indices.size() / 3 + 1;
+        std::vector<uint32_t> batch_counts(cams.size() * bins);
+        raytracer.render_batch(batch_counts.data(),
+                               cam_ptrs,
+                               w,
+                               h,
+                               Euclid::RenderMode::histogram);
+
+        for (size_t i = 0; i < cams.size(); ++i) {
+            std::vector<uint32_t> face_indices;
+            raytracer.render_index(face_indices, cams[i], w, h);
+            std::vector<uint32_t> expected(bins, 0);
+            for (auto f : face_indices) {
+                ++expected[f];
+            }
+
+            std::vector<uint32_t> counts;
+            raytracer.render_histogram(counts, cams[i], w, h);
+            REQUIRE(counts == expected);
+            REQUIRE(std::equal(counts.begin(),
+                               counts.end(),
+                               batch_counts.begin() + i * bins));
+        }
+
+        // a coarse histogram of the same view
+        std::vector<uint32_t> coarse;
+        raytracer.render_histogram(coarse, cams[0], w / 4, h / 4);
+        REQUIRE(coarse.size() == bins);
+        REQUIRE(std::accumulate(coarse.begin(), coarse.end(), 0u) ==
+                (w / 4) * (h / 4));
+
+        std::vector<uint8_t> pixels(3 * w * h);
+        REQUIRE_THROWS_AS(raytracer.render_batch(pixels.data(),
+                                                 cam_ptrs,
+                                                 w,
+                                                 h,
+                                                 Euclid::RenderMode::histogram),
+                          std::invalid_argument);
+    }
+
     SECTION("change geometry")
     {
         std::string filename(DATA_DIR);
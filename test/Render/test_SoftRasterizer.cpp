@@ -0,0 +1,209 @@
+#include <catch2/catch.hpp>
+#include <Euclid/Render/SoftRasterizer.h>
+
+#include <cmath>
+#include <string>
+
+#include <CGAL/Simple_cartesian.h>
+#include <Euclid/IO/OffIO.h>
+#include <Euclid/BoundingVolume/AABB.h>
+#include <Euclid/Math/Vector.h>
+#include <Euclid/Render/RayTracer.h>
+#include <Eigen/Geometry>
+
+#include <stb_image_write.h>
+
+#include <config.h>
+
+using Kernel = CGAL::Simple_cartesian<float>;
+
+TEST_CASE("Render, SoftRasterizer", "[render][softrasterizer]")
+{
+    const uint32_t width = 200;
+    const uint32_t height = 150;
+    const float near = 0.5f;
+    const float far = 5.0f;
+
+    std::string filename(DATA_DIR);
+    filename.append("bunny.off");
+    std::vector<float> positions;
+    std::vector<unsigned> indices;
+    Euclid::read_off<3>(filename, positions, nullptr, &indices, nullptr);
+
+    // fit model into unit box
+    Euclid::AABB<Kernel> aabb(positions);
+    Eigen::Vector3f translation;
+    Euclid::cgal_to_eigen(aabb.center(), translation);
+    float scale = std::max(aabb.xlen(), aabb.ylen());
+    scale = std::max(scale, aabb.zlen());
+    Eigen::Transform<float, 3, Eigen::Affine> transform;
+    transform.setIdentity();
+    transform.scale(1.0f / scale);
+    transform.translate(-translation);
+
+    Eigen::Vector3f view(0.0f, 1.0f, 2.0f);
+    Eigen::Vector3f center(0.0f, 0.0f, 0.0f);
+    Eigen::Vector3f up(0.0f, 1.0f, 0.0f);
+
+    Euclid::SoftRasterizer rasterizer(width, height);
+    rasterizer.attach_position_buffer(positions.data(), positions.size());
+    rasterizer.attach_index_buffer(indices.data(), indices.size());
+
+    // the ray tracer renders the transformed model directly
+    std::vector<float> transformed(positions.size());
+    for (size_t i = 0; i < positions.size(); i += 3) {
+        Eigen::Vector3f p(positions[i], positions[i + 1], positions[i + 2]);
+        Eigen::Vector3f::Map(transformed.data() + i) = transform * p;
+    }
+    transformed.push_back(0.0f);
+    Euclid::RayTracer raytracer;
+    raytracer.attach_geometry_buffers(transformed, indices);
+
+    SECTION("orthographic depth matches the ray tracer")
+    {
+        const float xextent = 2.0f;
+        const float yextent = xextent * height / width;
+        Euclid::OrthoRasCamera ortho(
+            view, center, up, xextent, yextent, near, far);
+        std::vector<float> depths;
+        rasterizer.render_depth(transform.matrix(), ortho, depths, false);
+
+        // shift the rays onto the pixel centers, where the rasterizer samples
+        Euclid::OrthoRayCamera camera(
+            view, center, up, xextent, yextent, near, far);
+        camera.pos += 0.5f * xextent / width * camera.u +
+                      0.5f * yextent / height * camera.v;
+        std::vector<float> ray_depths;
+        raytracer.render_depth(ray_depths, camera, width, height);
+
+        int hits = 0;
+        int mismatches = 0;
+        for (size_t i = 0; i < depths.size(); ++i) {
+            bool hit = depths[i] < 1.0f;
+            bool ray_hit = ray_depths[i] >= 0.0f;
+            hits += ray_hit;
+            if (hit != ray_hit) { ++mismatches; }
+            else if (hit) {
+                auto depth = near + depths[i] * (far - near);
+                mismatches += std::abs(depth - ray_depths[i]) > 1e-3f;
+            }
+        }
+        REQUIRE(hits > 0);
+        REQUIRE(mismatches <= hits / 100);
+    }
+
+    SECTION("perspective depth matches the ray tracer")
+    {
+        Euclid::PerspRasCamera persp(
+            view, center, up, 60.0f, width, height, near, far);
+        std::vector<float> depths;
+        rasterizer.render_depth(transform.matrix(), persp, depths);
+
+        Euclid::PerspRayCamera camera(
+            view, center, up, 60.0f, width, height, near, far);
+        std::vector<float> ray_depths;
+        raytracer.render_depth(ray_depths, camera, width, height);
+
+        // the ray tracer samples pixel corners, so only compare interiors
+        int hits = 0;
+        int mismatches = 0;
+        for (uint32_t y = 1; y + 1 < height; ++y) {
+            for (uint32_t x = 1; x + 1 < width; ++x) {
+                auto i = y * width + x;
+                bool interior = true;
+                for (auto j : { i - 1, i + 1, i - width, i + width }) {
+                    interior = interior && ray_depths[j] >= 0.0f;
+                }
+                if (!interior || ray_depths[i] < 0.0f) { continue; }
+                ++hits;
+                mismatches +=
+                    std::abs(depths[i] - ray_depths[i]) > 0.02f * ray_depths[i];
+            }
+        }
+        REQUIRE(hits > 0);
+        REQUIRE(mismatches <= hits / 50);
+    }
+
+    SECTION("fill rule and culling")
+    {
+        // a pixel aligned quad split along its diagonal
+        std::vector<float> quad{ -0.8f, 0.0f, 0.0f, 0.0f,  0.0f, 0.0f,
+                                 0.0f,  0.8f, 0.0f, -0.8f, 0.8f, 0.0f };
+        std::vector<unsigned> faces{ 0, 1, 2, 0, 2, 3 };
+        Euclid::SoftRasterizer quad_rasterizer(100, 100);
+        quad_rasterizer.attach_position_buffer(quad.data(), quad.size());
+        quad_rasterizer.attach_index_buffer(faces.data(), faces.size());
+        Euclid::Material material;
+        material.ambient << 1.0f, 1.0f, 1.0f;
+        material.diffuse << 1.0f, 1.0f, 1.0f;
+        quad_rasterizer.set_material(material);
+        Euclid::OrthoRasCamera ortho(Eigen::Vector3f(0.0f, 0.0f, 1.0f),
+                                     center,
+                                     up,
+                                     2.0f,
+                                     2.0f,
+                                     0.1f,
+                                     2.0f);
+
+        std::vector<uint8_t> pixels;
+        quad_rasterizer.render_unlit(
+            Eigen::Matrix4f::Identity(), ortho, pixels, false);
+        int covered = 0;
+        for (int i = 0; i < 100 * 100; ++i) {
+            covered += pixels[i] == 255;
+        }
+        REQUIRE(covered == 40 * 40);
+        REQUIRE(pixels[20 * 100 + 20] == 255);
+        REQUIRE(pixels[70 * 100 + 20] == 0);
+
+        // back faces are culled
+        std::vector<unsigned> flipped{ 0, 2, 1, 0, 3, 2 };
+        quad_rasterizer.attach_index_buffer(flipped.data(), flipped.size());
+        quad_rasterizer.render_unlit(
+            Eigen::Matrix4f::Identity(), ortho, pixels, false);
+        covered = 0;
+        for (int i = 0; i < 100 * 100; ++i) {
+            covered += pixels[i] == 255;
+        }
+        REQUIRE(covered == 0);
+    }
+
+    SECTION("multisampling")
+    {
+        Euclid::PerspRasCamera persp(
+            view, center, up, 60.0f, width, height, near, far);
+        Euclid::Material material;
+        material.ambient << 1.0f, 1.0f, 1.0f;
+        material.diffuse << 1.0f, 1.0f, 1.0f;
+        rasterizer.set_material(material);
+
+        std::vector<uint8_t> pixels;
+        rasterizer.render_unlit(transform.matrix(), persp, pixels);
+        double coverage = 0.0;
+        for (auto p : pixels) {
+            coverage += p / 255.0;
+        }
+
+        rasterizer.set_image(
+            width, height, Euclid::SoftRasterizer::SAMPLE_COUNT_8);
+        std::vector<uint8_t> ms_pixels;
+        rasterizer.render_unlit(transform.matrix(), persp, ms_pixels);
+        double ms_coverage = 0.0;
+        int partial = 0;
+        for (auto p : ms_pixels) {
+            ms_coverage += p / 255.0;
+            partial += p != 0 && p != 255;
+        }
+        REQUIRE(partial > 0);
+        REQUIRE(ms_coverage == Approx(coverage).epsilon(0.05));
+
+        rasterizer.set_material(Euclid::Material{ { 0.1f, 0.1f, 0.1f },
+                                                  { 0.7f, 0.7f, 0.7f } });
+        rasterizer.render_shaded(transform.matrix(), persp, ms_pixels);
+
+        std::string outfile(TMP_DIR);
+        outfile.append("softrasterizer_multisample.png");
+        stbi_write_png(
+            outfile.c_str(), width, height, 3, ms_pixels.data(), width * 3);
+    }
+}
@@ -0,0 +1,79 @@
+#include <catch2/catch.hpp>
+#include <Euclid/Render/Visibility.h>
+
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("Render, Visibility", "[render][visibility]")
+{
+    // a small triangle facing +z, and a large one above it facing -z
+    std::vector<float> positions{
+        0.0f,   0.0f,   0.0f, // small triangle
+        1.0f,   0.0f,   0.0f, //
+        0.0f,   1.0f,   0.0f, //
+        -1e3f,  -1e3f,  1.0f, // occluder
+        -1e3f,  1e3f,   1.0f, //
+        1e3f,   0.0f,   1.0f, //
+        0.0f                  // Embree alignment
+    };
+    std::vector<unsigned> indices{ 0, 1, 2 };
+
+    SECTION("single triangle")
+    {
+        Euclid::RayScene scene(positions, indices);
+
+        std::vector<float> occlusion;
+        Euclid::ambient_occlusion(
+            scene, occlusion, Euclid::BakeElement::vertex);
+        REQUIRE(occlusion.size() == 6);
+        for (int i = 0; i < 3; ++i) {
+            REQUIRE(occlusion[i] == 0.0f);
+        }
+
+        std::vector<float> visibility;
+        Euclid::view_visibility(scene, visibility);
+        REQUIRE(visibility.size() == 1);
+        REQUIRE(visibility[0] == Approx(0.5f));
+    }
+
+    SECTION("occluded triangle")
+    {
+        indices.insert(indices.end(), { 3, 4, 5 });
+        Euclid::RayScene scene(positions, indices);
+
+        std::vector<double> occlusion;
+        Euclid::ambient_occlusion(scene, occlusion, Euclid::BakeElement::face);
+        REQUIRE(occlusion.size() == 2);
+        REQUIRE(occlusion[0] > 0.95);
+        REQUIRE(occlusion[1] == 0.0);
+
+        // the occluder is not infinite, so only nearly grazing views see it
+        std::vector<double> visibility;
+        Euclid::view_visibility(scene, visibility);
+        REQUIRE(visibility[0] < 0.01);
+        REQUIRE(visibility[1] == Approx(0.5));
+
+        Euclid::ambient_occlusion(
+            scene, occlusion, Euclid::BakeElement::face, 64, 0.5f);
+        REQUIRE(occlusion[0] == 0.0);
+    }
+
+    SECTION("invalid samples")
+    {
+        Euclid::RayScene scene(positions, indices);
+
+        std::vector<float> values;
+        REQUIRE_THROWS_AS(Euclid::ambient_occlusion(
+                              scene, values, Euclid::BakeElement::face, 0),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(Euclid::ambient_occlusion(
+                              scene, values, Euclid::BakeElement::face, -1),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(Euclid::view_visibility(
+                              scene, values, Euclid::BakeElement::face, 0),
+                          std::invalid_argument);
+        REQUIRE_THROWS_AS(Euclid::view_visibility(
+                              scene, values, Euclid::BakeElement::face, -1),
+                          std::invalid_argument);
+    }
+}
@@ -1,6 +1,9 @@
 #include <catch2/catch.hpp>
 #include <Euclid/ViewSelection/ViewEntropy.h>
 
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
 #include <CGAL/Simple_cartesian.h>
 #include <CGAL/Surface_mesh.h>
 #include <Euclid/IO/OffIO.h>
@@ -43,4 +46,40 @@ TEST_CASE("ViewSelection, ViewEntropy", "[viewselection][viewentropy]")
     std::vector<float> view_scores;
     Euclid::view_entropy(mesh, sphere, view_scores);
     write_view_sphere(sphere, view_scores, "view_entropy_sphere.ply");
+
+    // only the refined candidates are scored, at the full resolution, and
+    // the scores are appended
+    const size_t candidates = 8;
+    std::vector<float> refined_scores{ -1.0f };
+    Euclid::view_entropy(
+        mesh, sphere, refined_scores, nullptr, 256, candidates);
+    REQUIRE(refined_scores.size() == view_scores.size() + 1);
+    REQUIRE(refined_scores[0] == -1.0f);
+    size_t refined = 0;
+    for (size_t i = 0; i < view_scores.size(); ++i) {
+        if (refined_scores[i + 1] != 0.0f) {
+            REQUIRE(refined_scores[i + 1] == view_scores[i]);
+            ++refined;
+        }
+    }
+    REQUIRE(refined == candidates);
+
+    auto empty_scene = std::make_shared<Euclid::RayScene>();
+    REQUIRE_THROWS_AS(
+        Euclid::view_entropy(mesh, sphere, view_scores, empty_scene),
+        std::invalid_argument);
+
+    // the adaptive search refines a coarse sphere around the best views
+    auto coarse_sphere = Euclid::ViewSphere<Mesh>::make_subdiv(mesh, 3.0f, 1);
+    std::vector<float> coarse_scores;
+    Euclid::view_entropy(mesh, coarse_sphere, coarse_scores);
+    std::vector<Point_3> best_views;
+    std::vector<float> best_scores;
+    Euclid::view_entropy_adaptive(
+        mesh, coarse_sphere, best_views, best_scores, 4, 4.0f);
+    REQUIRE(best_views.size() == 4);
+    REQUIRE(best_scores.size() == 4);
+    REQUIRE(std::is_sorted(best_scores.rbegin(), best_scores.rend()));
+    REQUIRE(best_scores[0] >=
+            *std::max_element(coarse_scores.begin(), coarse_scores.end()));
 }